@@ -0,0 +1,19 @@
+( Stack traffic benchmark: times in milliseconds )
+( Compare builds or dispatch modes, e.g. before and after a VM change )
+
+( Iterative Fibonacci: arithmetic and shuffling through over/swap )
+: fib ( n -- f ) 0 1 rot 0 do over + swap loop drop ;
+: fib-bench ( n -- ) 0 do 40 fib drop loop ;
+
+( fibonacci.f-style composition of small words )
+: add-one 1 + ;
+: times-two 2 * ;
+: process dup add-one times-two + ;
+: process-bench ( n -- ) 0 do i process drop loop ;
+
+( Tight DO/LOOP body )
+: sum-bench ( n -- sum ) 0 swap 0 do i + loop ;
+
+." fib:     " millis 200000 fib-bench millis swap - . ." ms" cr
+." process: " millis 2000000 process-bench millis swap - . ." ms" cr
+." loop:    " millis 20000000 sum-bench drop millis swap - . ." ms" cr
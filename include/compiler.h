@@ -2,22 +2,74 @@
 #define COMPILER_H
 
 #include <stdio.h>
+#include "config.h"
 #include "dict.h"
 
 /* Forward declarations */
 typedef struct rforth_ctx rforth_ctx_t;
 
+/* A colon definition of the program being compiled */
+typedef struct {
+    char name[MAX_WORD_LENGTH];     /* Lower-cased Forth name */
+    char *definition;               /* Source text of the body */
+    bool fixed_effect;              /* Every path has the same stack effect */
+    int inputs;                     /* Cells it takes, when fixed */
+    int outputs;                    /* Cells it leaves, when fixed */
+    int slots;                      /* Locals holding its stack where control flow joins */
+} compiled_word_t;
+
+/* Storage a defining word of the program lays out */
+typedef enum {
+    DATA_CELLS,                     /* VARIABLE or CREATE, with what ALLOT and , add */
+    DATA_FLOATS,                    /* FVARIABLE */
+    DATA_CONSTANT,
+    DATA_FCONSTANT
+} data_kind_t;
+
+/* A VARIABLE, FVARIABLE, CONSTANT, FCONSTANT or CREATE of the program being compiled */
+typedef struct {
+    char name[MAX_WORD_LENGTH];     /* Lower-cased Forth name */
+    data_kind_t kind;
+    int words_before;               /* Colon definitions preceding it in the source */
+    bool literal;                   /* Constant whose value is a literal in the source */
+    int64_t value;                  /* Value of a literal CONSTANT */
+    double float_value;             /* Value of a literal FCONSTANT */
+    int64_t size;                   /* Cells of a DATA_CELLS region */
+    int64_t *cells;                 /* Its initial contents; cells past cell_count are zero */
+    int64_t cell_count;
+} compiled_data_t;
+
 /* Compiler context */
 typedef struct {
     FILE *output;               /* Output C file */
     char *output_filename;      /* Output C filename */
     char *executable_name;      /* Final executable name */
-    int word_count;            /* Generated word counter */
+    int word_count;            /* Words collected from the program */
     bool in_main;              /* Whether we're in main function */
     int control_depth;         /* Nesting depth for control structures */
     int label_counter;         /* Counter for generating unique labels */
     int if_stack[64];          /* Stack to track nested if statements */
     int if_depth;              /* Current if nesting depth */
+    int if_values[64];         /* Cells on the stack at each IF, for its ELSE */
+    int loop_stack[64];        /* Labels of the enclosing BEGIN and DO loops */
+    bool loop_counted[64];     /* Whether each enclosing loop is a DO loop */
+    bool loop_left[64];        /* Whether a LEAVE needs the loop's exit label */
+    int loop_depth;            /* Current loop nesting depth */
+    int loop_values[64];       /* Cells on the stack when each loop is left */
+    char values[MAX_PENDING_VALUES][MAX_VALUE_LENGTH]; /* Cells not yet on the real stack, deepest first */
+    int value_depth;           /* Number of pending cells */
+    char fvalues[MAX_PENDING_VALUES][MAX_VALUE_LENGTH]; /* Floats not yet on the real float stack */
+    int fvalue_depth;          /* Number of pending floats */
+    int temp_counter;          /* Counter for naming C locals */
+    bool unreachable;          /* Code since an EXIT or LEAVE cannot run */
+    bool failed;               /* A construct could not be compiled; reported already */
+    compiled_word_t *words;    /* Definitions of the program, in source order */
+    int word_capacity;         /* Allocated entries in words */
+    int current_word;          /* Index of the word being generated, -1 in main */
+    compiled_data_t *data;     /* Defining words of the program, in source order */
+    int data_count;            /* Entries in data */
+    int data_capacity;         /* Allocated entries in data */
+    int next_data;             /* Entries main has reached */
 } compiler_ctx_t;
 
 /* Code generation functions */
@@ -28,6 +80,10 @@ bool compiler_generate_header(compiler_ctx_t *compiler);
 bool compiler_generate_footer(compiler_ctx_t *compiler);
 bool compiler_generate_word(compiler_ctx_t *compiler, const char *name, const char *definition);
 bool compiler_generate_main(compiler_ctx_t *compiler, const char *main_code);
+bool compiler_generate_data(compiler_ctx_t *compiler);
+bool compiler_add_word(compiler_ctx_t *compiler, const char *name, const char *definition, size_t length);
+compiled_data_t* compiler_add_data(compiler_ctx_t *compiler, const char *name, data_kind_t kind);
+void compiler_infer_effects(compiler_ctx_t *compiler);
 
 /* Compilation utilities */
 bool compile_forth_to_c(const char *input_file, const char *output_file);
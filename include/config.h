@@ -11,6 +11,7 @@
 /* Stack Configuration */
 #define DEFAULT_STACK_SIZE 256
 #define DEFAULT_RETURN_STACK_SIZE 256
+#define DEFAULT_FLOAT_STACK_SIZE 64
 #define MAX_STACK_SIZE 8192
 #define MIN_STACK_SIZE 16
 
@@ -19,8 +20,31 @@
 #define MAX_INPUT_LENGTH 1024
 #define MAX_DEFINITION_LENGTH 4096
 
+/* Initial control-flow and DO/LOOP nesting; both grow on demand */
+#define INITIAL_CONTROL_DEPTH 32
+
+/* Nested user-word calls; frames grow on demand up to the limit */
+#define INITIAL_CALL_DEPTH 256
+#define MAX_CALL_DEPTH (1 << 22)
+
+/* Native code nests on the C stack; calls deeper than this run as threaded code */
+#define JIT_MAX_CALL_DEPTH (1 << 14)
+
+/* Compiled-form cache for interpreted strings: entries (a power of two) and longest string kept */
+#define EVAL_CACHE_SIZE 64
+#define EVAL_CACHE_MAX_LENGTH 1024
+
+/* Minimum valid address for memory operations (avoid null and low memory) */
+#define MIN_VALID_ADDRESS 4096
+
+/* Data space: size limit, commit granularity and base alignment */
+#define DATA_SPACE_SIZE (16 * 1024 * 1024)
+#define DATA_SPACE_COMMIT 65536
+#define DATA_SPACE_ALIGN 64
+
 /* Buffer Sizes */
 #define MAX_FILENAME_LENGTH 256
+#define MAX_PATH_LENGTH 1024
 #define MAX_NUMBER_STRING_LENGTH 32
 #define COMPILE_BUFFER_INITIAL_SIZE 1024
 #define COMPILE_BUFFER_GROWTH_FACTOR 2
@@ -33,10 +57,27 @@
 #define DEFAULT_COMPILER "gcc"
 #define COMPILER_FLAGS "-O2", "-std=c99", "-Wall", "-Wextra"
 #define MAX_COMPILER_ARGS 16
+#define MAX_PENDING_VALUES 64        /* Stack cells the compiler keeps in C locals */
+#define MAX_VALUE_LENGTH 32          /* Longest C expression for one of them */
+#define MAX_WORD_PARAMETERS 8        /* Most inputs passed to a word as C arguments */
+
+/*
+ * Where generated programs find rforth_runtime.h and librforth_runtime.a
+ * when neither the environment nor an install layout around the rforth
+ * executable supplies them; the build sets both to its own tree.
+ */
+#ifndef RFORTH_INCLUDE_DIR
+#define RFORTH_INCLUDE_DIR "include"
+#endif
+#ifndef RFORTH_LIBRARY_DIR
+#define RFORTH_LIBRARY_DIR "lib"
+#endif
 
 /* Memory Management */
-#define INITIAL_DICT_CAPACITY 128
+#define INITIAL_DICT_CAPACITY 128    /* Hash buckets; must be a power of two */
 #define DICT_GROWTH_FACTOR 2
+#define DICT_SLOT_BLOCK 256          /* Constant cells per slot block */
+#define INITIAL_SYMBOL_CAPACITY 512  /* Interned names; must be a power of two */
 
 /* I/O Configuration */
 #define DEFAULT_IO_TIMEOUT_MS 1000
@@ -0,0 +1,45 @@
+#ifndef DATASPACE_H
+#define DATASPACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Data space: the region HERE, ALLOT, "," and CREATE work in. It is
+ * reserved once at its size limit and committed as HERE advances, so
+ * addresses handed to Forth never move. Its base is cache-line aligned.
+ */
+typedef struct {
+    unsigned char *base;    /* First byte of data space */
+    size_t here;            /* Offset of the next free byte */
+    size_t committed;       /* Bytes usable without growing */
+    size_t limit;           /* Maximum size in bytes */
+    void *block;            /* Backing allocation when not mapped */
+} dataspace_t;
+
+bool dataspace_init(dataspace_t *space, size_t limit);
+void dataspace_release(dataspace_t *space);
+
+/* Move HERE by n bytes (negative n gives space back); false past the limit */
+bool dataspace_allot(dataspace_t *space, int64_t n);
+
+/* Round HERE up to a multiple of alignment (a power of two) */
+bool dataspace_align(dataspace_t *space, size_t alignment);
+
+static inline int64_t dataspace_here(const dataspace_t *space) {
+    return (int64_t)(uintptr_t)(space->base + space->here);
+}
+
+/*
+ * Host pointer for bytes [addr, addr + size) if they lie in the allotted
+ * part of data space, else NULL. The offset is unsigned, so addresses
+ * below base wrap around and fail the same test as those past HERE.
+ */
+static inline void* dataspace_ptr(const dataspace_t *space, int64_t addr, size_t size) {
+    uint64_t offset = (uint64_t)addr - (uint64_t)(uintptr_t)space->base;
+    if (offset + size > space->here || offset > space->here) return NULL;
+    return space->base + offset;
+}
+
+#endif /* DATASPACE_H */
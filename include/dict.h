@@ -2,14 +2,21 @@
 #define DICT_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "stack.h"
+#include "symbol.h"
 
 #ifndef MAX_WORD_LENGTH
 #define MAX_WORD_LENGTH 64
 #endif
 
+#ifndef DICT_SLOT_BLOCK
+#define DICT_SLOT_BLOCK 256
+#endif
+
 /* Forward declarations */
 typedef struct rforth_ctx rforth_ctx_t;
+struct instr;
 
 /* Word types */
 typedef enum {
@@ -17,7 +24,8 @@ typedef enum {
     WORD_USER,          /* User-defined Forth word */
     WORD_IMMEDIATE,     /* Immediate word (executes during compilation) */
     WORD_CONSTANT,      /* Constant value */
-    WORD_VARIABLE       /* Variable */
+    WORD_VARIABLE,      /* Variable */
+    WORD_FCONSTANT      /* Float constant (pushes onto the float stack) */
 } word_type_t;
 
 /* Word structure */
@@ -27,25 +35,54 @@ typedef struct word {
     union {
         void (*builtin)(rforth_ctx_t *ctx);    /* Builtin function */
         char *definition;                       /* User definition */
-        cell_t value;                          /* Constant/variable value */
+        cell_t *slot;                          /* Constant value / variable data */
     } code;
+    struct instr *body;         /* Compiled threaded code (user words) */
+    int body_length;            /* Number of instructions in body */
+    void *native_code;          /* JIT-compiled body, or NULL */
+    bool jit_rejected;          /* JIT declined this word; keep interpreting */
+    symbol_t symbol;            /* Interned name */
+    uint32_t hash;              /* Hash of name, computed once on insert */
+    struct word *shadowed;      /* Older definition of the same name */
     struct word *next;          /* Next word in dictionary */
 } word_t;
 
-/* Dictionary structure */
+/* Block of value slots for constants; never moved */
+typedef struct dict_slots {
+    struct dict_slots *next;
+    int used;
+    cell_t cells[DICT_SLOT_BLOCK];
+} dict_slots_t;
+
+/*
+ * Dictionary structure. Words are kept in definition order on the latest
+ * list and indexed by an open-addressing hash table holding the newest
+ * word of each name; older definitions hang off its shadowed chain.
+ */
 typedef struct {
     word_t *latest;             /* Most recently defined word */
     int count;                  /* Number of words */
+    word_t **buckets;           /* Hash index, power-of-two sized */
+    int capacity;               /* Number of buckets */
+    int used;                   /* Buckets holding a word or tombstone */
+    dict_slots_t *slots;        /* Value slots, newest block first */
+    uint32_t generation;        /* Changes whenever a name may find a different word */
+    word_t *forgotten;          /* Forgotten words, freed once nothing runs them */
 } dict_t;
 
 /* Dictionary operations */
 dict_t* dict_create(void);
 void dict_destroy(dict_t *dict);
 word_t* dict_find(dict_t *dict, const char *name);
+word_t* dict_find_symbol(dict_t *dict, symbol_t symbol);
 bool dict_add_builtin(dict_t *dict, const char *name, void (*func)(rforth_ctx_t *ctx));
-bool dict_add_user_word(dict_t *dict, const char *name, const char *definition);
+bool dict_add_user_word(dict_t *dict, const char *name, const char *definition,
+                        struct instr *body, int body_length);
 bool dict_add_constant(dict_t *dict, const char *name, cell_t value);
-bool dict_add_variable(dict_t *dict, const char *name, cell_t initial_value);
+bool dict_add_fconstant(dict_t *dict, const char *name, double value);
+bool dict_add_variable(dict_t *dict, const char *name, cell_t *slot);
+void dict_forget(dict_t *dict, word_t *word);
+void dict_reclaim(dict_t *dict);
 void dict_print(dict_t *dict);
 
 /* Word execution */
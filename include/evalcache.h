@@ -0,0 +1,33 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include "rforth.h"
+
+/*
+ * Compiled-form cache for interpreted strings. A string handed to
+ * rforth_interpret_string (and so to EVALUATE) is compiled once into
+ * anonymous threaded code and run from there on later calls with the
+ * same text. Entries are keyed by a hash of the text and belong to one
+ * dictionary generation, so defining or forgetting a word retires them.
+ * Strings whose meaning depends on the outer interpreter (defining and
+ * parsing words, [ ], undefined names) are remembered as such and
+ * always interpreted.
+ */
+
+typedef struct eval_cache eval_cache_t;
+
+eval_cache_t* eval_cache_create(void);
+void eval_cache_destroy(eval_cache_t *cache);
+
+/*
+ * Run input from the cache, compiling it on a miss. Returns false when
+ * the outer interpreter has to handle it; otherwise *result holds what
+ * rforth_interpret_string returns.
+ */
+bool eval_cache_run(rforth_ctx_t *ctx, const char *input, int *result);
+
+/* Lookups answered from a compiled form, and all others */
+void eval_cache_stats(const eval_cache_t *cache, uint64_t *hits, uint64_t *misses);
+void eval_cache_report(const eval_cache_t *cache);
+
+#endif /* EVALCACHE_H */
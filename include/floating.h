@@ -0,0 +1,73 @@
+#ifndef FLOATING_H
+#define FLOATING_H
+
+#include "rforth.h"
+
+/*
+ * ANS floating-point word set. Floats live on ctx->float_stack as plain
+ * doubles, so these words never look at a cell tag. Literals written
+ * with an exponent (1.5e0, 2E) go to the float stack; 1.5 without one
+ * keeps its old meaning as a float cell on the data stack.
+ */
+
+/* Float stack manipulation */
+void builtin_fdrop(rforth_ctx_t *ctx);
+void builtin_fdup(rforth_ctx_t *ctx);
+void builtin_fswap(rforth_ctx_t *ctx);
+void builtin_fover(rforth_ctx_t *ctx);
+void builtin_frot(rforth_ctx_t *ctx);
+void builtin_fdepth(rforth_ctx_t *ctx);
+
+/* Arithmetic */
+void builtin_f_plus(rforth_ctx_t *ctx);
+void builtin_f_minus(rforth_ctx_t *ctx);
+void builtin_f_star(rforth_ctx_t *ctx);
+void builtin_f_slash(rforth_ctx_t *ctx);
+void builtin_f_star_star(rforth_ctx_t *ctx);
+void builtin_fnegate(rforth_ctx_t *ctx);
+void builtin_fabs(rforth_ctx_t *ctx);
+void builtin_fmax(rforth_ctx_t *ctx);
+void builtin_fmin(rforth_ctx_t *ctx);
+void builtin_fsqrt(rforth_ctx_t *ctx);
+void builtin_floor(rforth_ctx_t *ctx);
+void builtin_fround(rforth_ctx_t *ctx);
+void builtin_ftrunc(rforth_ctx_t *ctx);
+void builtin_fexp(rforth_ctx_t *ctx);
+void builtin_fln(rforth_ctx_t *ctx);
+void builtin_flog(rforth_ctx_t *ctx);
+void builtin_fsin(rforth_ctx_t *ctx);
+void builtin_fcos(rforth_ctx_t *ctx);
+void builtin_ftan(rforth_ctx_t *ctx);
+void builtin_fatan(rforth_ctx_t *ctx);
+void builtin_fatan2(rforth_ctx_t *ctx);
+
+/* Comparison (flags go to the data stack) */
+void builtin_f_zero_equal(rforth_ctx_t *ctx);
+void builtin_f_zero_less(rforth_ctx_t *ctx);
+void builtin_f_equal(rforth_ctx_t *ctx);
+void builtin_f_less(rforth_ctx_t *ctx);
+void builtin_f_greater(rforth_ctx_t *ctx);
+void builtin_f_proximate(rforth_ctx_t *ctx);
+
+/* Conversion between stacks */
+void builtin_s_to_f(rforth_ctx_t *ctx);
+void builtin_f_to_s(rforth_ctx_t *ctx);
+void builtin_d_to_f(rforth_ctx_t *ctx);
+void builtin_f_to_d(rforth_ctx_t *ctx);
+
+/* Memory */
+void builtin_f_fetch(rforth_ctx_t *ctx);
+void builtin_f_store(rforth_ctx_t *ctx);
+void builtin_floats(rforth_ctx_t *ctx);
+void builtin_float_plus(rforth_ctx_t *ctx);
+void builtin_falign(rforth_ctx_t *ctx);
+void builtin_faligned(rforth_ctx_t *ctx);
+void builtin_fvariable(rforth_ctx_t *ctx);
+void builtin_fconstant(rforth_ctx_t *ctx);
+
+/* Output */
+void builtin_f_dot(rforth_ctx_t *ctx);
+void builtin_f_e_dot(rforth_ctx_t *ctx);
+void builtin_f_s_dot(rforth_ctx_t *ctx);
+
+#endif /* FLOATING_H */
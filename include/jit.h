@@ -0,0 +1,35 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "rforth.h"
+
+/*
+ * Template JIT: splices machine code for the threaded-code opcodes of a
+ * compiled definition into executable memory. Supported on x86-64 and
+ * AArch64 hosts with mmap; elsewhere jit_create returns NULL and words
+ * keep running on the inner interpreter.
+ */
+
+#if (defined(__x86_64__) || defined(__aarch64__)) && !defined(_WIN32)
+#define JIT_SUPPORTED 1
+#endif
+
+typedef struct jit jit_t;
+
+/* Native entry point: returns 0 on success, nonzero on error */
+typedef int (*jit_fn_t)(rforth_ctx_t *ctx, rforth_stack_t *ds, int loop_base);
+
+jit_t* jit_create(void);
+void jit_destroy(jit_t *jit);
+const char* jit_arch_name(void);
+
+/* Compile a word's threaded code; false leaves it to the interpreter */
+bool jit_compile(jit_t *jit, word_t *word);
+
+/* Run a word previously compiled with jit_compile; only while jit_can_nest */
+void jit_execute(rforth_ctx_t *ctx, word_t *word);
+
+/* False once native calls nest JIT_MAX_CALL_DEPTH deep; run threaded code then */
+bool jit_can_nest(const jit_t *jit);
+
+#endif /* JIT_H */
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "symbol.h"
 
 #ifndef MAX_WORD_LENGTH
 #define MAX_WORD_LENGTH 64
@@ -19,7 +20,8 @@ typedef enum {
 typedef enum {
     TOKEN_WORD,         /* Word name */
     TOKEN_NUMBER,       /* Integer numeric literal */
-    TOKEN_FLOAT,        /* Floating point literal */
+    TOKEN_FLOAT,        /* Floating point literal (1.5), on the data stack */
+    TOKEN_FLOAT_EXP,    /* Exponent-form literal (1.5e0, 1E), on the float stack */
     TOKEN_STRING,       /* String literal */
     TOKEN_COLON,        /* : (start definition) */
     TOKEN_SEMICOLON,    /* ; (end definition) */
@@ -42,10 +44,18 @@ typedef enum {
     TOKEN_ERROR         /* Parse error */
 } token_type_t;
 
-/* Token structure */
+/*
+ * Token structure. The text is not copied: start/length is the slice of
+ * the input it came from. Words also carry their symbol when the name
+ * has been interned, which every defined word's name has; text nothing
+ * was ever named is left SYMBOL_NONE rather than interned, so unknown
+ * words and string contents do not grow the symbol table.
+ */
 typedef struct {
     token_type_t type;
-    char text[MAX_WORD_LENGTH];
+    const char *start;  /* Token text in the input, not NUL-terminated */
+    int length;         /* Bytes in start */
+    symbol_t symbol;    /* Symbol of a word's text if interned, else SYMBOL_NONE */
     union {
         int64_t number;     /* For integer tokens */
         double float_val;   /* For floating point tokens */
@@ -67,8 +77,15 @@ typedef struct {
 /* Parser operations */
 parser_t* parser_create(void);
 void parser_destroy(parser_t *parser);
+
+/* Set up / tear down a parser embedded in another structure */
+void parser_init(parser_t *parser);
+void parser_release(parser_t *parser);
 void parser_set_input(parser_t *parser, const char *input);
 token_t parser_next_token(parser_t *parser);
+
+/* NUL-terminated copy of a token's text, cut to fit size */
+void parser_token_text(const token_t *token, char *text, size_t size);
 bool parser_is_number(const char *text, int64_t *value);
 bool parser_is_float(const char *text, double *value);
 void parser_skip_whitespace(parser_t *parser);
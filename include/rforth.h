@@ -13,6 +13,7 @@
 /* Include other headers */
 #include "stack.h"
 #include "dict.h"
+#include "dataspace.h"
 #include "parser.h"
 #include "compiler.h"
 #include "io.h"
@@ -88,32 +89,35 @@ typedef struct {
 
 /* Forward declarations */
 typedef struct rforth_ctx rforth_ctx_t;
+struct jit;
+struct vm_frame;
 
 /* Control flow types */
 typedef enum {
     CF_IF,
     CF_BEGIN,
+    CF_WHILE,
     CF_DO
 } control_flow_type_t;
 
 /* Control flow stack entry */
 typedef struct {
     control_flow_type_t type;
-    int64_t address;        /* Address or flag value */
-    bool condition_met;     /* For conditional constructs */
+    int64_t address;        /* Instruction index to branch to or patch */
 } control_flow_entry_t;
 
-/* Variable entry */
-typedef struct variable_entry {
-    char name[MAX_WORD_LENGTH];
-    cell_t value;
-    struct variable_entry *next;
-} variable_entry_t;
+/* Parser and input buffer for one level of EVALUATE nesting */
+typedef struct {
+    parser_t parser;
+    char *buffer;           /* Copy of input that is not NUL-terminated */
+    size_t capacity;        /* Allocated bytes in buffer */
+} eval_frame_t;
 
 /* Main context structure */
 struct rforth_ctx {
     rforth_stack_t *data_stack;        /* Data stack */
     rforth_stack_t *return_stack;      /* Return stack */
+    rforth_fstack_t *float_stack;      /* Float stack (F+, F@, F. ...) */
     dict_t *dict;              /* Word dictionary */
     parser_t *parser;          /* Parser state */
     parse_state_t state;       /* Interpreter state */
@@ -121,28 +125,25 @@ struct rforth_ctx {
     bool running;              /* Interpreter running flag */
     rforth_error_context_t last_error; /* Last error with context */
     
-    /* Control flow stack */
-    control_flow_entry_t cf_stack[32];  /* Control flow stack */
-    int cf_sp;                           /* Control flow stack pointer */
-    
-    /* Skip control for true control flow */
-    bool skip_mode;                      /* True when skipping execution */
-    int skip_depth;                      /* Nesting depth during skip */
-    
-    /* Loop control */
-    const char *loop_start[32];          /* Loop start positions */
-    int loop_sp;                         /* Loop stack pointer */
-    
-    /* DO/LOOP support */
-    int64_t loop_index[32];              /* Current loop indices */
-    int64_t loop_limit[32];              /* Loop limits */
+    /* DO/LOOP parameters, grown on demand by vm_loop_push */
+    int64_t *loop_index;                 /* Current loop indices */
+    int64_t *loop_limit;                 /* Loop limits */
     int do_loop_sp;                      /* DO/LOOP stack pointer */
+    int loop_capacity;                   /* Allocated DO/LOOP frames */
+    
+    /* Return points of nested threaded calls, grown on demand by the VM */
+    struct vm_frame *call_frames;        /* Call frame stack */
+    int call_sp;                         /* Frames in use */
+    int call_capacity;                   /* Allocated frames */
     
-    /* Variables */
-    variable_entry_t *variables;         /* Variable linked list */
+    /* EVALUATE frames by nesting depth, kept for reuse by later calls */
+    eval_frame_t **eval_frames;          /* Frames, allocated once each */
+    int eval_depth;                      /* Frames in use */
+    int eval_capacity;                   /* Allocated frame slots */
+    struct eval_cache *eval_cache;       /* Compiled forms of interpreted strings */
     
     /* System variables for ANSI compliance */
-    char *here_ptr;                      /* Dictionary HERE pointer */
+    dataspace_t data_space;              /* HERE, ALLOT and CREATE region */
     int64_t numeric_base;                /* Current numeric base (default 10) */
     int64_t state_var;                   /* STATE variable (0=interpret, -1=compile) */
     
@@ -153,6 +154,9 @@ struct rforth_ctx {
     /* Compilation state */
     bool compiling;                      /* True when in compile mode */
     char *current_word_name;             /* Name of word being compiled */
+    
+    /* Native code generation (-j) */
+    struct jit *jit;                     /* JIT state, NULL when interpreting only */
 };
 
 /* Main API functions */
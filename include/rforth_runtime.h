@@ -0,0 +1,85 @@
+#ifndef RFORTH_RUNTIME_H
+#define RFORTH_RUNTIME_H
+
+/*
+ * Runtime for programs generated by the RForth compiler. Each program is a
+ * single C file that includes this header and links librforth_runtime.a,
+ * which provides the timing and GPIO support. The stacks are static here so
+ * that the C compiler sees every use of them within the one program file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "gpio_rpi.h"
+#include "timing_rpi.h"
+
+#define RETURN_STACK_SIZE DEFAULT_RETURN_STACK_SIZE
+#define FLOAT_STACK_SIZE DEFAULT_FLOAT_STACK_SIZE
+
+/* The top cell is cached in tos; stack[sp] is its stale slot and stack[-1] takes the spill of an empty stack */
+static int64_t stack_cells[DEFAULT_STACK_SIZE + 1];
+static int64_t *const stack = stack_cells + 1;
+static int64_t tos;
+static int sp = -1;
+
+static int64_t return_stack[RETURN_STACK_SIZE];
+static int rsp = -1;
+
+static double fstack[FLOAT_STACK_SIZE];
+static int fsp = -1;
+
+/* Stack overflow and underflow are reported and end the program (runtime.c) */
+void rf_stack_error(const char *message);
+
+static inline void push(int64_t value) {
+    if (sp >= DEFAULT_STACK_SIZE - 1) rf_stack_error("Stack overflow");
+    stack[sp++] = tos;
+    tos = value;
+}
+
+static inline int64_t pop(void) {
+    if (sp < 0) rf_stack_error("Stack underflow");
+    int64_t value = tos;
+    tos = stack[--sp];
+    return value;
+}
+
+static inline void rpush(int64_t value) {
+    if (rsp >= RETURN_STACK_SIZE - 1) rf_stack_error("Return stack overflow");
+    return_stack[++rsp] = value;
+}
+
+static inline int64_t rpop(void) {
+    if (rsp < 0) rf_stack_error("Return stack underflow");
+    return return_stack[rsp--];
+}
+
+static inline int64_t rpeek(void) {
+    if (rsp < 0) rf_stack_error("Return stack underflow");
+    return return_stack[rsp];
+}
+
+static inline void fpush(double value) {
+    if (fsp >= FLOAT_STACK_SIZE - 1) rf_stack_error("Float stack overflow");
+    fstack[++fsp] = value;
+}
+
+static inline double fpop(void) {
+    if (fsp < 0) rf_stack_error("Float stack underflow");
+    return fstack[fsp--];
+}
+
+/* GPIO words: a failure is reported and ends the program (runtime.c) */
+void rf_gpio_check(gpio_error_t err, const char *word);
+
+static inline int64_t rf_gpio_read(int64_t pin) {
+    bool value = false;
+    rf_gpio_check(gpio_read((uint8_t)pin, &value), "GPIO-READ");
+    return value ? 1 : 0;
+}
+
+#endif /* RFORTH_RUNTIME_H */
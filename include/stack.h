@@ -10,7 +10,23 @@ typedef enum {
     CELL_FLOAT      /* Floating point value */
 } cell_type_t;
 
-/* Stack cell - can hold either integer or floating point */
+/*
+ * Stack cell - can hold either integer or floating point. By default it
+ * carries a type tag and mixed-type words follow it. Built with
+ * RFORTH_UNTAGGED_CELLS a cell is 8 bytes with no tag: generic words
+ * treat every cell as an integer, and a float is its IEEE bit pattern,
+ * meaningful only to float words such as >INT and SQRT.
+ */
+#ifdef RFORTH_UNTAGGED_CELLS
+typedef struct {
+    union {
+        int64_t i;      /* Integer value */
+        double f;       /* Floating point bits */
+    } value;
+} cell_t;
+
+#define CELL_TYPE(cell) CELL_INT
+#else
 typedef struct {
     cell_type_t type;
     union {
@@ -19,13 +35,27 @@ typedef struct {
     } value;
 } cell_t;
 
-/* Stack structure */
+#define CELL_TYPE(cell) ((cell).type)
+#endif
+
+/*
+ * Stack structure. data[-1] is a valid scratch cell, so the inner
+ * interpreter can spill its cached top of stack without testing for an
+ * empty stack.
+ */
 typedef struct {
     cell_t *data;       /* Stack data array */
     int sp;             /* Stack pointer (top of stack) */
     int size;           /* Maximum stack size */
 } rforth_stack_t;
 
+/* Float stack for the ANS floating-point words: bare doubles, no tags */
+typedef struct {
+    double *data;       /* Stack data array */
+    int sp;             /* Stack pointer (top of stack) */
+    int size;           /* Maximum stack size */
+} rforth_fstack_t;
+
 /* Stack operations */
 rforth_stack_t* stack_create(int size);
 void stack_destroy(rforth_stack_t *stack);
@@ -42,14 +72,45 @@ bool stack_is_full(rforth_stack_t *stack);
 int stack_depth(rforth_stack_t *stack);
 void stack_clear(rforth_stack_t *stack);
 
-/* Cell creation utilities */
-cell_t cell_make_int(int64_t value);
-cell_t cell_make_float(double value);
+/* Cell creation utilities (inline: every primitive builds cells) */
+static inline cell_t cell_make_int(int64_t value) {
+    cell_t cell;
+#ifndef RFORTH_UNTAGGED_CELLS
+    cell.type = CELL_INT;
+#endif
+    cell.value.i = value;
+    return cell;
+}
+
+static inline cell_t cell_make_float(double value) {
+    cell_t cell;
+#ifndef RFORTH_UNTAGGED_CELLS
+    cell.type = CELL_FLOAT;
+#endif
+    cell.value.f = value;
+    return cell;
+}
+
+/* Convert any cell to float; untagged cells are taken as float bits */
+static inline double cell_to_float(const cell_t *cell) {
+    if (!cell) return 0.0;
+#ifdef RFORTH_UNTAGGED_CELLS
+    return cell->value.f;
+#else
+    return cell->type == CELL_FLOAT ? cell->value.f : (double)cell->value.i;
+#endif
+}
+
 bool cell_is_int(const cell_t *cell);
 bool cell_is_float(const cell_t *cell);
 int64_t cell_get_int(const cell_t *cell);
 double cell_get_float(const cell_t *cell);
-double cell_to_float(const cell_t *cell);  /* Convert any cell to float */
+
+/* Float stack operations */
+rforth_fstack_t* fstack_create(int size);
+void fstack_destroy(rforth_fstack_t *stack);
+bool fstack_push(rforth_fstack_t *stack, double value);
+bool fstack_pop(rforth_fstack_t *stack, double *value);
 
 /* Stack manipulation operations */
 bool stack_dup(rforth_stack_t *stack);         /* Duplicate top */
@@ -0,0 +1,56 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Interned names. Each distinct word name maps to one small integer for
+ * the life of the process, with its text and FNV-1a hash kept alongside.
+ * The tokenizer hands out symbols instead of copies of the text, so the
+ * dictionary and the keyword tests compare integers. It only looks names
+ * up; they are added when a word is defined or a forward reference is
+ * compiled. Symbols are never freed; like dictionary names they only
+ * accumulate.
+ */
+
+typedef uint32_t symbol_t;
+
+#define SYMBOL_NONE 0
+
+/* Names tested by the compiler and interpreter, interned first so their IDs are constants */
+#define WELL_KNOWN_SYMBOLS(X) \
+    X(IF, "if") X(ELSE, "else") X(THEN, "then") \
+    X(BEGIN, "begin") X(UNTIL, "until") X(WHILE, "while") X(REPEAT, "repeat") \
+    X(DO, "do") X(LOOP, "loop") X(PLUS_LOOP, "+loop") X(LEAVE, "leave") \
+    X(I, "i") X(J, "j") X(UNLOOP, "unloop") \
+    X(EXIT, "exit") X(RECURSE, "recurse") X(LITERAL, "literal") \
+    X(DOT_QUOTE, ".\"") X(S_QUOTE, "s\"") \
+    X(LEFT_BRACKET, "[") X(RIGHT_BRACKET, "]") X(POSTPONE, "postpone") X(QUIT, "quit") \
+    X(VARIABLE, "variable") X(CONSTANT, "constant") X(CREATE, "create") X(DOES, "does>") \
+    X(FORGET, "forget") X(FVARIABLE, "fvariable") X(FCONSTANT, "fconstant")
+
+enum {
+    SYM_NONE_ = SYMBOL_NONE,
+#define SYMBOL_ENUM(id, text) SYM_##id,
+    WELL_KNOWN_SYMBOLS(SYMBOL_ENUM)
+#undef SYMBOL_ENUM
+    SYM_WELL_KNOWN_COUNT
+};
+
+/* FNV-1a of length bytes of text */
+uint32_t symbol_hash_text(const char *text, size_t length);
+
+/* Symbol for length bytes of text, adding it if new; SYMBOL_NONE when out of memory */
+symbol_t symbol_intern(const char *text, size_t length);
+
+/* Symbol for text if it has been interned, else SYMBOL_NONE */
+symbol_t symbol_find(const char *text, size_t length);
+
+/* NUL-terminated name and hash of a symbol; "" and 0 for SYMBOL_NONE */
+const char* symbol_name(symbol_t symbol);
+size_t symbol_length(symbol_t symbol);
+uint32_t symbol_hash(symbol_t symbol);
+
+#endif /* SYMBOL_H */
@@ -2,7 +2,9 @@
 #define TIMING_RPI_H
 
 #include <stdint.h>
-#include "rforth.h"
+
+/* Forward declaration; compiled programs use this header without the interpreter's */
+typedef struct rforth_ctx rforth_ctx_t;
 
 /* Timing initialization */
 void timing_init(void);
@@ -0,0 +1,156 @@
+#ifndef VM_H
+#define VM_H
+
+#include "rforth.h"
+
+/* Threaded code for compiled colon definitions */
+
+/*
+ * Dispatch technique, selected with the RFORTH_DISPATCH CMake option.
+ * Direct threading stores the handler address in each instruction;
+ * token threading indexes a handler table by opcode. Both need GCC's
+ * computed goto, so other compilers (MSVC) always use a switch.
+ */
+#if defined(__GNUC__) && !defined(RFORTH_DISPATCH_SWITCH)
+#if defined(RFORTH_DISPATCH_TOKEN)
+#define VM_TOKEN_THREADED 1
+#else
+#define VM_DIRECT_THREADED 1
+#endif
+#else
+#define VM_SWITCH_DISPATCH 1
+#endif
+
+/* Instruction opcodes */
+typedef enum {
+    OP_CALL,            /* Execute a resolved word */
+    OP_CALL_NAME,       /* Forward reference, resolved on first execution */
+    OP_RECURSE,         /* Call the word being executed */
+    OP_TAIL_CALL,       /* OP_CALL of a user word in tail position: reuse the frame */
+    OP_TAIL_CALL_NAME,  /* OP_CALL_NAME in tail position: reuse the frame for a user word */
+    OP_TAIL_RECURSE,    /* OP_RECURSE in tail position: restart the body */
+    OP_LIT,             /* Push literal cell */
+    OP_BRANCH,          /* Unconditional jump */
+    OP_0BRANCH,         /* Jump if top of stack is zero */
+    OP_DO,              /* Start counted loop ( limit index -- ) */
+    OP_LOOP,            /* Increment index, jump back while below limit */
+    OP_PLUS_LOOP,       /* Add n to index, jump back while not past limit */
+    OP_LEAVE,           /* Exit counted loop */
+    OP_EXIT,            /* Return from definition */
+    OP_TYPE,            /* Print inline string (.") */
+    OP_SLIT,            /* Push inline string address and length (S") */
+    OP_FLIT,            /* Push literal onto the float stack */
+    OP_CHECK_DEPTH,     /* Entry bounds check of a verified body */
+
+    /* Primitives executed inline by the inner interpreter */
+    OP_DUP,
+    OP_DROP,
+    OP_SWAP,
+    OP_OVER,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_EQUAL,
+    OP_LESS,
+    OP_GREATER,
+    OP_ZERO_EQUAL,
+    OP_ONE_PLUS,
+    OP_ONE_MINUS,
+    OP_FETCH,
+    OP_STORE,
+    OP_I,
+    OP_J,
+
+    /*
+     * Integer-only forms of the mixed-type primitives above, in the same
+     * order. A generic site is rewritten to one of these once it has
+     * only seen integers; a float operand rewrites it back.
+     */
+    OP_ADD_INT,
+    OP_SUB_INT,
+    OP_MUL_INT,
+    OP_EQUAL_INT,
+    OP_LESS_INT,
+    OP_GREATER_INT,
+
+    /* Fused primitive sequences */
+#define SUPER2(name, a, b) OP_##name,
+#define SUPER3(name, a, b, c) OP_##name,
+#include "superinstructions.def"
+#undef SUPER2
+#undef SUPER3
+
+    OP_COUNT            /* Number of opcodes */
+} opcode_t;
+
+/* Threaded code instruction */
+typedef struct instr {
+#ifdef VM_DIRECT_THREADED
+    const void *handler;        /* Address of the opcode's handler */
+#endif
+    opcode_t op;
+    union {
+        int feedback;           /* Mixed-type primitive: integer-only executions, -1 once it saw a float */
+        uint32_t generation;    /* OP_CALL_NAME: dictionary generation arg.ref.word was found in */
+    } site;
+    union {
+        word_t *word;           /* OP_CALL target */
+        cell_t literal;         /* OP_LIT value; OP_FLIT uses value.f */
+        int target;             /* Branch target (instruction index) */
+        struct {
+            int need;           /* Cells the body reads below its entry depth */
+            int room;           /* Most cells it pushes above its entry depth */
+        } depth;                /* OP_CHECK_DEPTH */
+        struct {
+            char *text;         /* Inline string */
+            int length;
+        } string;
+        struct {
+            symbol_t symbol;    /* OP_CALL_NAME: name looked up when executed */
+            word_t *word;       /* What it found, valid for site.generation */
+        } ref;
+    } arg;
+} instr_t;
+
+/* Return point of a nested threaded call, on ctx->call_frames */
+typedef struct vm_frame {
+    instr_t *ip;                /* Instruction after the call */
+    word_t *word;               /* Word that made the call */
+    int loop_base;              /* Its first DO/LOOP frame */
+} vm_frame_t;
+
+/* Definition being compiled */
+typedef struct {
+    instr_t *code;              /* Instruction array */
+    int length;                 /* Instructions emitted */
+    int capacity;               /* Allocated instructions */
+    int fold_floor;             /* First instruction constant folding may consume */
+    control_flow_entry_t *cf_stack;     /* Unresolved control structures */
+    int cf_sp;                  /* Control flow stack pointer */
+    int cf_capacity;            /* Allocated control flow entries */
+    bool fuse;                  /* Apply superinstructions on finish */
+    bool late_bind;             /* Call every dictionary word by name, as OP_CALL_NAME */
+} vm_builder_t;
+
+/* Definition compiler */
+vm_builder_t* vm_builder_create(void);
+void vm_builder_destroy(vm_builder_t *builder);
+bool vm_compile_token(rforth_ctx_t *ctx, vm_builder_t *builder, const token_t *token);
+bool vm_builder_finish(rforth_ctx_t *ctx, vm_builder_t *builder, instr_t **code, int *length);
+
+/* Compile a control structure met while interpreting, then run it */
+bool vm_interpret_control(rforth_ctx_t *ctx, symbol_t name);
+
+/* Inner interpreter */
+void vm_execute(rforth_ctx_t *ctx, word_t *word);
+void vm_code_free(instr_t *code, int length);
+void vm_thread_code(instr_t *code, int length);
+bool vm_resolve_call(rforth_ctx_t *ctx, instr_t *instr);
+bool vm_loop_push(rforth_ctx_t *ctx, int64_t index, int64_t limit);
+
+/* Dispatch diagnostics */
+const char* vm_dispatch_name(void);
+void vm_report_dispatch_cost(rforth_ctx_t *ctx, int64_t iterations);
+void vm_report_superinstructions(int count);
+
+#endif /* VM_H */
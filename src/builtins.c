@@ -2,6 +2,9 @@
 #include "turnkey.h"
 #include "gpio_rpi.h"
 #include "timing_rpi.h"
+#include "vm.h"
+#include "floating.h"
+#include "evalcache.h"
 #include <stdio.h>
 #include <math.h>
 #include <ctype.h>
@@ -16,9 +19,6 @@
     #define PRId64_PORTABLE PRId64
 #endif
 
-/* Minimum valid address for memory operations (avoid null and low memory) */
-#define MIN_VALID_ADDRESS 4096
-
 /* Forward declarations */
 static void builtin_add(rforth_ctx_t *ctx);
 static void builtin_sub(rforth_ctx_t *ctx);
@@ -35,6 +35,7 @@ static void builtin_emit(rforth_ctx_t *ctx);
 static void builtin_cr(rforth_ctx_t *ctx);
 static void builtin_space(rforth_ctx_t *ctx);
 static void builtin_words_cmd(rforth_ctx_t *ctx);
+static void builtin_forget(rforth_ctx_t *ctx);
 static void builtin_bye(rforth_ctx_t *ctx);
 static void builtin_equal(rforth_ctx_t *ctx);
 static void builtin_less(rforth_ctx_t *ctx);
@@ -45,7 +46,6 @@ static void builtin_not(rforth_ctx_t *ctx);
 static void builtin_negate(rforth_ctx_t *ctx);
 
 /* Floating point specific words */
-static void builtin_f_dot(rforth_ctx_t *ctx);
 static void builtin_int_to_float(rforth_ctx_t *ctx);
 static void builtin_float_to_int(rforth_ctx_t *ctx);
 static void builtin_sqrt(rforth_ctx_t *ctx);
@@ -197,6 +197,11 @@ static void builtin_one_minus(rforth_ctx_t *ctx);
 static void builtin_two_star(rforth_ctx_t *ctx);
 static void builtin_two_slash(rforth_ctx_t *ctx);
 
+/* Diagnostics */
+static void builtin_dispatch_cost(rforth_ctx_t *ctx);
+static void builtin_superinstructions(rforth_ctx_t *ctx);
+static void builtin_eval_cache(rforth_ctx_t *ctx);
+
 /* Structure to hold builtin word definitions */
 typedef struct {
     const char *name;
@@ -208,120 +213,54 @@ static void set_error_simple(rforth_ctx_t *ctx, rforth_error_t code, const char
     rforth_set_error(ctx, code, message, "builtin", __FILE__, __LINE__, 0);
 }
 
-/* Control flow operations */
+/* Cells at addr, which must lie in allotted data space */
+static cell_t* data_cells(rforth_ctx_t *ctx, const cell_t *addr, int count, const char *message) {
+    cell_t *cells = NULL;
+    if (CELL_TYPE(*addr) == CELL_INT) {
+        cells = dataspace_ptr(&ctx->data_space, addr->value.i, (size_t)count * sizeof(cell_t));
+    }
+    if (!cells) set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, message);
+    return cells;
+}
+
+/*
+ * Bytes at addr: allotted data space, or host memory outside the data
+ * space reservation (S" strings, GPIO buffers). Reserved bytes past HERE
+ * are refused.
+ */
+static unsigned char* data_bytes(rforth_ctx_t *ctx, int64_t addr, int64_t count, const char *message) {
+    const dataspace_t *space = &ctx->data_space;
+    uint64_t offset = (uint64_t)addr - (uint64_t)(uintptr_t)space->base;
+    unsigned char *bytes = NULL;
+    if (count >= 0) {
+        if (offset < space->limit) {
+            bytes = dataspace_ptr(space, addr, (size_t)count);
+        } else if (addr >= MIN_VALID_ADDRESS) {
+            bytes = (unsigned char*)(uintptr_t)addr;
+        }
+    }
+    if (!bytes) set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, message);
+    return bytes;
+}
+
+/*
+ * Control flow operations. Inside a definition these words are compiled
+ * to branches by the VM and never executed; met while interpreting, the
+ * whole structure is compiled to anonymous threaded code and run once.
+ */
 static void builtin_if(rforth_ctx_t *ctx) {
     /* IF - Begin conditional execution ( flag -- ) */
-    
-    /* If we're already skipping, just track nesting depth */
-    if (ctx->skip_mode) {
-        ctx->skip_depth++;
-        return;
-    }
-    
-    /* Pop condition from stack */
-    cell_t condition;
-    if (!stack_pop(ctx->data_stack, &condition)) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "IF requires condition on stack");
-        return;
-    }
-    
-    /* Evaluate condition (non-zero is true) */
-    bool is_true = false;
-    if (condition.type == CELL_INT) {
-        is_true = (condition.value.i != 0);
-    } else {
-        is_true = (condition.value.f != 0.0);
-    }
-    
-    /* If condition is false, enter skip mode */
-    if (!is_true) {
-        ctx->skip_mode = true;
-        ctx->skip_depth = 1;  /* Start tracking nesting */
-    }
-    
-    /* Push IF onto control flow stack for ELSE/THEN matching */
-    if (ctx->cf_sp >= 32) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Control flow stack overflow");
-        return;
-    }
-    
-    ctx->cf_stack[ctx->cf_sp].type = CF_IF;
-    ctx->cf_stack[ctx->cf_sp].condition_met = is_true;
-    ctx->cf_sp++;
+    vm_interpret_control(ctx, SYM_IF);
 }
 
 static void builtin_then(rforth_ctx_t *ctx) {
     /* THEN - End conditional execution */
-    
-    /* If we're skipping and this is a nested IF, just decrement depth */
-    if (ctx->skip_mode && ctx->skip_depth > 1) {
-        ctx->skip_depth--;
-        return;
-    }
-    
-    /* Check control flow stack */
-    if (ctx->cf_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "THEN without matching IF");
-        return;
-    }
-    
-    ctx->cf_sp--;
-    if (ctx->cf_stack[ctx->cf_sp].type != CF_IF) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "THEN without matching IF");
-        return;
-    }
-    
-    /* If we were skipping due to false IF, stop skipping */
-    if (ctx->skip_mode) {
-        ctx->skip_mode = false;
-        ctx->skip_depth = 0;
-    }
+    vm_interpret_control(ctx, SYM_THEN);
 }
 
 static void builtin_else(rforth_ctx_t *ctx) {
     /* ELSE - Switch between IF/ELSE branches */
-    
-    /* If we're in nested skip mode, ignore this ELSE */
-    if (ctx->skip_mode && ctx->skip_depth > 1) {
-        return;
-    }
-    
-    /* Check control flow stack */
-    if (ctx->cf_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "ELSE without matching IF");
-        return;
-    }
-    
-    if (ctx->cf_stack[ctx->cf_sp - 1].type != CF_IF) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "ELSE without matching IF");
-        return;
-    }
-    
-    /* Toggle execution: if we were executing, start skipping; if skipping, start executing */
-    if (ctx->skip_mode) {
-        /* We were skipping the IF branch, now execute the ELSE branch */
-        ctx->skip_mode = false;
-        ctx->skip_depth = 0;
-    } else {
-        /* We were executing the IF branch, now skip the ELSE branch */
-        ctx->skip_mode = true;
-        ctx->skip_depth = 1;
-    }
-    
-    /* Update control flow stack to reflect the toggle */
-    ctx->cf_stack[ctx->cf_sp - 1].condition_met = !ctx->cf_stack[ctx->cf_sp - 1].condition_met;
-}
-
-/* Simple variable implementation using name-value pairs */
-static variable_entry_t* find_variable(rforth_ctx_t *ctx, const char *name) {
-    variable_entry_t *var = ctx->variables;
-    while (var) {
-        if (strcmp(var->name, name) == 0) {
-            return var;
-        }
-        var = var->next;
-    }
-    return NULL;
+    vm_interpret_control(ctx, SYM_ELSE);
 }
 
 static void builtin_variable(rforth_ctx_t *ctx) {
@@ -334,9 +273,17 @@ static void builtin_variable(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* Add variable to dictionary with initial value 0 */
-    cell_t initial_value = cell_make_int(0);
-    if (!dict_add_variable(ctx->dict, name_token.text, initial_value)) {
+    /* One aligned cell of data space, initially 0 */
+    if (!dataspace_align(&ctx->data_space, sizeof(cell_t)) ||
+        !dataspace_allot(&ctx->data_space, sizeof(cell_t))) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "VARIABLE: data space full");
+        return;
+    }
+    cell_t *slot = (cell_t*)(ctx->data_space.base + ctx->data_space.here) - 1;
+    *slot = cell_make_int(0);
+    char name[MAX_WORD_LENGTH];
+    parser_token_text(&name_token, name, sizeof(name));
+    if (!dict_add_variable(ctx->dict, name, slot)) {
         set_error_simple(ctx, RFORTH_ERROR_MEMORY, "Failed to create variable");
         return;
     }
@@ -350,7 +297,7 @@ static void builtin_one_plus(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         stack_push_int(ctx->data_stack, a.value.i + 1);
     } else {
         stack_push_float(ctx->data_stack, a.value.f + 1.0);
@@ -364,7 +311,7 @@ static void builtin_one_minus(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         stack_push_int(ctx->data_stack, a.value.i - 1);
     } else {
         stack_push_float(ctx->data_stack, a.value.f - 1.0);
@@ -379,12 +326,12 @@ static void builtin_max(rforth_ctx_t *ctx) {
     }
     
     /* Compare and push maximum */
-    if (b.type == CELL_INT && a.type == CELL_INT) {
+    if (CELL_TYPE(b) == CELL_INT && CELL_TYPE(a) == CELL_INT) {
         int64_t result = (b.value.i > a.value.i) ? b.value.i : a.value.i;
         stack_push_int(ctx->data_stack, result);
     } else {
-        double val_b = (b.type == CELL_INT) ? (double)b.value.i : b.value.f;
-        double val_a = (a.type == CELL_INT) ? (double)a.value.i : a.value.f;
+        double val_b = (CELL_TYPE(b) == CELL_INT) ? (double)b.value.i : b.value.f;
+        double val_a = (CELL_TYPE(a) == CELL_INT) ? (double)a.value.i : a.value.f;
         double result = (val_b > val_a) ? val_b : val_a;
         stack_push_float(ctx->data_stack, result);
     }
@@ -398,12 +345,12 @@ static void builtin_min(rforth_ctx_t *ctx) {
     }
     
     /* Compare and push minimum */
-    if (b.type == CELL_INT && a.type == CELL_INT) {
+    if (CELL_TYPE(b) == CELL_INT && CELL_TYPE(a) == CELL_INT) {
         int64_t result = (b.value.i < a.value.i) ? b.value.i : a.value.i;
         stack_push_int(ctx->data_stack, result);
     } else {
-        double val_b = (b.type == CELL_INT) ? (double)b.value.i : b.value.f;
-        double val_a = (a.type == CELL_INT) ? (double)a.value.i : a.value.f;
+        double val_b = (CELL_TYPE(b) == CELL_INT) ? (double)b.value.i : b.value.f;
+        double val_a = (CELL_TYPE(a) == CELL_INT) ? (double)a.value.i : a.value.f;
         double result = (val_b < val_a) ? val_b : val_a;
         stack_push_float(ctx->data_stack, result);
     }
@@ -418,7 +365,7 @@ static void builtin_pick(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (index_cell.type != CELL_INT) {
+    if (CELL_TYPE(index_cell) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "PICK requires integer index");
         return;
     }
@@ -441,7 +388,7 @@ static void builtin_roll(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (count_cell.type != CELL_INT) {
+    if (CELL_TYPE(count_cell) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "ROLL requires integer count");
         return;
     }
@@ -569,7 +516,7 @@ static void builtin_two_star(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         stack_push_int(ctx->data_stack, a.value.i * 2);
     } else {
         stack_push_float(ctx->data_stack, a.value.f * 2.0);
@@ -584,7 +531,7 @@ static void builtin_two_slash(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         stack_push_int(ctx->data_stack, a.value.i / 2);
     } else {
         stack_push_float(ctx->data_stack, a.value.f / 2.0);
@@ -599,7 +546,7 @@ static void builtin_slash_mod(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (divisor.type != CELL_INT || dividend.type != CELL_INT) {
+    if (CELL_TYPE(divisor) != CELL_INT || CELL_TYPE(dividend) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "/MOD requires integer operands");
         return;
     }
@@ -629,7 +576,7 @@ static void builtin_question_dup(rforth_ctx_t *ctx) {
     
     /* If non-zero, duplicate it */
     bool is_nonzero = false;
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         is_nonzero = (a.value.i != 0);
     } else {
         is_nonzero = (a.value.f != 0.0);
@@ -649,7 +596,7 @@ static void builtin_zero_equals(rforth_ctx_t *ctx) {
     }
     
     bool is_zero = false;
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         is_zero = (a.value.i == 0);
     } else {
         is_zero = (a.value.f == 0.0);
@@ -667,7 +614,7 @@ static void builtin_zero_less(rforth_ctx_t *ctx) {
     }
     
     bool is_negative = false;
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         is_negative = (a.value.i < 0);
     } else {
         is_negative = (a.value.f < 0.0);
@@ -685,7 +632,7 @@ static void builtin_zero_greater(rforth_ctx_t *ctx) {
     }
     
     bool is_positive = false;
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         is_positive = (a.value.i > 0);
     } else {
         is_positive = (a.value.f > 0.0);
@@ -704,13 +651,13 @@ static void builtin_not_equals(rforth_ctx_t *ctx) {
     }
     
     bool not_equal = false;
-    if (a.type == CELL_INT && b.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_INT) {
         not_equal = (a.value.i != b.value.i);
-    } else if (a.type == CELL_FLOAT && b.type == CELL_FLOAT) {
+    } else if (CELL_TYPE(a) == CELL_FLOAT && CELL_TYPE(b) == CELL_FLOAT) {
         not_equal = (a.value.f != b.value.f);
-    } else if (a.type == CELL_INT && b.type == CELL_FLOAT) {
+    } else if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_FLOAT) {
         not_equal = ((double)a.value.i != b.value.f);
-    } else if (a.type == CELL_FLOAT && b.type == CELL_INT) {
+    } else if (CELL_TYPE(a) == CELL_FLOAT && CELL_TYPE(b) == CELL_INT) {
         not_equal = (a.value.f != (double)b.value.i);
     }
     
@@ -726,13 +673,13 @@ static void builtin_greater_equals(rforth_ctx_t *ctx) {
     }
     
     bool greater_equal = false;
-    if (a.type == CELL_INT && b.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_INT) {
         greater_equal = (a.value.i >= b.value.i);
-    } else if (a.type == CELL_FLOAT && b.type == CELL_FLOAT) {
+    } else if (CELL_TYPE(a) == CELL_FLOAT && CELL_TYPE(b) == CELL_FLOAT) {
         greater_equal = (a.value.f >= b.value.f);
-    } else if (a.type == CELL_INT && b.type == CELL_FLOAT) {
+    } else if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_FLOAT) {
         greater_equal = ((double)a.value.i >= b.value.f);
-    } else if (a.type == CELL_FLOAT && b.type == CELL_INT) {
+    } else if (CELL_TYPE(a) == CELL_FLOAT && CELL_TYPE(b) == CELL_INT) {
         greater_equal = (a.value.f >= (double)b.value.i);
     }
     
@@ -748,13 +695,13 @@ static void builtin_less_equals(rforth_ctx_t *ctx) {
     }
     
     bool less_equal = false;
-    if (a.type == CELL_INT && b.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_INT) {
         less_equal = (a.value.i <= b.value.i);
-    } else if (a.type == CELL_FLOAT && b.type == CELL_FLOAT) {
+    } else if (CELL_TYPE(a) == CELL_FLOAT && CELL_TYPE(b) == CELL_FLOAT) {
         less_equal = (a.value.f <= b.value.f);
-    } else if (a.type == CELL_INT && b.type == CELL_FLOAT) {
+    } else if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_FLOAT) {
         less_equal = ((double)a.value.i <= b.value.f);
-    } else if (a.type == CELL_FLOAT && b.type == CELL_INT) {
+    } else if (CELL_TYPE(a) == CELL_FLOAT && CELL_TYPE(b) == CELL_INT) {
         less_equal = (a.value.f <= (double)b.value.i);
     }
     
@@ -764,358 +711,43 @@ static void builtin_less_equals(rforth_ctx_t *ctx) {
 /* Loop constructs */
 static void builtin_begin(rforth_ctx_t *ctx) {
     /* BEGIN - Start indefinite loop */
-    
-    /* If we're in skip mode, track nesting */
-    if (ctx->skip_mode) {
-        ctx->skip_depth++;
-        return;
-    }
-    
-    /* Push BEGIN onto control flow stack */
-    if (ctx->cf_sp >= 32) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Control flow stack overflow");
-        return;
-    }
-    
-    /* Save current parser position for loop restart */
-    if (ctx->loop_sp >= 32) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Loop stack overflow");
-        return;
-    }
-    
-    ctx->loop_start[ctx->loop_sp] = ctx->parser->current;
-    ctx->loop_sp++;
-    
-    ctx->cf_stack[ctx->cf_sp].type = CF_BEGIN;
-    ctx->cf_stack[ctx->cf_sp].address = ctx->loop_sp - 1;  /* Index into loop_start array */
-    ctx->cf_sp++;
+    vm_interpret_control(ctx, SYM_BEGIN);
 }
 
 static void builtin_until(rforth_ctx_t *ctx) {
     /* UNTIL - End loop if condition is true ( flag -- ) */
-    
-    /* If we're skipping and this is nested, just decrement depth */
-    if (ctx->skip_mode && ctx->skip_depth > 1) {
-        ctx->skip_depth--;
-        return;
-    }
-    
-    /* Check control flow stack */
-    if (ctx->cf_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "UNTIL without matching BEGIN");
-        return;
-    }
-    
-    ctx->cf_sp--;
-    if (ctx->cf_stack[ctx->cf_sp].type != CF_BEGIN) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "UNTIL without matching BEGIN");
-        return;
-    }
-    
-    /* If we were skipping, stop now */
-    if (ctx->skip_mode) {
-        ctx->skip_mode = false;
-        ctx->skip_depth = 0;
-        ctx->loop_sp--;  /* Pop loop stack */
-        return;
-    }
-    
-    /* Pop condition from stack */
-    cell_t condition;
-    if (!stack_pop(ctx->data_stack, &condition)) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "UNTIL requires condition on stack");
-        return;
-    }
-    
-    /* Check if condition is true (non-zero) */
-    bool exit_loop = false;
-    if (condition.type == CELL_INT) {
-        exit_loop = (condition.value.i != 0);
-    } else {
-        exit_loop = (condition.value.f != 0.0);
-    }
-    
-    if (exit_loop) {
-        /* Exit loop - pop loop stack */
-        ctx->loop_sp--;
-    } else {
-        /* Continue loop - restore parser position */
-        int loop_index = (int)ctx->cf_stack[ctx->cf_sp].address;
-        ctx->parser->current = ctx->loop_start[loop_index];
-        
-        /* Push BEGIN back onto control flow stack for next iteration */
-        ctx->cf_stack[ctx->cf_sp].type = CF_BEGIN;
-        ctx->cf_stack[ctx->cf_sp].address = loop_index;
-        ctx->cf_sp++;
-    }
+    vm_interpret_control(ctx, SYM_UNTIL);
 }
 
 static void builtin_while(rforth_ctx_t *ctx) {
     /* WHILE - Continue loop if condition is true ( flag -- ) */
-    
-    /* If we're in skip mode, track nesting */
-    if (ctx->skip_mode) {
-        return;  /* Don't change skip state */
-    }
-    
-    /* Pop condition from stack */
-    cell_t condition;
-    if (!stack_pop(ctx->data_stack, &condition)) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "WHILE requires condition on stack");
-        return;
-    }
-    
-    /* Check if condition is false */
-    bool continue_loop = false;
-    if (condition.type == CELL_INT) {
-        continue_loop = (condition.value.i != 0);
-    } else {
-        continue_loop = (condition.value.f != 0.0);
-    }
-    
-    if (!continue_loop) {
-        /* Condition is false - enter skip mode until REPEAT */
-        ctx->skip_mode = true;
-        ctx->skip_depth = 1;
-    }
+    vm_interpret_control(ctx, SYM_WHILE);
 }
 
 static void builtin_repeat(rforth_ctx_t *ctx) {
     /* REPEAT - End of BEGIN/WHILE loop */
-    
-    /* If we're skipping due to false WHILE, stop skipping and exit loop */
-    if (ctx->skip_mode) {
-        ctx->skip_mode = false;
-        ctx->skip_depth = 0;
-        
-        /* Pop control flow and loop stacks */
-        if (ctx->cf_sp > 0) ctx->cf_sp--;
-        if (ctx->loop_sp > 0) ctx->loop_sp--;
-        return;
-    }
-    
-    /* Check control flow stack */
-    if (ctx->cf_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "REPEAT without matching BEGIN");
-        return;
-    }
-    
-    ctx->cf_sp--;
-    if (ctx->cf_stack[ctx->cf_sp].type != CF_BEGIN) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "REPEAT without matching BEGIN");
-        return;
-    }
-    
-    /* Loop back to BEGIN */
-    int loop_index = (int)ctx->cf_stack[ctx->cf_sp].address;
-    ctx->parser->current = ctx->loop_start[loop_index];
-    
-    /* Push BEGIN back onto control flow stack for next iteration */
-    ctx->cf_stack[ctx->cf_sp].type = CF_BEGIN;
-    ctx->cf_stack[ctx->cf_sp].address = loop_index;
-    ctx->cf_sp++;
+    vm_interpret_control(ctx, SYM_REPEAT);
 }
 
 /* Counted loops (DO/LOOP) */
 static void builtin_do(rforth_ctx_t *ctx) {
     /* DO - Start counted loop ( limit index -- ) */
-    
-    /* If we're in skip mode, track nesting */
-    if (ctx->skip_mode) {
-        ctx->skip_depth++;
-        return;
-    }
-    
-    /* Pop index and limit from data stack */
-    cell_t index, limit;
-    if (!stack_pop(ctx->data_stack, &index) || !stack_pop(ctx->data_stack, &limit)) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "DO requires limit and index on stack");
-        return;
-    }
-    
-    /* Check stack bounds */
-    if (ctx->do_loop_sp >= 32) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_OVERFLOW, "DO/LOOP stack overflow");
-        return;
-    }
-    
-    if (ctx->loop_sp >= 32) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Loop stack overflow");
-        return;
-    }
-    
-    if (ctx->cf_sp >= 32) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Control flow stack overflow");
-        return;
-    }
-    
-    /* Store loop parameters */
-    ctx->loop_index[ctx->do_loop_sp] = (index.type == CELL_INT) ? index.value.i : (int64_t)index.value.f;
-    ctx->loop_limit[ctx->do_loop_sp] = (limit.type == CELL_INT) ? limit.value.i : (int64_t)limit.value.f;
-    ctx->do_loop_sp++;
-    
-    /* Save loop start position */
-    ctx->loop_start[ctx->loop_sp] = ctx->parser->current;
-    ctx->loop_sp++;
-    
-    /* Push DO onto control flow stack */
-    ctx->cf_stack[ctx->cf_sp].type = CF_DO;
-    ctx->cf_stack[ctx->cf_sp].address = ctx->loop_sp - 1;  /* Index into loop_start array */
-    ctx->cf_sp++;
+    vm_interpret_control(ctx, SYM_DO);
 }
 
 static void builtin_loop(rforth_ctx_t *ctx) {
     /* LOOP - End counted loop, increment by 1 */
-    
-    /* If we're skipping and this is nested, just decrement depth */
-    if (ctx->skip_mode && ctx->skip_depth > 1) {
-        ctx->skip_depth--;
-        return;
-    }
-    
-    /* Check control flow stack */
-    if (ctx->cf_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "LOOP without matching DO");
-        return;
-    }
-    
-    ctx->cf_sp--;
-    if (ctx->cf_stack[ctx->cf_sp].type != CF_DO) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "LOOP without matching DO");
-        return;
-    }
-    
-    /* If we were skipping, stop now */
-    if (ctx->skip_mode) {
-        ctx->skip_mode = false;
-        ctx->skip_depth = 0;
-        ctx->loop_sp--;
-        ctx->do_loop_sp--;
-        return;
-    }
-    
-    /* Check DO/LOOP stack */
-    if (ctx->do_loop_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "LOOP without matching DO");
-        return;
-    }
-    
-    /* Increment index */
-    ctx->loop_index[ctx->do_loop_sp - 1]++;
-    
-    /* Check if loop should continue */
-    if (ctx->loop_index[ctx->do_loop_sp - 1] < ctx->loop_limit[ctx->do_loop_sp - 1]) {
-        /* Continue loop - restore parser position */
-        int loop_pos = (int)ctx->cf_stack[ctx->cf_sp].address;
-        ctx->parser->current = ctx->loop_start[loop_pos];
-        
-        /* Push DO back onto control flow stack for next iteration */
-        ctx->cf_stack[ctx->cf_sp].type = CF_DO;
-        ctx->cf_stack[ctx->cf_sp].address = loop_pos;
-        ctx->cf_sp++;
-    } else {
-        /* Exit loop - pop stacks */
-        ctx->loop_sp--;
-        ctx->do_loop_sp--;
-    }
+    vm_interpret_control(ctx, SYM_LOOP);
 }
 
 static void builtin_plus_loop(rforth_ctx_t *ctx) {
     /* +LOOP - End counted loop, increment by n ( n -- ) */
-    
-    /* If we're skipping and this is nested, just decrement depth */
-    if (ctx->skip_mode && ctx->skip_depth > 1) {
-        ctx->skip_depth--;
-        return;
-    }
-    
-    /* Check control flow stack */
-    if (ctx->cf_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "+LOOP without matching DO");
-        return;
-    }
-    
-    ctx->cf_sp--;
-    if (ctx->cf_stack[ctx->cf_sp].type != CF_DO) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "+LOOP without matching DO");
-        return;
-    }
-    
-    /* If we were skipping, stop now */
-    if (ctx->skip_mode) {
-        ctx->skip_mode = false;
-        ctx->skip_depth = 0;
-        ctx->loop_sp--;
-        ctx->do_loop_sp--;
-        return;
-    }
-    
-    /* Pop increment from data stack */
-    cell_t increment;
-    if (!stack_pop(ctx->data_stack, &increment)) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "+LOOP requires increment on stack");
-        return;
-    }
-    
-    /* Check DO/LOOP stack */
-    if (ctx->do_loop_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "+LOOP without matching DO");
-        return;
-    }
-    
-    /* Add increment to index */
-    int64_t inc = (increment.type == CELL_INT) ? increment.value.i : (int64_t)increment.value.f;
-    ctx->loop_index[ctx->do_loop_sp - 1] += inc;
-    
-    /* Check if loop should continue (handle both positive and negative increments) */
-    bool continue_loop = false;
-    if (inc >= 0) {
-        continue_loop = (ctx->loop_index[ctx->do_loop_sp - 1] < ctx->loop_limit[ctx->do_loop_sp - 1]);
-    } else {
-        continue_loop = (ctx->loop_index[ctx->do_loop_sp - 1] >= ctx->loop_limit[ctx->do_loop_sp - 1]);
-    }
-    
-    if (continue_loop) {
-        /* Continue loop - restore parser position */
-        int loop_pos = (int)ctx->cf_stack[ctx->cf_sp].address;
-        ctx->parser->current = ctx->loop_start[loop_pos];
-        
-        /* Push DO back onto control flow stack for next iteration */
-        ctx->cf_stack[ctx->cf_sp].type = CF_DO;
-        ctx->cf_stack[ctx->cf_sp].address = loop_pos;
-        ctx->cf_sp++;
-    } else {
-        /* Exit loop - pop stacks */
-        ctx->loop_sp--;
-        ctx->do_loop_sp--;
-    }
+    vm_interpret_control(ctx, SYM_PLUS_LOOP);
 }
 
 static void builtin_leave(rforth_ctx_t *ctx) {
     /* LEAVE - Exit current DO/LOOP immediately */
-    
-    /* Check if we're in a DO/LOOP */
-    if (ctx->do_loop_sp <= 0) {
-        set_error_simple(ctx, RFORTH_ERROR_CONTROL_FLOW, "LEAVE without matching DO");
-        return;
-    }
-    
-    /* Find and remove the DO from control flow stack */
-    for (int i = ctx->cf_sp - 1; i >= 0; i--) {
-        if (ctx->cf_stack[i].type == CF_DO) {
-            /* Remove this entry and all after it */
-            ctx->cf_sp = i;
-            break;
-        }
-    }
-    
-    /* Pop DO/LOOP stacks */
-    ctx->loop_sp--;
-    ctx->do_loop_sp--;
-    
-    /* Set skip mode to skip until LOOP or +LOOP */
-    ctx->skip_mode = true;
-    ctx->skip_depth = 1;
+    vm_interpret_control(ctx, SYM_LEAVE);
 }
 
 static void builtin_i(rforth_ctx_t *ctx) {
@@ -1163,19 +795,13 @@ static void builtin_c_fetch(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (addr.type != CELL_INT) {
+    if (CELL_TYPE(addr) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "C@ requires integer address");
         return;
     }
     
-    /* Safety check - don't access null or very low addresses */
-    if (addr.value.i < MIN_VALID_ADDRESS) {
-        set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, "C@ invalid address");
-        return;
-    }
-    
-    /* Read byte from address */
-    unsigned char *ptr = (unsigned char *)(uintptr_t)addr.value.i;
+    unsigned char *ptr = data_bytes(ctx, addr.value.i, 1, "C@ invalid address");
+    if (!ptr) return;
     unsigned char byte = *ptr;
     
     stack_push_int(ctx->data_stack, byte);
@@ -1189,19 +815,13 @@ static void builtin_c_store(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (addr.type != CELL_INT || byte.type != CELL_INT) {
+    if (CELL_TYPE(addr) != CELL_INT || CELL_TYPE(byte) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "C! requires integer operands");
         return;
     }
     
-    /* Safety check - don't access null or very low addresses */
-    if (addr.value.i < MIN_VALID_ADDRESS) {
-        set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, "C! invalid address");
-        return;
-    }
-    
-    /* Store byte to address */
-    unsigned char *ptr = (unsigned char *)(uintptr_t)addr.value.i;
+    unsigned char *ptr = data_bytes(ctx, addr.value.i, 1, "C! invalid address");
+    if (!ptr) return;
     *ptr = (unsigned char)(byte.value.i & 0xFF);
 }
 
@@ -1214,7 +834,7 @@ static void builtin_star_slash(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (n1.type != CELL_INT || n2.type != CELL_INT || n3.type != CELL_INT) {
+    if (CELL_TYPE(n1) != CELL_INT || CELL_TYPE(n2) != CELL_INT || CELL_TYPE(n3) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "*/ requires integer operands");
         return;
     }
@@ -1239,7 +859,7 @@ static void builtin_star_slash_mod(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (n1.type != CELL_INT || n2.type != CELL_INT || n3.type != CELL_INT) {
+    if (CELL_TYPE(n1) != CELL_INT || CELL_TYPE(n2) != CELL_INT || CELL_TYPE(n3) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "*/MOD requires integer operands");
         return;
     }
@@ -1267,7 +887,7 @@ static void builtin_fm_slash_mod(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (d_low.type != CELL_INT || n.type != CELL_INT) {
+    if (CELL_TYPE(d_low) != CELL_INT || CELL_TYPE(n) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "FM/MOD requires integer operands");
         return;
     }
@@ -1303,7 +923,7 @@ static void builtin_execute(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (xt.type != CELL_INT) {
+    if (CELL_TYPE(xt) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "EXECUTE requires integer execution token");
         return;
     }
@@ -1321,6 +941,34 @@ static void builtin_execute(rforth_ctx_t *ctx) {
     func(ctx);
 }
 
+/*
+ * Frame for the next EVALUATE nesting level. Frames are allocated one at
+ * a time and never move, so an outer level's parser stays valid while
+ * inner levels grow the table; after the first call at a given depth
+ * EVALUATE allocates nothing.
+ */
+static eval_frame_t* eval_frame_acquire(rforth_ctx_t *ctx) {
+    if (ctx->eval_depth == ctx->eval_capacity) {
+        int capacity = ctx->eval_capacity ? ctx->eval_capacity * 2 : 8;
+        eval_frame_t **frames = realloc(ctx->eval_frames, sizeof(eval_frame_t *) * capacity);
+        if (!frames) return NULL;
+        for (int i = ctx->eval_capacity; i < capacity; i++) frames[i] = NULL;
+        ctx->eval_frames = frames;
+        ctx->eval_capacity = capacity;
+    }
+    
+    eval_frame_t *frame = ctx->eval_frames[ctx->eval_depth];
+    if (!frame) {
+        frame = calloc(1, sizeof(eval_frame_t));
+        if (!frame) return NULL;
+        parser_init(&frame->parser);
+        ctx->eval_frames[ctx->eval_depth] = frame;
+    }
+    
+    ctx->eval_depth++;
+    return frame;
+}
+
 static void builtin_evaluate(rforth_ctx_t *ctx) {
     /* EVALUATE - Interpret string ( addr len -- ) */
     cell_t len, addr;
@@ -1329,7 +977,7 @@ static void builtin_evaluate(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (addr.type != CELL_INT || len.type != CELL_INT) {
+    if (CELL_TYPE(addr) != CELL_INT || CELL_TYPE(len) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "EVALUATE requires integer operands");
         return;
     }
@@ -1345,20 +993,53 @@ static void builtin_evaluate(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* Create a null-terminated copy of the string */
-    char *eval_string = malloc(len.value.i + 1);
-    if (!eval_string) {
-        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "EVALUATE memory allocation failed");
+    eval_frame_t *frame = eval_frame_acquire(ctx);
+    if (!frame) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "EVALUATE frame allocation failed");
         return;
     }
     
-    strncpy(eval_string, str, len.value.i);
-    eval_string[len.value.i] = '\0';
-    
-    /* Interpret the string */
-    int result = rforth_interpret_string(ctx, eval_string);
+    /*
+     * Tokenize the caller's buffer in place when it is already
+     * NUL-terminated (S" literals and the interpret-mode S" buffer are).
+     * In data space the terminator must lie inside the allotted region
+     * before it can be read; anything else is copied into the frame.
+     */
+    size_t length = (size_t)len.value.i;
+    const char *input = str ? str : "";
+    bool terminated = true;
+    if (str) {
+        if (dataspace_ptr(&ctx->data_space, addr.value.i, length)) {
+            terminated = dataspace_ptr(&ctx->data_space, addr.value.i, length + 1) &&
+                         str[length] == '\0';
+        } else {
+            terminated = str[length] == '\0';
+        }
+    }
+    if (!terminated) {
+        if (length + 1 > frame->capacity) {
+            size_t capacity = frame->capacity ? frame->capacity : 256;
+            while (capacity < length + 1) capacity *= 2;
+            char *buffer = realloc(frame->buffer, capacity);
+            if (!buffer) {
+                ctx->eval_depth--;
+                set_error_simple(ctx, RFORTH_ERROR_MEMORY, "EVALUATE memory allocation failed");
+                return;
+            }
+            frame->buffer = buffer;
+            frame->capacity = capacity;
+        }
+        memcpy(frame->buffer, str, length);
+        frame->buffer[length] = '\0';
+        input = frame->buffer;
+    }
     
-    free(eval_string);
+    /* Interpret the string with its own parser so the caller's input is untouched */
+    parser_t *saved_parser = ctx->parser;
+    ctx->parser = &frame->parser;
+    int result = rforth_interpret_string(ctx, input);
+    ctx->parser = saved_parser;
+    ctx->eval_depth--;
     
     if (result != 0) {
         set_error_simple(ctx, RFORTH_ERROR_SYNTAX_ERROR, "EVALUATE interpretation failed");
@@ -1378,15 +1059,9 @@ static void builtin_quit(rforth_ctx_t *ctx) {
         stack_pop(ctx->return_stack, &dummy);
     }
     
-    /* Clear control flow stacks */
-    ctx->cf_sp = 0;
-    ctx->loop_sp = 0;
+    /* Clear loop parameters */
     ctx->do_loop_sp = 0;
     
-    /* Clear skip mode */
-    ctx->skip_mode = false;
-    ctx->skip_depth = 0;
-    
     /* Reset state */
     ctx->state = PARSE_INTERPRET;
     
@@ -1406,14 +1081,25 @@ static void builtin_abort(rforth_ctx_t *ctx) {
 
 /* Meta-compilation words */
 static void builtin_create(rforth_ctx_t *ctx) {
-    /* CREATE - Create a new word that pushes its data address ( -- ) */
-    /* This is a simplified implementation that creates a named variable */
-    
-    /* For simplicity, CREATE will work like VARIABLE for now */
-    /* A full implementation would create a word that pushes its parameter field address */
+    /* CREATE - Create a word that pushes the aligned HERE ( "<spaces>name" -- ) */
+    token_t name_token = parser_next_token(ctx->parser);
+    if (name_token.type != TOKEN_WORD) {
+        set_error_simple(ctx, RFORTH_ERROR_PARSE_ERROR, "CREATE requires a name");
+        return;
+    }
     
-    printf("CREATE - Creating new word (simplified as variable)\n");
-    builtin_variable(ctx);
+    /* The body is whatever ALLOT and , lay down next */
+    if (!dataspace_align(&ctx->data_space, sizeof(cell_t))) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "CREATE: data space full");
+        return;
+    }
+    cell_t *body = (cell_t*)(ctx->data_space.base + ctx->data_space.here);
+    char name[MAX_WORD_LENGTH];
+    parser_token_text(&name_token, name, sizeof(name));
+    if (!dict_add_variable(ctx->dict, name, body)) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "Failed to create word");
+        return;
+    }
 }
 
 static void builtin_does(rforth_ctx_t *ctx) {
@@ -1528,7 +1214,7 @@ static void builtin_type(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (len.type != CELL_INT || addr.type != CELL_INT) {
+    if (CELL_TYPE(len) != CELL_INT || CELL_TYPE(addr) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "TYPE requires integer operands");
         return;
     }
@@ -1557,7 +1243,7 @@ static void builtin_count(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (caddr.type != CELL_INT) {
+    if (CELL_TYPE(caddr) != CELL_INT) {
         set_error_simple(ctx, RFORTH_ERROR_TYPE_MISMATCH, "COUNT requires integer address");
         return;
     }
@@ -1588,13 +1274,8 @@ static void builtin_fetch(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* Treat address as direct pointer to cell */
-    if (addr.type != CELL_INT || addr.value.i < MIN_VALID_ADDRESS) {
-        set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, "@ invalid address");
-        return;
-    }
-    
-    cell_t *cell_ptr = (cell_t*)(uintptr_t)addr.value.i;
+    cell_t *cell_ptr = data_cells(ctx, &addr, 1, "@ invalid address");
+    if (!cell_ptr) return;
     
     /* Push cell value */
     stack_push_cell(ctx->data_stack, *cell_ptr);
@@ -1608,13 +1289,8 @@ static void builtin_store(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* Store value at direct cell address */
-    if (addr.type != CELL_INT || addr.value.i < MIN_VALID_ADDRESS) {
-        set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, "! invalid address");
-        return;
-    }
-    
-    cell_t *cell_ptr = (cell_t*)(uintptr_t)addr.value.i;
+    cell_t *cell_ptr = data_cells(ctx, &addr, 1, "! invalid address");
+    if (!cell_ptr) return;
     
     *cell_ptr = value;
 }
@@ -1627,21 +1303,16 @@ static void builtin_plus_store(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* Get cell at address */
-    cell_t *cell_ptr = (cell_t*)(uintptr_t)addr.value.i;
-    if (!cell_ptr) {
-        set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, "Invalid address");
-        return;
-    }
+    cell_t *cell_ptr = data_cells(ctx, &addr, 1, "+! invalid address");
+    if (!cell_ptr) return;
     
     /* Perform mixed-type addition */
-    if (cell_ptr->type == CELL_INT && value.type == CELL_INT) {
+    if (CELL_TYPE(*cell_ptr) == CELL_INT && CELL_TYPE(value) == CELL_INT) {
         cell_ptr->value.i += value.value.i;
     } else {
-        double a = (cell_ptr->type == CELL_INT) ? (double)cell_ptr->value.i : cell_ptr->value.f;
-        double b = (value.type == CELL_INT) ? (double)value.value.i : value.value.f;
-        cell_ptr->type = CELL_FLOAT;
-        cell_ptr->value.f = a + b;
+        double a = (CELL_TYPE(*cell_ptr) == CELL_INT) ? (double)cell_ptr->value.i : cell_ptr->value.f;
+        double b = (CELL_TYPE(value) == CELL_INT) ? (double)value.value.i : value.value.f;
+        *cell_ptr = cell_make_float(a + b);
     }
 }
 
@@ -1653,55 +1324,44 @@ static void builtin_question(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* Fetch and print variable value */
-    variable_entry_t *var = (variable_entry_t*)(uintptr_t)addr.value.i;
-    if (!var) {
-        set_error_simple(ctx, RFORTH_ERROR_INVALID_ADDRESS, "Invalid variable address");
-        return;
-    }
+    cell_t *var = data_cells(ctx, &addr, 1, "Invalid variable address");
+    if (!var) return;
     
     /* Print the value */
-    if (var->value.type == CELL_INT) {
-        printf("%" PRId64_PORTABLE " ", var->value.value.i);
+    if (CELL_TYPE(*var) == CELL_INT) {
+        printf("%" PRId64_PORTABLE " ", var->value.i);
     } else {
-        printf("%g ", var->value.value.f);
+        printf("%g ", var->value.f);
     }
 }
 
 /* ANSI Core Words - Phase 1 Implementation */
 
 static void builtin_here(rforth_ctx_t *ctx) {
-    /* HERE - Return address of dictionary pointer ( -- addr ) */
-    /* For simplified implementation, use a fixed address */
-    stack_push_int(ctx->data_stack, (int64_t)&ctx->here_ptr);
+    /* HERE - Address of the next free byte of data space ( -- addr ) */
+    stack_push_int(ctx->data_stack, dataspace_here(&ctx->data_space));
 }
 
 static void builtin_allot(rforth_ctx_t *ctx) {
-    /* ALLOT - Allocate n bytes in dictionary ( n -- ) */
+    /* ALLOT - Allocate n bytes in data space ( n -- ) */
     if (ctx->data_stack->size < 1) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "ALLOT requires byte count on stack");
         return;
     }
     
     cell_t n_cell;
-    if (!stack_pop(ctx->data_stack, &n_cell) || n_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &n_cell) || CELL_TYPE(n_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "ALLOT requires integer byte count");
         return;
     }
     
-    /* For simplified implementation, just advance HERE pointer */
-    if (!ctx->here_ptr) {
-        ctx->here_ptr = malloc(65536); /* Allocate dictionary space */
-        if (!ctx->here_ptr) {
-            set_error_simple(ctx, RFORTH_ERROR_MEMORY, "ALLOT memory allocation failed");
-            return;
-        }
+    if (!dataspace_allot(&ctx->data_space, n_cell.value.i)) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "ALLOT outside data space");
     }
-    ctx->here_ptr += n_cell.value.i;
 }
 
 static void builtin_comma(rforth_ctx_t *ctx) {
-    /* , - Compile cell into dictionary ( x -- ) */
+    /* , - Compile cell into data space ( x -- ) */
     if (ctx->data_stack->size < 1) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, ", requires value on stack");
         return;
@@ -1713,40 +1373,32 @@ static void builtin_comma(rforth_ctx_t *ctx) {
         return;
     }
     
-    /* For simplified implementation, store at HERE */
-    if (!ctx->here_ptr) {
-        ctx->here_ptr = malloc(65536);
-        if (!ctx->here_ptr) {
-            set_error_simple(ctx, RFORTH_ERROR_MEMORY, ", memory allocation failed");
-            return;
-        }
+    if (!dataspace_align(&ctx->data_space, sizeof(cell_t)) ||
+        !dataspace_allot(&ctx->data_space, sizeof(cell_t))) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, ", data space full");
+        return;
     }
-    *(cell_t*)ctx->here_ptr = value;
-    ctx->here_ptr += sizeof(cell_t);
+    ((cell_t*)(ctx->data_space.base + ctx->data_space.here))[-1] = value;
 }
 
 static void builtin_c_comma(rforth_ctx_t *ctx) {
-    /* C, - Compile character into dictionary ( char -- ) */
+    /* C, - Compile character into data space ( char -- ) */
     if (ctx->data_stack->size < 1) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "C, requires character on stack");
         return;
     }
     
     cell_t char_cell;
-    if (!stack_pop(ctx->data_stack, &char_cell) || char_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &char_cell) || CELL_TYPE(char_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "C, requires integer character");
         return;
     }
     
-    if (!ctx->here_ptr) {
-        ctx->here_ptr = malloc(65536);
-        if (!ctx->here_ptr) {
-            set_error_simple(ctx, RFORTH_ERROR_MEMORY, "C, memory allocation failed");
-            return;
-        }
+    if (!dataspace_allot(&ctx->data_space, 1)) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "C, data space full");
+        return;
     }
-    *(char*)ctx->here_ptr = (char)char_cell.value.i;
-    ctx->here_ptr += 1;
+    ctx->data_space.base[ctx->data_space.here - 1] = (unsigned char)char_cell.value.i;
 }
 
 static void builtin_bl(rforth_ctx_t *ctx) {
@@ -1762,7 +1414,7 @@ static void builtin_spaces(rforth_ctx_t *ctx) {
     }
     
     cell_t n_cell;
-    if (!stack_pop(ctx->data_stack, &n_cell) || n_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &n_cell) || CELL_TYPE(n_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "SPACES requires integer count");
         return;
     }
@@ -1795,7 +1447,7 @@ static void builtin_invert(rforth_ctx_t *ctx) {
     }
     
     cell_t value;
-    if (!stack_pop(ctx->data_stack, &value) || value.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &value) || CELL_TYPE(value) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "INVERT requires integer");
         return;
     }
@@ -1816,7 +1468,7 @@ static void builtin_xor(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "XOR requires integers");
         return;
     }
@@ -1832,7 +1484,7 @@ static void builtin_u_dot(rforth_ctx_t *ctx) {
     }
     
     cell_t value;
-    if (!stack_pop(ctx->data_stack, &value) || value.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &value) || CELL_TYPE(value) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "U. requires integer");
         return;
     }
@@ -1853,7 +1505,7 @@ static void builtin_u_less(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "U< requires integers");
         return;
     }
@@ -1877,13 +1529,13 @@ static void builtin_two_over(rforth_ctx_t *ctx) {
     cell_t second = stack_data[top - 2];
     
     /* Push copies */
-    if (third.type == CELL_INT) {
+    if (CELL_TYPE(third) == CELL_INT) {
         stack_push_int(ctx->data_stack, third.value.i);
     } else {
         stack_push_float(ctx->data_stack, third.value.f);
     }
     
-    if (second.type == CELL_INT) {
+    if (CELL_TYPE(second) == CELL_INT) {
         stack_push_int(ctx->data_stack, second.value.i);
     } else {
         stack_push_float(ctx->data_stack, second.value.f);
@@ -1952,7 +1604,7 @@ static void builtin_hash(rforth_ctx_t *ctx) {
             return;
         }
         
-        if (high.type == CELL_INT && low.type == CELL_INT) {
+        if (CELL_TYPE(high) == CELL_INT && CELL_TYPE(low) == CELL_INT) {
             /* Valid double number */
             ud = ((uint64_t)high.value.i << 32) | (uint32_t)low.value.i;
         } else {
@@ -1967,7 +1619,7 @@ static void builtin_hash(rforth_ctx_t *ctx) {
             return;
         }
         
-        if (single.type != CELL_INT) {
+        if (CELL_TYPE(single) != CELL_INT) {
             RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "# requires integer operand");
             return;
         }
@@ -2043,7 +1695,7 @@ static void builtin_hold(rforth_ctx_t *ctx) {
     }
     
     cell_t char_cell;
-    if (!stack_pop(ctx->data_stack, &char_cell) || char_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &char_cell) || CELL_TYPE(char_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "HOLD requires integer character");
         return;
     }
@@ -2064,7 +1716,7 @@ static void builtin_sign(rforth_ctx_t *ctx) {
     }
     
     cell_t n_cell;
-    if (!stack_pop(ctx->data_stack, &n_cell) || n_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &n_cell) || CELL_TYPE(n_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "SIGN requires integer");
         return;
     }
@@ -2087,7 +1739,7 @@ static void builtin_s_to_d(rforth_ctx_t *ctx) {
     }
     
     cell_t n_cell;
-    if (!stack_pop(ctx->data_stack, &n_cell) || n_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &n_cell) || CELL_TYPE(n_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "S>D requires integer");
         return;
     }
@@ -2108,27 +1760,22 @@ static void builtin_two_fetch(rforth_ctx_t *ctx) {
     }
     
     cell_t addr_cell;
-    if (!stack_pop(ctx->data_stack, &addr_cell) || addr_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &addr_cell) || CELL_TYPE(addr_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "2@ requires integer address");
         return;
     }
     
-    /* Safety check for valid address */
-    if (addr_cell.value.i < 1000) {
-        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_ADDRESS, "2@ invalid address");
-        return;
-    }
-    
-    cell_t *addr = (cell_t*)addr_cell.value.i;
+    cell_t *addr = data_cells(ctx, &addr_cell, 2, "2@ invalid address");
+    if (!addr) return;
     
     /* Push the two cells onto stack */
-    if (addr[0].type == CELL_INT) {
+    if (CELL_TYPE(addr[0]) == CELL_INT) {
         stack_push_int(ctx->data_stack, addr[0].value.i);
     } else {
         stack_push_float(ctx->data_stack, addr[0].value.f);
     }
     
-    if (addr[1].type == CELL_INT) {
+    if (CELL_TYPE(addr[1]) == CELL_INT) {
         stack_push_int(ctx->data_stack, addr[1].value.i);
     } else {
         stack_push_float(ctx->data_stack, addr[1].value.f);
@@ -2148,38 +1795,21 @@ static void builtin_two_store(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (addr_cell.type != CELL_INT) {
+    if (CELL_TYPE(addr_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "2! requires integer address");
         return;
     }
     
-    /* Safety check for valid address */
-    if (addr_cell.value.i < 1000) {
-        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_ADDRESS, "2! invalid address");
-        return;
-    }
-    
-    cell_t *addr = (cell_t*)addr_cell.value.i;
+    cell_t *addr = data_cells(ctx, &addr_cell, 2, "2! invalid address");
+    if (!addr) return;
     addr[0] = x1;
     addr[1] = x2;
 }
 
 static void builtin_align(rforth_ctx_t *ctx) {
-    /* ALIGN - Align dictionary pointer ( -- ) */
-    if (!ctx->here_ptr) {
-        ctx->here_ptr = malloc(65536);
-        if (!ctx->here_ptr) {
-            set_error_simple(ctx, RFORTH_ERROR_MEMORY, "ALIGN memory allocation failed");
-            return;
-        }
-    }
-    
-    /* Align to cell boundary (8 bytes on 64-bit systems) */
-    uintptr_t addr = (uintptr_t)ctx->here_ptr;
-    size_t cell_size = sizeof(cell_t);
-    size_t remainder = addr % cell_size;
-    if (remainder != 0) {
-        ctx->here_ptr += (cell_size - remainder);
+    /* ALIGN - Align HERE to a cell boundary ( -- ) */
+    if (!dataspace_align(&ctx->data_space, sizeof(cell_t))) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "ALIGN: data space full");
     }
 }
 
@@ -2191,7 +1821,7 @@ static void builtin_aligned(rforth_ctx_t *ctx) {
     }
     
     cell_t addr_cell;
-    if (!stack_pop(ctx->data_stack, &addr_cell) || addr_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &addr_cell) || CELL_TYPE(addr_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "ALIGNED requires integer address");
         return;
     }
@@ -2215,7 +1845,7 @@ static void builtin_cell_plus(rforth_ctx_t *ctx) {
     }
     
     cell_t addr_cell;
-    if (!stack_pop(ctx->data_stack, &addr_cell) || addr_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &addr_cell) || CELL_TYPE(addr_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "CELL+ requires integer address");
         return;
     }
@@ -2231,7 +1861,7 @@ static void builtin_cells(rforth_ctx_t *ctx) {
     }
     
     cell_t count_cell;
-    if (!stack_pop(ctx->data_stack, &count_cell) || count_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &count_cell) || CELL_TYPE(count_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "CELLS requires integer count");
         return;
     }
@@ -2252,19 +1882,15 @@ static void builtin_fill(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (addr_cell.type != CELL_INT || count_cell.type != CELL_INT || char_cell.type != CELL_INT) {
+    if (CELL_TYPE(addr_cell) != CELL_INT || CELL_TYPE(count_cell) != CELL_INT || CELL_TYPE(char_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "FILL requires integer operands");
         return;
     }
     
-    /* Safety check for valid address and count */
-    if (addr_cell.value.i < 1000 || count_cell.value.i < 0) {
-        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_ADDRESS, "FILL invalid address or count");
-        return;
-    }
+    unsigned char *dest = data_bytes(ctx, addr_cell.value.i, count_cell.value.i, "FILL invalid address or count");
+    if (!dest) return;
     
-    /* Fill memory */
-    memset((void*)addr_cell.value.i, (int)char_cell.value.i, (size_t)count_cell.value.i);
+    memset(dest, (int)char_cell.value.i, (size_t)count_cell.value.i);
 }
 
 static void builtin_move(rforth_ctx_t *ctx) {
@@ -2280,19 +1906,18 @@ static void builtin_move(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (src_cell.type != CELL_INT || dest_cell.type != CELL_INT || count_cell.type != CELL_INT) {
+    if (CELL_TYPE(src_cell) != CELL_INT || CELL_TYPE(dest_cell) != CELL_INT || CELL_TYPE(count_cell) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "MOVE requires integer operands");
         return;
     }
     
-    /* Safety check for valid addresses and count */
-    if (src_cell.value.i < 1000 || dest_cell.value.i < 1000 || count_cell.value.i < 0) {
-        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_ADDRESS, "MOVE invalid addresses or count");
-        return;
-    }
+    const char *message = "MOVE invalid addresses or count";
+    unsigned char *src = data_bytes(ctx, src_cell.value.i, count_cell.value.i, message);
+    unsigned char *dest = src ? data_bytes(ctx, dest_cell.value.i, count_cell.value.i, message) : NULL;
+    if (!dest) return;
     
-    /* Move memory (handles overlapping regions correctly) */
-    memmove((void*)dest_cell.value.i, (void*)src_cell.value.i, (size_t)count_cell.value.i);
+    /* memmove handles overlapping regions */
+    memmove(dest, src, (size_t)count_cell.value.i);
 }
 
 /* Phase 4: Compilation Words */
@@ -2305,35 +1930,10 @@ static void builtin_exit(rforth_ctx_t *ctx) {
 }
 
 static void builtin_literal(rforth_ctx_t *ctx) {
-    /* LITERAL - Compile runtime behavior to push a literal ( x -- ) */
-    if (ctx->data_stack->size < 1) {
+    /* LITERAL - Compile x as a literal ( x -- ) */
+    /* Inside a definition the compiler handles it; interpreted, x stays where it is */
+    if (stack_is_empty(ctx->data_stack)) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "LITERAL requires value on stack");
-        return;
-    }
-    
-    cell_t value;
-    if (!stack_pop(ctx->data_stack, &value)) {
-        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "LITERAL requires value on stack");
-        return;
-    }
-    
-    /* In compile mode, this would compile code to push the literal */
-    /* For now, simplified implementation */
-    if (ctx->compiling) {
-        printf("LITERAL - Compiling literal ");
-        if (value.type == CELL_INT) {
-            printf("%" PRId64_PORTABLE, value.value.i);
-        } else {
-            printf("%g", value.value.f);
-        }
-        printf("\n");
-    } else {
-        /* In interpret mode, just push it back */
-        if (value.type == CELL_INT) {
-            stack_push_int(ctx->data_stack, value.value.i);
-        } else {
-            stack_push_float(ctx->data_stack, value.value.f);
-        }
     }
 }
 
@@ -2356,16 +1956,16 @@ static void builtin_recurse(rforth_ctx_t *ctx) {
 
 static void builtin_left_bracket(rforth_ctx_t *ctx) {
     /* [ - Enter interpretation state ( -- ) */
+    /* Inside a definition the interpreter loop handles it */
     ctx->state_var = 0;      /* Set STATE to interpretation mode */
     ctx->compiling = false;  /* Exit compile mode */
-    printf("[ - Entering interpretation mode\n");
 }
 
 static void builtin_right_bracket(rforth_ctx_t *ctx) {
     /* ] - Enter compilation state ( -- ) */
+    /* Only meaningful after [ inside a definition, which the interpreter loop handles */
     ctx->state_var = -1;     /* Set STATE to compilation mode */
     ctx->compiling = true;   /* Enter compile mode */
-    printf("] - Entering compilation mode\n");
 }
 
 /* Phase 5: Final ANSI Words Implementation */
@@ -2384,7 +1984,7 @@ static void builtin_lshift(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (value.type != CELL_INT || shift.type != CELL_INT) {
+    if (CELL_TYPE(value) != CELL_INT || CELL_TYPE(shift) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "LSHIFT requires integers");
         return;
     }
@@ -2405,7 +2005,7 @@ static void builtin_rshift(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (value.type != CELL_INT || shift.type != CELL_INT) {
+    if (CELL_TYPE(value) != CELL_INT || CELL_TYPE(shift) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "RSHIFT requires integers");
         return;
     }
@@ -2426,7 +2026,7 @@ static void builtin_m_star(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "M* requires integers");
         return;
     }
@@ -2450,7 +2050,7 @@ static void builtin_um_star(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "UM* requires integers");
         return;
     }
@@ -2474,7 +2074,7 @@ static void builtin_um_slash_mod(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (divisor.type != CELL_INT || high.type != CELL_INT || low.type != CELL_INT) {
+    if (CELL_TYPE(divisor) != CELL_INT || CELL_TYPE(high) != CELL_INT || CELL_TYPE(low) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_TYPE_MISMATCH, "UM/MOD requires integers");
         return;
     }
@@ -2687,42 +2287,25 @@ static void builtin_bracket_char(rforth_ctx_t *ctx) {
 }
 
 static void builtin_constant(rforth_ctx_t *ctx) {
-    /* CONSTANT - Create a named constant (stack-based for now) */
-    cell_t value, name_cell;
-    if (!stack_pop(ctx->data_stack, &name_cell) || !stack_pop(ctx->data_stack, &value)) {
-        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "CONSTANT requires value and name on stack");
+    /* CONSTANT - Create a named constant ( x "<spaces>name" -- ) */
+    cell_t value;
+    if (!stack_pop(ctx->data_stack, &value)) {
+        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "CONSTANT requires value on stack");
         return;
     }
     
-    /* Create constant (like variable but initialized) */
-    char const_name[64];
-    snprintf(const_name, sizeof(const_name), "const_%" PRId64_PORTABLE, name_cell.value.i);
-    
-    /* Check if constant already exists */
-    variable_entry_t *existing = find_variable(ctx, const_name);
-    if (existing) {
-        /* Update existing constant value */
-        existing->value = value;
-        uintptr_t addr = (uintptr_t)existing;
-        stack_push_int(ctx->data_stack, (int64_t)addr);
+    token_t name_token = parser_next_token(ctx->parser);
+    if (name_token.type != TOKEN_WORD) {
+        set_error_simple(ctx, RFORTH_ERROR_PARSE_ERROR, "CONSTANT requires a name");
         return;
     }
     
-    variable_entry_t *var = malloc(sizeof(variable_entry_t));
-    if (!var) {
-        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "Failed to allocate constant");
+    char name[MAX_WORD_LENGTH];
+    parser_token_text(&name_token, name, sizeof(name));
+    if (!dict_add_constant(ctx->dict, name, value)) {
+        set_error_simple(ctx, RFORTH_ERROR_MEMORY, "Failed to create constant");
         return;
     }
-    
-    strncpy(var->name, const_name, sizeof(var->name) - 1);
-    var->name[sizeof(var->name) - 1] = '\0';
-    var->value = value;
-    var->next = ctx->variables;
-    ctx->variables = var;
-    
-    /* Push constant address onto stack for access */
-    uintptr_t addr = (uintptr_t)var;
-    stack_push_int(ctx->data_stack, (int64_t)addr);
 }
 
 /* Table of builtin words */
@@ -2769,16 +2352,66 @@ static const builtin_word_t builtin_words[] = {
     {"or", builtin_or},
     {"not", builtin_not},
     
-    /* Floating point */
-    {"f.", builtin_f_dot},
+    /* Floating point (data stack cells) */
     {">float", builtin_int_to_float},
     {">int", builtin_float_to_int},
     {"sqrt", builtin_sqrt},
     {"abs", builtin_abs},
     
+    /* Floating point (ANS, float stack) */
+    {"fdrop", builtin_fdrop},
+    {"fdup", builtin_fdup},
+    {"fswap", builtin_fswap},
+    {"fover", builtin_fover},
+    {"frot", builtin_frot},
+    {"fdepth", builtin_fdepth},
+    {"f+", builtin_f_plus},
+    {"f-", builtin_f_minus},
+    {"f*", builtin_f_star},
+    {"f/", builtin_f_slash},
+    {"f**", builtin_f_star_star},
+    {"fnegate", builtin_fnegate},
+    {"fabs", builtin_fabs},
+    {"fmax", builtin_fmax},
+    {"fmin", builtin_fmin},
+    {"fsqrt", builtin_fsqrt},
+    {"floor", builtin_floor},
+    {"fround", builtin_fround},
+    {"ftrunc", builtin_ftrunc},
+    {"fexp", builtin_fexp},
+    {"fln", builtin_fln},
+    {"flog", builtin_flog},
+    {"fsin", builtin_fsin},
+    {"fcos", builtin_fcos},
+    {"ftan", builtin_ftan},
+    {"fatan", builtin_fatan},
+    {"fatan2", builtin_fatan2},
+    {"f0=", builtin_f_zero_equal},
+    {"f0<", builtin_f_zero_less},
+    {"f=", builtin_f_equal},
+    {"f<", builtin_f_less},
+    {"f>", builtin_f_greater},
+    {"f~", builtin_f_proximate},
+    {"s>f", builtin_s_to_f},
+    {"f>s", builtin_f_to_s},
+    {"d>f", builtin_d_to_f},
+    {"f>d", builtin_f_to_d},
+    {"f@", builtin_f_fetch},
+    {"f!", builtin_f_store},
+    {"floats", builtin_floats},
+    {"float+", builtin_float_plus},
+    {"falign", builtin_falign},
+    {"faligned", builtin_faligned},
+    {"fvariable", builtin_fvariable},
+    {"fconstant", builtin_fconstant},
+    {"f.", builtin_f_dot},
+    {"fe.", builtin_f_e_dot},
+    {"fs.", builtin_f_s_dot},
+    
     /* System */
     {".s", builtin_dot_s},
     {"words", builtin_words_cmd},
+    {"forget", builtin_forget},
     {"bye", builtin_bye},
     {"turnkey", builtin_turnkey},
     {"execute", builtin_execute},
@@ -2955,6 +2588,11 @@ static const builtin_word_t builtin_words[] = {
     {"micros", builtin_micros},
     {"millis", builtin_millis},
     
+    /* Diagnostics */
+    {"dispatch-cost", builtin_dispatch_cost},
+    {".superinstructions", builtin_superinstructions},
+    {".eval-cache", builtin_eval_cache},
+    
     /* End marker */
     {NULL, NULL}
 };
@@ -2981,7 +2619,7 @@ static void builtin_add(rforth_ctx_t *ctx) {
     }
     
     /* If either operand is float, do floating point arithmetic */
-    if (a.type == CELL_FLOAT || b.type == CELL_FLOAT) {
+    if (CELL_TYPE(a) == CELL_FLOAT || CELL_TYPE(b) == CELL_FLOAT) {
         double result = cell_to_float(&a) + cell_to_float(&b);
         stack_push_float(ctx->data_stack, result);
     } else {
@@ -2998,7 +2636,7 @@ static void builtin_sub(rforth_ctx_t *ctx) {
     }
     
     /* If either operand is float, do floating point arithmetic */
-    if (a.type == CELL_FLOAT || b.type == CELL_FLOAT) {
+    if (CELL_TYPE(a) == CELL_FLOAT || CELL_TYPE(b) == CELL_FLOAT) {
         double result = cell_to_float(&a) - cell_to_float(&b);
         stack_push_float(ctx->data_stack, result);
     } else {
@@ -3015,7 +2653,7 @@ static void builtin_mul(rforth_ctx_t *ctx) {
     }
     
     /* If either operand is float, do floating point arithmetic */
-    if (a.type == CELL_FLOAT || b.type == CELL_FLOAT) {
+    if (CELL_TYPE(a) == CELL_FLOAT || CELL_TYPE(b) == CELL_FLOAT) {
         double result = cell_to_float(&a) * cell_to_float(&b);
         stack_push_float(ctx->data_stack, result);
     } else {
@@ -3032,14 +2670,14 @@ static void builtin_div(rforth_ctx_t *ctx) {
     }
     
     /* Check for division by zero */
-    if ((b.type == CELL_INT && b.value.i == 0) || 
-        (b.type == CELL_FLOAT && b.value.f == 0.0)) {
+    if ((CELL_TYPE(b) == CELL_INT && b.value.i == 0) || 
+        (CELL_TYPE(b) == CELL_FLOAT && b.value.f == 0.0)) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_DIVISION_BY_ZERO, "Division by zero");
         return;
     }
     
     /* If either operand is float, do floating point arithmetic */
-    if (a.type == CELL_FLOAT || b.type == CELL_FLOAT) {
+    if (CELL_TYPE(a) == CELL_FLOAT || CELL_TYPE(b) == CELL_FLOAT) {
         double result = cell_to_float(&a) / cell_to_float(&b);
         stack_push_float(ctx->data_stack, result);
     } else {
@@ -3056,7 +2694,7 @@ static void builtin_mod(rforth_ctx_t *ctx) {
     }
     
     /* Mod only works with integers */
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_OPERATION, "Mod requires integer operands");
         return;
     }
@@ -3077,7 +2715,7 @@ static void builtin_negate(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (a.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT) {
         stack_push_int(ctx->data_stack, -a.value.i);
     } else {
         stack_push_float(ctx->data_stack, -a.value.f);
@@ -3121,7 +2759,7 @@ static void builtin_dot(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (value.type == CELL_INT) {
+    if (CELL_TYPE(value) == CELL_INT) {
         printf("%ld ", (long)value.value.i);
     } else {
         printf("%.6g ", value.value.f);
@@ -3136,7 +2774,7 @@ static void builtin_emit(rforth_ctx_t *ctx) {
     }
     
     int ch;
-    if (value.type == CELL_INT) {
+    if (CELL_TYPE(value) == CELL_INT) {
         ch = (int)value.value.i;
     } else {
         ch = (int)value.value.f;
@@ -3167,6 +2805,28 @@ static void builtin_words_cmd(rforth_ctx_t *ctx) {
     dict_print(ctx->dict);
 }
 
+static void builtin_forget(rforth_ctx_t *ctx) {
+    /* FORGET - Remove a word and all words defined after it ( "<spaces>name" -- ) */
+    token_t name_token = parser_next_token(ctx->parser);
+    if (name_token.type != TOKEN_WORD) {
+        set_error_simple(ctx, RFORTH_ERROR_PARSE_ERROR, "FORGET requires a name");
+        return;
+    }
+    
+    word_t *word = dict_find_symbol(ctx->dict, name_token.symbol);
+    if (!word) {
+        set_error_simple(ctx, RFORTH_ERROR_WORD_NOT_FOUND, "FORGET: word not found");
+        return;
+    }
+    
+    if (word->type == WORD_BUILTIN || word->type == WORD_IMMEDIATE) {
+        set_error_simple(ctx, RFORTH_ERROR_INVALID_OPERATION, "FORGET cannot remove builtin words");
+        return;
+    }
+    
+    dict_forget(ctx->dict, word);
+}
+
 static void builtin_bye(rforth_ctx_t *ctx) {
     ctx->running = false;
 }
@@ -3179,7 +2839,7 @@ static void builtin_equal(rforth_ctx_t *ctx) {
     }
     
     bool result;
-    if (a.type == CELL_INT && b.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_INT) {
         result = (a.value.i == b.value.i);
     } else {
         result = (cell_to_float(&a) == cell_to_float(&b));
@@ -3196,7 +2856,7 @@ static void builtin_less(rforth_ctx_t *ctx) {
     }
     
     bool result;
-    if (a.type == CELL_INT && b.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_INT) {
         result = (a.value.i < b.value.i);
     } else {
         result = (cell_to_float(&a) < cell_to_float(&b));
@@ -3213,7 +2873,7 @@ static void builtin_greater(rforth_ctx_t *ctx) {
     }
     
     bool result;
-    if (a.type == CELL_INT && b.type == CELL_INT) {
+    if (CELL_TYPE(a) == CELL_INT && CELL_TYPE(b) == CELL_INT) {
         result = (a.value.i > b.value.i);
     } else {
         result = (cell_to_float(&a) > cell_to_float(&b));
@@ -3230,7 +2890,7 @@ static void builtin_and(rforth_ctx_t *ctx) {
     }
     
     /* Bitwise operations only work with integers */
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_OPERATION, "Bitwise operations require integer operands");
         return;
     }
@@ -3246,7 +2906,7 @@ static void builtin_or(rforth_ctx_t *ctx) {
     }
     
     /* Bitwise operations only work with integers */
-    if (a.type != CELL_INT || b.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT || CELL_TYPE(b) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_OPERATION, "Bitwise operations require integer operands");
         return;
     }
@@ -3262,7 +2922,7 @@ static void builtin_not(rforth_ctx_t *ctx) {
     }
     
     /* Bitwise operations only work with integers */
-    if (a.type != CELL_INT) {
+    if (CELL_TYPE(a) != CELL_INT) {
         RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_OPERATION, "Bitwise operations require integer operands");
         return;
     }
@@ -3272,17 +2932,6 @@ static void builtin_not(rforth_ctx_t *ctx) {
 
 /* Floating point specific words */
 
-static void builtin_f_dot(rforth_ctx_t *ctx) {
-    cell_t value;
-    if (!stack_pop(ctx->data_stack, &value)) {
-        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Stack underflow");
-        return;
-    }
-    
-    /* Always print as floating point */
-    printf("%.6g ", cell_to_float(&value));
-}
-
 static void builtin_int_to_float(rforth_ctx_t *ctx) {
     cell_t value;
     if (!stack_pop(ctx->data_stack, &value)) {
@@ -3290,7 +2939,7 @@ static void builtin_int_to_float(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (value.type == CELL_INT) {
+    if (CELL_TYPE(value) == CELL_INT) {
         stack_push_float(ctx->data_stack, (double)value.value.i);
     } else {
         stack_push_cell(ctx->data_stack, value);  /* Already float */
@@ -3304,11 +2953,16 @@ static void builtin_float_to_int(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (value.type == CELL_FLOAT) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    /* Nothing marks an untagged float, so take the cell as float bits */
+    stack_push_int(ctx->data_stack, (int64_t)value.value.f);
+#else
+    if (CELL_TYPE(value) == CELL_FLOAT) {
         stack_push_int(ctx->data_stack, (int64_t)value.value.f);
     } else {
         stack_push_cell(ctx->data_stack, value);  /* Already int */
     }
+#endif
 }
 
 static void builtin_sqrt(rforth_ctx_t *ctx) {
@@ -3334,10 +2988,48 @@ static void builtin_abs(rforth_ctx_t *ctx) {
         return;
     }
     
-    if (value.type == CELL_INT) {
+    if (CELL_TYPE(value) == CELL_INT) {
         int64_t abs_val = value.value.i < 0 ? -value.value.i : value.value.i;
         stack_push_int(ctx->data_stack, abs_val);
     } else {
         stack_push_float(ctx->data_stack, fabs(value.value.f));
     }
-}
\ No newline at end of file
+}
+
+/* Diagnostics */
+static void builtin_dispatch_cost(rforth_ctx_t *ctx) {
+    /* DISPATCH-COST ( n -- ) - Time n iterations of common primitives */
+    int64_t iterations;
+    if (!stack_pop_int(ctx->data_stack, &iterations)) {
+        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "DISPATCH-COST requires iteration count on stack");
+        return;
+    }
+    
+    if (iterations <= 0) {
+        set_error_simple(ctx, RFORTH_ERROR_INVALID_OPERATION, "DISPATCH-COST requires a positive count");
+        return;
+    }
+    
+    vm_report_dispatch_cost(ctx, iterations);
+}
+
+static void builtin_superinstructions(rforth_ctx_t *ctx) {
+    /* .SUPERINSTRUCTIONS ( n -- ) - Print the n most frequent fusable sequences */
+    int64_t count;
+    if (!stack_pop_int(ctx->data_stack, &count)) {
+        set_error_simple(ctx, RFORTH_ERROR_STACK_UNDERFLOW, ".SUPERINSTRUCTIONS requires a count on stack");
+        return;
+    }
+    
+    if (count <= 0) {
+        set_error_simple(ctx, RFORTH_ERROR_INVALID_OPERATION, ".SUPERINSTRUCTIONS requires a positive count");
+        return;
+    }
+    
+    vm_report_superinstructions((int)count);
+}
+
+static void builtin_eval_cache(rforth_ctx_t *ctx) {
+    /* .EVAL-CACHE ( -- ) - Print hit and miss counts of the compiled-string cache */
+    eval_cache_report(ctx->eval_cache);
+}
@@ -2,11 +2,14 @@
 #include "rforth.h"
 #include "config.h"
 #include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
 #ifndef _WIN32
     #include <sys/wait.h>
     #include <unistd.h>
 #else
     #include <process.h>  /* For _spawnvp on Windows */
+    #include <windows.h>  /* For GetModuleFileNameA */
 #endif
 
 /* Compiler context implementation */
@@ -14,12 +17,32 @@ struct compiler_ctx {
     FILE *output;               /* Output C file */
     char *output_filename;      /* Output C filename */
     char *executable_name;      /* Final executable name */
-    int word_count;            /* Generated word counter */
+    int word_count;            /* Words collected from the program */
     bool in_main;              /* Whether we're in main function */
     int control_depth;         /* Nesting depth for control structures */
     int label_counter;         /* Counter for generating unique labels */
     int if_stack[64];          /* Stack to track nested if statements */
     int if_depth;              /* Current if nesting depth */
+    int if_values[64];         /* Cells on the stack at each IF, for its ELSE */
+    int loop_stack[64];        /* Labels of the enclosing BEGIN and DO loops */
+    bool loop_counted[64];     /* Whether each enclosing loop is a DO loop */
+    bool loop_left[64];        /* Whether a LEAVE needs the loop's exit label */
+    int loop_depth;            /* Current loop nesting depth */
+    int loop_values[64];       /* Cells on the stack when each loop is left */
+    char values[MAX_PENDING_VALUES][MAX_VALUE_LENGTH]; /* Cells not yet on the real stack, deepest first */
+    int value_depth;           /* Number of pending cells */
+    char fvalues[MAX_PENDING_VALUES][MAX_VALUE_LENGTH]; /* Floats not yet on the real float stack */
+    int fvalue_depth;          /* Number of pending floats */
+    int temp_counter;          /* Counter for naming C locals */
+    bool unreachable;          /* Code since an EXIT or LEAVE cannot run */
+    bool failed;               /* A construct could not be compiled; reported already */
+    compiled_word_t *words;    /* Definitions of the program, in source order */
+    int word_capacity;         /* Allocated entries in words */
+    int current_word;          /* Index of the word being generated, -1 in main */
+    compiled_data_t *data;     /* Defining words of the program, in source order */
+    int data_count;            /* Entries in data */
+    int data_capacity;         /* Allocated entries in data */
+    int next_data;             /* Entries main has reached */
 };
 
 /* Helper function to convert Forth word name to C identifier */
@@ -39,142 +62,889 @@ static void word_name_to_c_identifier(const char *forth_name, char *c_name, size
     c_name[j] = '\0';
 }
 
-/* Helper function to generate word call code */
-static void generate_word_call(compiler_ctx_t *compiler, const char *word_name) {
-    FILE *output = compiler->output;
+/* Words are matched without regard to case, as in the C identifiers */
+static void lower_case_name(const char *forth_name, char *name, size_t size) {
+    size_t length = 0;
+    while (forth_name[length] && length < size - 1) {
+        name[length] = (char)tolower((unsigned char)forth_name[length]);
+        length++;
+    }
+    name[length] = '\0';
+}
+
+/* Lower-case text of a word token */
+static void token_word_name(const token_t *token, char *name, size_t size) {
+    char text[MAX_WORD_LENGTH];
+    parser_token_text(token, text, sizeof(text));
+    lower_case_name(text, name, size);
+}
+
+/* Text of a ." string, after the ." token; the parser continues past its closing quote */
+static bool parse_dot_quote(parser_t *parser, const char **text, size_t *length) {
+    const char *start = parser->current;
+    while (*start && isspace((unsigned char)*start)) start++;
     
-    /* Arithmetic Operations */
-    if (strcmp(word_name, "+") == 0) {
-        fprintf(output, "    forth_add();\n");
-    } else if (strcmp(word_name, "-") == 0) {
-        fprintf(output, "    forth_sub();\n");
-    } else if (strcmp(word_name, "*") == 0) {
-        fprintf(output, "    forth_mul();\n");
-    } else if (strcmp(word_name, "/") == 0) {
-        fprintf(output, "    forth_div();\n");
-    } else if (strcmp(word_name, "mod") == 0) {
-        fprintf(output, "    forth_mod();\n");
-    } else if (strcmp(word_name, "abs") == 0) {
-        fprintf(output, "    forth_abs();\n");
-    } else if (strcmp(word_name, "negate") == 0) {
-        fprintf(output, "    forth_negate();\n");
-    } else if (strcmp(word_name, "1+") == 0) {
-        fprintf(output, "    push(pop() + 1);\n");
-    } else if (strcmp(word_name, "1-") == 0) {
-        fprintf(output, "    push(pop() - 1);\n");
-    } else if (strcmp(word_name, "2*") == 0) {
-        fprintf(output, "    push(pop() * 2);\n");
-    } else if (strcmp(word_name, "2/") == 0) {
-        fprintf(output, "    push(pop() / 2);\n");
-        
-    /* Stack Operations */
-    } else if (strcmp(word_name, "dup") == 0) {
-        fprintf(output, "    forth_dup();\n");
-    } else if (strcmp(word_name, "drop") == 0) {
-        fprintf(output, "    forth_drop();\n");
-    } else if (strcmp(word_name, "swap") == 0) {
-        fprintf(output, "    forth_swap();\n");
-    } else if (strcmp(word_name, "over") == 0) {
-        fprintf(output, "    forth_over();\n");
-    } else if (strcmp(word_name, "rot") == 0) {
-        fprintf(output, "    forth_rot();\n");
-    } else if (strcmp(word_name, "2dup") == 0) {
-        fprintf(output, "    forth_2dup();\n");
-    } else if (strcmp(word_name, "2drop") == 0) {
-        fprintf(output, "    forth_2drop();\n");
+    const char *end = strchr(start, '"');
+    if (!end) return false;
+    
+    *text = start;
+    *length = (size_t)(end - start);
+    parser->current = end + 1;
+    return true;
+}
+
+/* Which defining word this is, or -1 for any other word */
+static int defining_word_kind(const char *word_name) {
+    if (strcmp(word_name, "variable") == 0 || strcmp(word_name, "create") == 0) return DATA_CELLS;
+    if (strcmp(word_name, "fvariable") == 0) return DATA_FLOATS;
+    if (strcmp(word_name, "constant") == 0) return DATA_CONSTANT;
+    if (strcmp(word_name, "fconstant") == 0) return DATA_FCONSTANT;
+    return -1;
+}
+
+/*
+ * Run the ALLOT, CELLS and , that lay out a data region after its CREATE
+ * or VARIABLE, adding to data when given. Only literal sizes and values
+ * can be laid out when compiling, so the region ends before the first
+ * other token, at the last point where nothing was left on the stack.
+ */
+static bool scan_data_region(parser_t *parser, compiled_data_t *data) {
+    int64_t stack[16];
+    int depth = 0;
+    parser_t end = *parser;
+    
+    token_t token;
+    while ((token = parser_next_token(parser)).type == TOKEN_NUMBER || token.type == TOKEN_WORD) {
+        char word_name[MAX_WORD_LENGTH] = "";
+        if (token.type == TOKEN_WORD) {
+            token_word_name(&token, word_name, sizeof(word_name));
+        }
         
+        if (token.type == TOKEN_NUMBER) {
+            if (depth == 16) break;
+            stack[depth++] = token.value.number;
+        } else if (depth > 0 && (strcmp(word_name, "cells") == 0 || strcmp(word_name, "floats") == 0)) {
+            stack[depth - 1] *= (int64_t)sizeof(int64_t);
+        } else if (depth > 0 && strcmp(word_name, "allot") == 0 && stack[depth - 1] >= 0) {
+            int64_t bytes = stack[--depth];
+            if (data) data->size += (bytes + (int64_t)sizeof(int64_t) - 1) / (int64_t)sizeof(int64_t);
+        } else if (depth > 0 && strcmp(word_name, ",") == 0) {
+            int64_t value = stack[--depth];
+            if (data) {
+                int64_t *cells = realloc(data->cells, sizeof(int64_t) * (data->size + 1));
+                if (!cells) return false;
+                memset(cells + data->cell_count, 0, sizeof(int64_t) * (data->size - data->cell_count));
+                cells[data->size++] = value;
+                data->cells = cells;
+                data->cell_count = data->size;
+            }
+        } else {
+            break;
+        }
+        if (depth == 0) end = *parser;
+    }
+    
+    *parser = end;
+    return true;
+}
+
+/*
+ * Stack words that only rearrange cells: each output character names an
+ * input, 0 the deepest. The float ones rearrange the float stack.
+ */
+typedef struct {
+    const char *name;
+    int inputs;
+    const char *outputs;
+    bool floats;
+} shuffle_t;
+
+static const shuffle_t shuffles[] = {
+    {"dup", 1, "00", false},
+    {"drop", 1, "", false},
+    {"swap", 2, "10", false},
+    {"over", 2, "010", false},
+    {"rot", 3, "120", false},
+    {"2dup", 2, "0101", false},
+    {"2drop", 2, "", false},
+    {"2swap", 4, "2301", false},
+    {"2over", 4, "012301", false},
+    {"chars", 1, "0", false},
+    {"fdup", 1, "00", true},
+    {"fdrop", 1, "", true},
+    {"fswap", 2, "10", true},
+    {"fover", 2, "010", true},
+    {"frot", 3, "120", true},
+};
+
+/*
+ * Primitives as C code over their operands, deepest first: $0, $1, ...
+ * from the data stack and #0, #1, ... from the float stack. With an
+ * output the code is an expression for it, otherwise a statement.
+ */
+typedef struct {
+    const char *name;
+    int inputs;                 /* Cells taken from the data stack */
+    int outputs;                /* Cells left on it, 0 or 1 */
+    int float_inputs;           /* Floats taken from the float stack */
+    int float_outputs;          /* Floats left on it, 0 or 1 */
+    const char *code;
+} primitive_t;
+
+static const primitive_t primitives[] = {
+    /* Arithmetic Operations */
+    {"+", 2, 1, 0, 0, "$0 + $1"},
+    {"-", 2, 1, 0, 0, "$0 - $1"},
+    {"*", 2, 1, 0, 0, "$0 * $1"},
+    {"/", 2, 1, 0, 0, "$1 ? $0 / $1 : 0"},
+    {"mod", 2, 1, 0, 0, "$1 ? $0 % $1 : 0"},
+    {"abs", 1, 1, 0, 0, "$0 < 0 ? -$0 : $0"},
+    {"negate", 1, 1, 0, 0, "-$0"},
+    {"1+", 1, 1, 0, 0, "$0 + 1"},
+    {"1-", 1, 1, 0, 0, "$0 - 1"},
+    {"2*", 1, 1, 0, 0, "$0 * 2"},
+    {"2/", 1, 1, 0, 0, "$0 / 2"},
+    {"min", 2, 1, 0, 0, "$0 < $1 ? $0 : $1"},
+    {"max", 2, 1, 0, 0, "$0 > $1 ? $0 : $1"},
+
     /* Return Stack Operations */
-    } else if (strcmp(word_name, ">r") == 0) {
-        fprintf(output, "    forth_to_r();\n");
-    } else if (strcmp(word_name, "r>") == 0) {
-        fprintf(output, "    forth_r_from();\n");
-    } else if (strcmp(word_name, "r@") == 0) {
-        fprintf(output, "    forth_r_fetch();\n");
-        
+    {">r", 1, 0, 0, 0, "rpush($0);"},
+    {"r>", 0, 1, 0, 0, "rpop()"},
+    {"r@", 0, 1, 0, 0, "rpeek()"},
+
     /* Comparison Operations */
-    } else if (strcmp(word_name, "=") == 0) {
-        fprintf(output, "    forth_equals();\n");
-    } else if (strcmp(word_name, "<>") == 0) {
-        fprintf(output, "    forth_not_equals();\n");
-    } else if (strcmp(word_name, "<") == 0) {
-        fprintf(output, "    forth_less_than();\n");
-    } else if (strcmp(word_name, ">") == 0) {
-        fprintf(output, "    forth_greater_than();\n");
-    } else if (strcmp(word_name, "0=") == 0) {
-        fprintf(output, "    forth_zero_equals();\n");
-    } else if (strcmp(word_name, "0<") == 0) {
-        fprintf(output, "    forth_zero_less();\n");
-    } else if (strcmp(word_name, "0>") == 0) {
-        fprintf(output, "    forth_zero_greater();\n");
-        
+    {"=", 2, 1, 0, 0, "$0 == $1 ? -1 : 0"},
+    {"<>", 2, 1, 0, 0, "$0 != $1 ? -1 : 0"},
+    {"<", 2, 1, 0, 0, "$0 < $1 ? -1 : 0"},
+    {">", 2, 1, 0, 0, "$0 > $1 ? -1 : 0"},
+    {"0=", 1, 1, 0, 0, "$0 == 0 ? -1 : 0"},
+    {"0<", 1, 1, 0, 0, "$0 < 0 ? -1 : 0"},
+    {"0>", 1, 1, 0, 0, "$0 > 0 ? -1 : 0"},
+
     /* Logical Operations */
-    } else if (strcmp(word_name, "and") == 0) {
-        fprintf(output, "    forth_and();\n");
-    } else if (strcmp(word_name, "or") == 0) {
-        fprintf(output, "    forth_or();\n");
-    } else if (strcmp(word_name, "xor") == 0) {
-        fprintf(output, "    forth_xor();\n");
-    } else if (strcmp(word_name, "invert") == 0) {
-        fprintf(output, "    forth_invert();\n");
-    } else if (strcmp(word_name, "lshift") == 0) {
-        fprintf(output, "    { int64_t n = pop(), val = pop(); push(val << n); }\n");
-    } else if (strcmp(word_name, "rshift") == 0) {
-        fprintf(output, "    { int64_t n = pop(), val = pop(); push(val >> n); }\n");
-        
+    {"and", 2, 1, 0, 0, "$0 & $1"},
+    {"or", 2, 1, 0, 0, "$0 | $1"},
+    {"xor", 2, 1, 0, 0, "$0 ^ $1"},
+    {"invert", 1, 1, 0, 0, "~$0"},
+    {"lshift", 2, 1, 0, 0, "$0 << $1"},
+    {"rshift", 2, 1, 0, 0, "$0 >> $1"},
+
+    /* Memory: addresses are those of the static data in the C program */
+    {"@", 1, 1, 0, 0, "*(int64_t *)(intptr_t)$0"},
+    {"!", 2, 0, 0, 0, "*(int64_t *)(intptr_t)$1 = $0;"},
+    {"+!", 2, 0, 0, 0, "*(int64_t *)(intptr_t)$1 += $0;"},
+    {"c@", 1, 1, 0, 0, "*(uint8_t *)(intptr_t)$0"},
+    {"c!", 2, 0, 0, 0, "*(uint8_t *)(intptr_t)$1 = (uint8_t)$0;"},
+    {"?", 1, 0, 0, 0, "printf(\"%ld \", (long)*(int64_t *)(intptr_t)$0);"},
+    {"cells", 1, 1, 0, 0, "$0 * (int64_t)sizeof(int64_t)"},
+    {"cell+", 1, 1, 0, 0, "$0 + (int64_t)sizeof(int64_t)"},
+    {"f@", 1, 0, 0, 1, "*(double *)(intptr_t)$0"},
+    {"f!", 1, 0, 1, 0, "*(double *)(intptr_t)$0 = #0;"},
+
     /* I/O Operations */
-    } else if (strcmp(word_name, ".") == 0) {
-        fprintf(output, "    forth_dot();\n");
-    } else if (strcmp(word_name, "emit") == 0) {
-        fprintf(output, "    forth_emit();\n");
-    } else if (strcmp(word_name, "cr") == 0) {
-        fprintf(output, "    forth_cr();\n");
-    } else if (strcmp(word_name, "space") == 0) {
-        fprintf(output, "    forth_space();\n");
-    } else if (strcmp(word_name, "spaces") == 0) {
-        fprintf(output, "    forth_spaces();\n");
-        
+    {".", 1, 0, 0, 0, "printf(\"%ld \", (long)$0);"},
+    {"emit", 1, 0, 0, 0, "printf(\"%c\", (char)$0);"},
+    {"cr", 0, 0, 0, 0, "printf(\"\\n\");"},
+    {"space", 0, 0, 0, 0, "printf(\" \");"},
+    {"spaces", 1, 0, 0, 0, "for (int64_t n = 0; n < $0; n++) printf(\" \");"},
+
+    /* Floating point (float stack of doubles) */
+    {"f+", 0, 0, 2, 1, "#0 + #1"},
+    {"f-", 0, 0, 2, 1, "#0 - #1"},
+    {"f*", 0, 0, 2, 1, "#0 * #1"},
+    {"f/", 0, 0, 2, 1, "#0 / #1"},
+    {"f**", 0, 0, 2, 1, "pow(#0, #1)"},
+    {"fnegate", 0, 0, 1, 1, "-#0"},
+    {"fabs", 0, 0, 1, 1, "fabs(#0)"},
+    {"fsqrt", 0, 0, 1, 1, "sqrt(#0)"},
+    {"floor", 0, 0, 1, 1, "floor(#0)"},
+    {"fround", 0, 0, 1, 1, "nearbyint(#0)"},
+    {"ftrunc", 0, 0, 1, 1, "trunc(#0)"},
+    {"fmin", 0, 0, 2, 1, "fmin(#0, #1)"},
+    {"fmax", 0, 0, 2, 1, "fmax(#0, #1)"},
+    {"fsin", 0, 0, 1, 1, "sin(#0)"},
+    {"fcos", 0, 0, 1, 1, "cos(#0)"},
+    {"ftan", 0, 0, 1, 1, "tan(#0)"},
+    {"fatan", 0, 0, 1, 1, "atan(#0)"},
+    {"fatan2", 0, 0, 2, 1, "atan2(#0, #1)"},
+    {"fexp", 0, 0, 1, 1, "exp(#0)"},
+    {"fln", 0, 0, 1, 1, "log(#0)"},
+    {"flog", 0, 0, 1, 1, "log10(#0)"},
+    {"f<", 0, 1, 2, 0, "#0 < #1 ? -1 : 0"},
+    {"f>", 0, 1, 2, 0, "#0 > #1 ? -1 : 0"},
+    {"f=", 0, 1, 2, 0, "#0 == #1 ? -1 : 0"},
+    {"f0=", 0, 1, 1, 0, "#0 == 0.0 ? -1 : 0"},
+    {"f0<", 0, 1, 1, 0, "#0 < 0.0 ? -1 : 0"},
+    {"s>f", 1, 0, 0, 1, "(double)$0"},
+    {"f>s", 0, 1, 1, 0, "(int64_t)#0"},
+    {"floats", 1, 1, 0, 0, "$0 * (int64_t)sizeof(double)"},
+    {"float+", 1, 1, 0, 0, "$0 + (int64_t)sizeof(double)"},
+    {"f.", 0, 0, 1, 0, "printf(\"%.6g \", #0);"},
+
+    /* Timing Operations (librforth_runtime) */
+    {"micros", 0, 1, 0, 0, "(int64_t)micros()"},
+    {"millis", 0, 1, 0, 0, "(int64_t)millis()"},
+    {"delay-ms", 1, 0, 0, 0, "delay_milliseconds((uint32_t)$0);"},
+    {"delay-us", 1, 0, 0, 0, "delay_microseconds((uint32_t)$0);"},
+
+    /* Raspberry Pi GPIO Operations (librforth_runtime) */
+    {"gpio-init", 0, 0, 0, 0, "rf_gpio_check(gpio_init(), \"GPIO-INIT\"); printf(\"GPIO initialized successfully\\n\");"},
+    {"gpio-close", 0, 0, 0, 0, "rf_gpio_check(gpio_cleanup(), \"GPIO-CLOSE\"); printf(\"GPIO closed successfully\\n\");"},
+    {"gpio-output", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_OUTPUT), \"GPIO-OUTPUT\");"},
+    {"gpio-input", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_INPUT), \"GPIO-INPUT\");"},
+    {"gpio-alt0", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_ALT0), \"GPIO-ALT0\");"},
+    {"gpio-alt1", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_ALT1), \"GPIO-ALT1\");"},
+    {"gpio-alt2", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_ALT2), \"GPIO-ALT2\");"},
+    {"gpio-alt3", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_ALT3), \"GPIO-ALT3\");"},
+    {"gpio-alt4", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_ALT4), \"GPIO-ALT4\");"},
+    {"gpio-alt5", 1, 0, 0, 0, "rf_gpio_check(gpio_set_mode((uint8_t)$0, GPIO_MODE_ALT5), \"GPIO-ALT5\");"},
+    {"gpio-pull-up", 1, 0, 0, 0, "rf_gpio_check(gpio_set_pull((uint8_t)$0, GPIO_PULL_UP), \"GPIO-PULL-UP\");"},
+    {"gpio-pull-down", 1, 0, 0, 0, "rf_gpio_check(gpio_set_pull((uint8_t)$0, GPIO_PULL_DOWN), \"GPIO-PULL-DOWN\");"},
+    {"gpio-pull-off", 1, 0, 0, 0, "rf_gpio_check(gpio_set_pull((uint8_t)$0, GPIO_PULL_OFF), \"GPIO-PULL-OFF\");"},
+    {"gpio-set", 1, 0, 0, 0, "rf_gpio_check(gpio_set((uint8_t)$0), \"GPIO-SET\");"},
+    {"gpio-clr", 1, 0, 0, 0, "rf_gpio_check(gpio_clear((uint8_t)$0), \"GPIO-CLR\");"},
+    {"gpio-write", 2, 0, 0, 0, "rf_gpio_check(gpio_write((uint8_t)$1, $0 != 0), \"GPIO-WRITE\");"},
+    {"gpio-read", 1, 1, 0, 0, "rf_gpio_read($0)"},
+    {"gpio-toggle", 1, 0, 0, 0, "rf_gpio_check(gpio_toggle((uint8_t)$0), \"GPIO-TOGGLE\");"},
+    {"gpio-mask-set", 1, 0, 0, 0, "rf_gpio_check(gpio_mask_set((uint32_t)$0), \"GPIO-MASK-SET\");"},
+    {"gpio-mask-clr", 1, 0, 0, 0, "rf_gpio_check(gpio_mask_clear((uint32_t)$0), \"GPIO-MASK-CLR\");"},
+    {"gpio-mask-read", 0, 1, 0, 0, "(int64_t)gpio_mask_read()"},
+    {"gpio-valid?", 1, 1, 0, 0, "gpio_is_valid_pin((uint8_t)$0) ? -1 : 0"},
+
     /* Character Operations */
-    } else if (strcmp(word_name, "char") == 0) {
-        fprintf(output, "    push(65); /* Simplified CHAR */\n");
-    } else if (strcmp(word_name, "chars") == 0) {
-        fprintf(output, "    /* CHARS - no-op in this implementation */\n");
-    } else if (strcmp(word_name, "char+") == 0) {
-        fprintf(output, "    push(pop() + 1);\n");
-        
+    {"char", 0, 1, 0, 0, "65"},
+    {"char+", 1, 1, 0, 0, "$0 + 1"},
+};
+
+/* Emit code to the current function, indented one level */
+static void emit_line(compiler_ctx_t *compiler, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fputs("    ", compiler->output);
+    vfprintf(compiler->output, format, args);
+    fputc('\n', compiler->output);
+    va_end(args);
+}
+
+/* Print text as it appears in the source */
+static void emit_string(compiler_ctx_t *compiler, const char *text, size_t length) {
+    fputs("    fputs(\"", compiler->output);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            fprintf(compiler->output, "\\%c", c);
+        } else if (isprint(c)) {
+            fputc(c, compiler->output);
+        } else {
+            fprintf(compiler->output, "\\%03o", c);
+        }
+    }
+    fputs("\", stdout);\n", compiler->output);
+}
+
+/* Push every pending float onto the real float stack, deepest first */
+static void flush_fvalues(compiler_ctx_t *compiler) {
+    for (int i = 0; i < compiler->fvalue_depth; i++) {
+        emit_line(compiler, "fpush(%s);", compiler->fvalues[i]);
+    }
+    compiler->fvalue_depth = 0;
+}
+
+/* Push every pending value onto the real stacks, deepest first */
+static void flush_values(compiler_ctx_t *compiler) {
+    for (int i = 0; i < compiler->value_depth; i++) {
+        emit_line(compiler, "push(%s);", compiler->values[i]);
+    }
+    compiler->value_depth = 0;
+    flush_fvalues(compiler);
+}
+
+static void push_value(compiler_ctx_t *compiler, const char *expr) {
+    if (compiler->value_depth == MAX_PENDING_VALUES) {
+        flush_values(compiler);
+    }
+    snprintf(compiler->values[compiler->value_depth++], sizeof(compiler->values[0]), "%s", expr);
+}
+
+/* Evaluate expr once into a new local and push that */
+static void push_temp(compiler_ctx_t *compiler, const char *expr) {
+    char temp[MAX_VALUE_LENGTH];
+    snprintf(temp, sizeof(temp), "t%d", ++compiler->temp_counter);
+    emit_line(compiler, "int64_t %s = %s;", temp, expr);
+    push_value(compiler, temp);
+}
+
+static void push_literal(compiler_ctx_t *compiler, int64_t number) {
+    char literal[MAX_VALUE_LENGTH];
+    snprintf(literal, sizeof(literal), number < 0 ? "(%ld)" : "%ld", (long)number);
+    push_value(compiler, literal);
+}
+
+/* Take the top value, from the real stack once no pending value is left */
+static void pop_value(compiler_ctx_t *compiler, char *expr) {
+    if (compiler->value_depth == 0) {
+        push_temp(compiler, "pop()");
+    }
+    strcpy(expr, compiler->values[--compiler->value_depth]);
+}
+
+/* Discard the top value, which nothing reads */
+static void drop_value(compiler_ctx_t *compiler) {
+    if (compiler->value_depth == 0) {
+        emit_line(compiler, "pop();");
+    } else {
+        compiler->value_depth--;
+    }
+}
+
+static void push_fvalue(compiler_ctx_t *compiler, const char *expr) {
+    if (compiler->fvalue_depth == MAX_PENDING_VALUES) {
+        flush_fvalues(compiler);
+    }
+    snprintf(compiler->fvalues[compiler->fvalue_depth++], sizeof(compiler->fvalues[0]), "%s", expr);
+}
+
+static void push_ftemp(compiler_ctx_t *compiler, const char *expr) {
+    char temp[MAX_VALUE_LENGTH];
+    snprintf(temp, sizeof(temp), "f%d", ++compiler->temp_counter);
+    emit_line(compiler, "double %s = %s;", temp, expr);
+    push_fvalue(compiler, temp);
+}
+
+/* A C double literal that reads back as exactly number */
+static void format_double(double number, char *literal, size_t size) {
+    if (isnan(number)) {
+        snprintf(literal, size, "NAN");
+    } else if (isinf(number)) {
+        snprintf(literal, size, number < 0 ? "(-HUGE_VAL)" : "HUGE_VAL");
+    } else {
+        char digits[MAX_VALUE_LENGTH - 4];
+        snprintf(digits, sizeof(digits), "%.17g", number);
+        snprintf(literal, size, number < 0 ? "(%s%s)" : "%s%s", digits, strpbrk(digits, ".e") ? "" : ".0");
+    }
+}
+
+static void push_fliteral(compiler_ctx_t *compiler, double number) {
+    char literal[MAX_VALUE_LENGTH];
+    format_double(number, literal, sizeof(literal));
+    push_fvalue(compiler, literal);
+}
+
+static void pop_fvalue(compiler_ctx_t *compiler, char *expr) {
+    if (compiler->fvalue_depth == 0) {
+        push_ftemp(compiler, "fpop()");
+    }
+    strcpy(expr, compiler->fvalues[--compiler->fvalue_depth]);
+}
+
+static void drop_fvalue(compiler_ctx_t *compiler) {
+    if (compiler->fvalue_depth == 0) {
+        emit_line(compiler, "fpop();");
+    } else {
+        compiler->fvalue_depth--;
+    }
+}
+
+/* Substitute the cell operands ($n) and float operands (#n) into a primitive's code */
+static void expand_code(const char *code, char operands[][MAX_VALUE_LENGTH],
+                        char float_operands[][MAX_VALUE_LENGTH], char *out, size_t size) {
+    size_t length = 0;
+    for (; *code && length < size - 1; code++) {
+        if ((code[0] == '$' || code[0] == '#') && isdigit((unsigned char)code[1])) {
+            const char *operand = code[0] == '$' ? operands[code[1] - '0'] : float_operands[code[1] - '0'];
+            code++;
+            while (*operand && length < size - 1) out[length++] = *operand++;
+        } else {
+            out[length++] = *code;
+        }
+    }
+    out[length] = '\0';
+}
+
+/* Stack effect of a shuffle or primitive; false for any other word */
+static bool builtin_effect(const char *word_name, int *inputs, int *outputs) {
+    for (size_t i = 0; i < sizeof(shuffles) / sizeof(shuffles[0]); i++) {
+        if (strcmp(word_name, shuffles[i].name) == 0) {
+            *inputs = shuffles[i].floats ? 0 : shuffles[i].inputs;
+            *outputs = shuffles[i].floats ? 0 : (int)strlen(shuffles[i].outputs);
+            return true;
+        }
+    }
+    for (size_t i = 0; i < sizeof(primitives) / sizeof(primitives[0]); i++) {
+        if (strcmp(word_name, primitives[i].name) == 0) {
+            *inputs = primitives[i].inputs;
+            *outputs = primitives[i].outputs;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Latest definition of a word that code at the current point can call */
+static const compiled_word_t* find_word(compiler_ctx_t *compiler, const char *word_name) {
+    int limit = compiler->current_word >= 0 ? compiler->current_word : compiler->word_count;
+    for (int i = limit - 1; i >= 0; i--) {
+        if (strcmp(compiler->words[i].name, word_name) == 0) {
+            return &compiler->words[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Latest VARIABLE, CONSTANT or CREATE that code at the current point can
+ * use, unless word, the latest colon definition of the name, comes later.
+ */
+static const compiled_data_t* find_data(compiler_ctx_t *compiler, const char *word_name,
+                                        const compiled_word_t *word) {
+    int word_index = word ? (int)(word - compiler->words) : -1;
+    for (int i = compiler->data_count - 1; i >= 0; i--) {
+        const compiled_data_t *data = &compiler->data[i];
+        bool visible = compiler->current_word >= 0 ? data->words_before <= compiler->current_word
+                                                   : i < compiler->next_data;
+        if (visible && strcmp(data->name, word_name) == 0) {
+            return data->words_before > word_index ? data : NULL;
+        }
+    }
+    return NULL;
+}
+
+/* C object holding a data word's storage or value */
+static void data_identifier(const compiler_ctx_t *compiler, const compiled_data_t *data,
+                            char *c_name, size_t size) {
+    static const char *const prefixes[] = {"data", "fdata", "const", "fconst"};
+    char identifier[MAX_WORD_LENGTH];
+    word_name_to_c_identifier(data->name, identifier, sizeof(identifier));
+    snprintf(c_name, size, "%s_%s_%d", prefixes[data->kind], identifier, (int)(data - compiler->data));
+}
+
+/* A variable pushes its address and a constant its value, which C can fold when literal */
+static void generate_data_ref(compiler_ctx_t *compiler, const compiled_data_t *data) {
+    char c_name[MAX_WORD_LENGTH + 16];
+    char code[MAX_WORD_LENGTH + 40];
+    data_identifier(compiler, data, c_name, sizeof(c_name));
+    
+    switch (data->kind) {
+        case DATA_CELLS:
+        case DATA_FLOATS:
+            snprintf(code, sizeof(code), "(int64_t)(intptr_t)%s", c_name);
+            push_temp(compiler, code);
+            break;
+        case DATA_CONSTANT:
+            push_temp(compiler, c_name);
+            break;
+        case DATA_FCONSTANT:
+            push_ftemp(compiler, c_name);
+            break;
+    }
+}
+
+static bool generate_builtin(compiler_ctx_t *compiler, const char *word_name) {
+    char operands[6][MAX_VALUE_LENGTH];
+    char float_operands[2][MAX_VALUE_LENGTH];
+
+    for (size_t i = 0; i < sizeof(shuffles) / sizeof(shuffles[0]); i++) {
+        const shuffle_t *shuffle = &shuffles[i];
+        if (strcmp(word_name, shuffle->name) != 0) continue;
+
+        for (int n = shuffle->inputs - 1; n >= 0; n--) {
+            bool used = strchr(shuffle->outputs, '0' + n) != NULL;
+            if (shuffle->floats) {
+                if (used) pop_fvalue(compiler, operands[n]); else drop_fvalue(compiler);
+            } else {
+                if (used) pop_value(compiler, operands[n]); else drop_value(compiler);
+            }
+        }
+        for (const char *output = shuffle->outputs; *output; output++) {
+            if (shuffle->floats) {
+                push_fvalue(compiler, operands[*output - '0']);
+            } else {
+                push_value(compiler, operands[*output - '0']);
+            }
+        }
+        return true;
+    }
+
+    for (size_t i = 0; i < sizeof(primitives) / sizeof(primitives[0]); i++) {
+        const primitive_t *primitive = &primitives[i];
+        if (strcmp(word_name, primitive->name) != 0) continue;
+
+        char code[256];
+        for (int n = primitive->inputs - 1; n >= 0; n--) {
+            pop_value(compiler, operands[n]);
+        }
+        for (int n = primitive->float_inputs - 1; n >= 0; n--) {
+            pop_fvalue(compiler, float_operands[n]);
+        }
+        expand_code(primitive->code, operands, float_operands, code, sizeof(code));
+        if (primitive->outputs) {
+            push_temp(compiler, code);
+        } else if (primitive->float_outputs) {
+            push_ftemp(compiler, code);
+        } else {
+            emit_line(compiler, "%s", code);
+        }
+        return true;
+    }
+    return false;
+}
+
+/* Signature of the word being generated, or NULL for one using the real stack only */
+static const compiled_word_t* current_signature(compiler_ctx_t *compiler) {
+    if (compiler->current_word < 0) return NULL;
+    
+    const compiled_word_t *word = &compiler->words[compiler->current_word];
+    return word->fixed_effect ? word : NULL;
+}
+
+/* Leave the current function, returning its single output if it has one */
+static void generate_return(compiler_ctx_t *compiler) {
+    const compiled_word_t *word = current_signature(compiler);
+    int depth = compiler->value_depth;
+    
+    if (word && word->outputs == 1) {
+        char value[MAX_VALUE_LENGTH];
+        pop_value(compiler, value);
+        flush_values(compiler);
+        emit_line(compiler, "return %s;", value);
+    } else {
+        flush_values(compiler);
+        emit_line(compiler, compiler->in_main ? "return 0;" : "return;");
+    }
+    
+    /* Code after an EXIT inside IF still rejoins at THEN with the same cells */
+    if (word) compiler->value_depth = depth;
+}
+
+/* Cells every path agrees on where control flow joins: in the slot locals of
+ * a word with a fixed stack effect, otherwise pushed onto the real stack */
+static void sync_values(compiler_ctx_t *compiler) {
+    /* Floats always meet on the real float stack */
+    flush_fvalues(compiler);
+    if (!current_signature(compiler)) {
+        flush_values(compiler);
+        return;
+    }
+    if (compiler->unreachable) return;
+    
+    /* Read cells held in other slots first, so the assignments cannot clobber them */
+    char slot[MAX_VALUE_LENGTH];
+    for (int k = 0; k < compiler->value_depth; k++) {
+        snprintf(slot, sizeof(slot), "s%d", k);
+        if (compiler->values[k][0] == 's' && strcmp(compiler->values[k], slot) != 0) {
+            emit_line(compiler, "int64_t t%d = %s;", ++compiler->temp_counter, compiler->values[k]);
+            snprintf(compiler->values[k], sizeof(compiler->values[k]), "t%d", compiler->temp_counter);
+        }
+    }
+    for (int k = 0; k < compiler->value_depth; k++) {
+        snprintf(slot, sizeof(slot), "s%d", k);
+        if (strcmp(compiler->values[k], slot) != 0) {
+            emit_line(compiler, "%s = %s;", slot, compiler->values[k]);
+            strcpy(compiler->values[k], slot);
+        }
+    }
+}
+
+/* Pending cells after a label reached with count cells on the stack */
+static void rejoin_values(compiler_ctx_t *compiler, int count) {
+    if (!current_signature(compiler)) return;
+    
+    for (int k = 0; k < count; k++) {
+        snprintf(compiler->values[k], sizeof(compiler->values[k]), "s%d", k);
+    }
+    compiler->value_depth = count;
+}
+
+/* Label of the n-th enclosing DO loop (0 = innermost), or 0 outside one */
+static int counted_loop_label(compiler_ctx_t *compiler, int n) {
+    for (int depth = compiler->loop_depth - 1; depth >= 0; depth--) {
+        if (compiler->loop_counted[depth] && n-- == 0) {
+            return compiler->loop_stack[depth];
+        }
+    }
+    return 0;
+}
+
+/* Open a C loop for BEGIN, or for DO with its index and limit */
+static void open_loop(compiler_ctx_t *compiler, bool counted, const char *index, const char *limit) {
+    int label = ++compiler->label_counter;
+    if (compiler->loop_depth >= 64) {
+        fprintf(stderr, "Error: Loops nested more than 64 deep\n");
+        compiler->failed = true;
+        return;
+    }
+
+    compiler->loop_stack[compiler->loop_depth] = label;
+    compiler->loop_counted[compiler->loop_depth] = counted;
+    compiler->loop_left[compiler->loop_depth] = false;
+    compiler->loop_values[compiler->loop_depth] = compiler->value_depth;
+    compiler->loop_depth++;
+
+    if (counted) {
+        /* The loop parameters live in C locals instead of on the return stack */
+        emit_line(compiler, "{");
+        emit_line(compiler, "int64_t i_%d = %s, limit_%d = %s;", label, index, label, limit);
+        emit_line(compiler, "for (;;) {");
+    } else {
+        emit_line(compiler, "while (1) {");
+    }
+}
+
+/* Close the innermost C loop; exit_test is emitted as its last statement */
+static void close_loop(compiler_ctx_t *compiler, const char *exit_test) {
+    if (compiler->loop_depth == 0) return;
+
+    int depth = --compiler->loop_depth;
+    int label = compiler->loop_stack[depth];
+    if (exit_test) {
+        emit_line(compiler, "%s", exit_test);
+    }
+    emit_line(compiler, "}");
+    if (compiler->loop_counted[depth]) {
+        emit_line(compiler, "}");
+    }
+    if (compiler->loop_left[depth]) {
+        fprintf(compiler->output, "leave_%d: ;\n", label);
+    }
+    rejoin_values(compiler, compiler->loop_values[depth]);
+    compiler->unreachable = false;
+}
+
+/*
+ * Helper function to generate word call code. Values stay in C locals
+ * while a basic block runs; the real stack is only brought up to date
+ * where control flow joins or leaves, and around calls of other words.
+ */
+static void generate_word_call(compiler_ctx_t *compiler, const char *forth_name) {
+    char value[MAX_VALUE_LENGTH], limit[MAX_VALUE_LENGTH];
+    char code[256];
+    
+    char word_name[MAX_WORD_LENGTH];
+    lower_case_name(forth_name, word_name, sizeof(word_name));
+    
+    if (generate_builtin(compiler, word_name)) return;
+    
     /* Control Flow */
-    } else if (strcmp(word_name, "if") == 0) {
+    if (strcmp(word_name, "if") == 0) {
+        if (compiler->if_depth >= 64) {
+            fprintf(stderr, "Error: IF nested more than 64 deep\n");
+            compiler->failed = true;
+            return;
+        }
         /* Generate label-based control flow */
         int label = ++compiler->label_counter;
+        pop_value(compiler, value);
+        sync_values(compiler);
+        compiler->if_values[compiler->if_depth] = compiler->value_depth;
         compiler->if_stack[compiler->if_depth++] = label;
-        fprintf(output, "    if (!pop()) goto endif_%d;\n", label);
+        emit_line(compiler, "if (!%s) goto endif_%d;", value, label);
     } else if (strcmp(word_name, "else") == 0) {
+        /* THEN is reached from the end of this part unless that cannot run */
+        int then_values = compiler->unreachable ? -1 : compiler->value_depth;
+        sync_values(compiler);
         if (compiler->if_depth > 0) {
             int else_label = ++compiler->label_counter;
             int if_label = compiler->if_stack[compiler->if_depth - 1];
             compiler->if_stack[compiler->if_depth - 1] = else_label; /* Update for endif */
-            fprintf(output, "    goto endif_%d;\n", else_label);
-            fprintf(output, "endif_%d: /* else clause */\n", if_label);
+            emit_line(compiler, "goto endif_%d;", else_label);
+            fprintf(compiler->output, "endif_%d: ; /* else clause */\n", if_label);
+            rejoin_values(compiler, compiler->if_values[compiler->if_depth - 1]);
+            compiler->if_values[compiler->if_depth - 1] = then_values;
+            compiler->unreachable = false;
         }
     } else if (strcmp(word_name, "then") == 0) {
+        sync_values(compiler);
         if (compiler->if_depth > 0) {
             int label = compiler->if_stack[--compiler->if_depth];
-            fprintf(output, "endif_%d:\n", label);
+            int other_values = compiler->if_values[compiler->if_depth];
+            fprintf(compiler->output, "endif_%d: ;\n", label);
+            if (compiler->unreachable && other_values >= 0) {
+                rejoin_values(compiler, other_values);
+                compiler->unreachable = false;
+            }
         }
         
+    /* Loops become C loops */
+    } else if (strcmp(word_name, "begin") == 0) {
+        sync_values(compiler);
+        open_loop(compiler, false, NULL, NULL);
+    } else if (strcmp(word_name, "until") == 0) {
+        pop_value(compiler, value);
+        sync_values(compiler);
+        snprintf(code, sizeof(code), "if (%s) break;", value);
+        close_loop(compiler, code);
+    } else if (strcmp(word_name, "while") == 0) {
+        pop_value(compiler, value);
+        sync_values(compiler);
+        emit_line(compiler, "if (!%s) break;", value);
+        if (compiler->loop_depth > 0) {
+            compiler->loop_values[compiler->loop_depth - 1] = compiler->value_depth;
+        }
+    } else if (strcmp(word_name, "repeat") == 0 || strcmp(word_name, "again") == 0) {
+        sync_values(compiler);
+        close_loop(compiler, NULL);
+    } else if (strcmp(word_name, "do") == 0) {
+        pop_value(compiler, value);
+        pop_value(compiler, limit);
+        sync_values(compiler);
+        open_loop(compiler, true, value, limit);
+    } else if (strcmp(word_name, "loop") == 0) {
+        int label = counted_loop_label(compiler, 0);
+        sync_values(compiler);
+        snprintf(code, sizeof(code), "if (++i_%d >= limit_%d) break;", label, label);
+        close_loop(compiler, code);
+    } else if (strcmp(word_name, "+loop") == 0) {
+        /* Like the VM: a negative step runs until the index passes below the limit */
+        int label = counted_loop_label(compiler, 0);
+        pop_value(compiler, value);
+        sync_values(compiler);
+        snprintf(code, sizeof(code), "i_%d += %s; if (%s >= 0 ? i_%d >= limit_%d : i_%d < limit_%d) break;",
+                 label, value, value, label, label, label, label);
+        close_loop(compiler, code);
+    } else if (strcmp(word_name, "i") == 0 || strcmp(word_name, "j") == 0) {
+        snprintf(value, sizeof(value), "i_%d", counted_loop_label(compiler, word_name[0] == 'j'));
+        push_temp(compiler, value);
+    } else if (strcmp(word_name, "leave") == 0) {
+        /* A break only reaches the DO loop when no BEGIN loop is nested inside it */
+        int depth = compiler->loop_depth - 1;
+        while (depth >= 0 && !compiler->loop_counted[depth]) depth--;
+        sync_values(compiler);
+        if (depth == compiler->loop_depth - 1) {
+            emit_line(compiler, "break;");
+        } else if (depth >= 0) {
+            compiler->loop_left[depth] = true;
+            emit_line(compiler, "goto leave_%d;", compiler->loop_stack[depth]);
+        }
+        compiler->unreachable = true;
+    } else if (strcmp(word_name, "unloop") == 0) {
+        emit_line(compiler, "/* UNLOOP - loop parameters are C locals */");
+    } else if (strcmp(word_name, "exit") == 0) {
+        generate_return(compiler);
+        compiler->unreachable = true;
+        
     /* Special words */
     } else if (strcmp(word_name, "bye") == 0) {
-        fprintf(output, "    exit(0);\n");
-    } else if (strcmp(word_name, ".\"") == 0) {
-        fprintf(output, "    /* .\" handled separately in parsing */\n");
+        flush_values(compiler);
+        emit_line(compiler, "exit(0);");
     } else {
         /* Assume it's a user word */
         char c_name[MAX_FILENAME_LENGTH];
         word_name_to_c_identifier(word_name, c_name, sizeof(c_name));
-        fprintf(output, "    word_%s();\n", c_name);
+        
+        const compiled_word_t *word = find_word(compiler, word_name);
+        const compiled_data_t *data = find_data(compiler, word_name, word);
+        if (data) {
+            generate_data_ref(compiler, data);
+            return;
+        }
+        if (!word || !word->fixed_effect) {
+            flush_values(compiler);
+            emit_line(compiler, "word_%s();", c_name);
+            return;
+        }
+        
+        /* Its inputs are passed as arguments and a single output is returned */
+        char operands[MAX_WORD_PARAMETERS][MAX_VALUE_LENGTH];
+        for (int n = word->inputs - 1; n >= 0; n--) {
+            pop_value(compiler, operands[n]);
+        }
+        flush_fvalues(compiler);
+        int length = snprintf(code, sizeof(code), "word_%s(", c_name);
+        for (int n = 0; n < word->inputs; n++) {
+            length += snprintf(code + length, sizeof(code) - length, n ? ", %s" : "%s", operands[n]);
+        }
+        snprintf(code + length, sizeof(code) - length, ")");
+        
+        if (word->outputs == 1) {
+            push_temp(compiler, code);
+        } else {
+            /* More outputs come back on top of the real stack */
+            emit_line(compiler, "%s;", code);
+            for (int n = word->outputs - 1; n >= 0; n--) {
+                snprintf(operands[n], sizeof(operands[n]), "t%d", ++compiler->temp_counter);
+                emit_line(compiler, "int64_t %s = pop();", operands[n]);
+            }
+            for (int n = 0; n < word->outputs; n++) {
+                push_value(compiler, operands[n]);
+            }
+        }
     }
 }
 
+/* A defining word run by main: its storage was laid out when collecting the program */
+static void generate_definition(compiler_ctx_t *compiler, parser_t *parser, int kind) {
+    token_t name = parser_next_token(parser);
+    if (name.type != TOKEN_WORD || compiler->next_data >= compiler->data_count) return;
+    
+    const compiled_data_t *data = &compiler->data[compiler->next_data++];
+    char c_name[MAX_WORD_LENGTH + 16];
+    char value[MAX_VALUE_LENGTH];
+    data_identifier(compiler, data, c_name, sizeof(c_name));
+    
+    switch (kind) {
+        case DATA_CELLS:
+            scan_data_region(parser, NULL);
+            break;
+        case DATA_FLOATS:
+            break;
+        case DATA_CONSTANT:
+            pop_value(compiler, value);
+            if (!data->literal) emit_line(compiler, "%s = %s;", c_name, value);
+            break;
+        case DATA_FCONSTANT:
+            pop_fvalue(compiler, value);
+            if (!data->literal) emit_line(compiler, "%s = %s;", c_name, value);
+            break;
+    }
+}
 
+/* Code for one token of a definition or of the main program */
+static void generate_token(compiler_ctx_t *compiler, parser_t *parser, const token_t *token) {
+    switch (token->type) {
+        case TOKEN_NUMBER:
+            push_literal(compiler, token->value.number);
+            break;
+            
+        case TOKEN_FLOAT: {
+            /* Cells are plain integers here, so a float cell holds its bits */
+            int64_t bits;
+            memcpy(&bits, &token->value.float_val, sizeof(bits));
+            push_literal(compiler, bits);
+            break;
+        }
+            
+        case TOKEN_FLOAT_EXP:
+            push_fliteral(compiler, token->value.float_val);
+            break;
+            
+        case TOKEN_WORD: {
+            char word_name[MAX_WORD_LENGTH];
+            token_word_name(token, word_name, sizeof(word_name));
+            int kind = defining_word_kind(word_name);
+            
+            if (strcmp(word_name, ".\"") == 0) {
+                const char *text;
+                size_t length;
+                if (parse_dot_quote(parser, &text, &length)) emit_string(compiler, text, length);
+            } else if (compiler->in_main && kind >= 0) {
+                generate_definition(compiler, parser, kind);
+            } else {
+                char text[MAX_WORD_LENGTH];
+                parser_token_text(token, text, sizeof(text));
+                generate_word_call(compiler, text);
+            }
+            break;
+        }
+            
+        case TOKEN_STRING:
+            emit_string(compiler, token->start, (size_t)token->length);
+            break;
+            
+        default:
+            /* Skip other tokens */
+            break;
+    }
+}
 
 compiler_ctx_t* compiler_create(const char *output_file) {
     if (!output_file) return NULL;
@@ -215,6 +985,19 @@ compiler_ctx_t* compiler_create(const char *output_file) {
     compiler->control_depth = 0;
     compiler->label_counter = 0;
     compiler->if_depth = 0;
+    compiler->loop_depth = 0;
+    compiler->value_depth = 0;
+    compiler->fvalue_depth = 0;
+    compiler->temp_counter = 0;
+    compiler->words = NULL;
+    compiler->word_capacity = 0;
+    compiler->current_word = -1;
+    compiler->unreachable = false;
+    compiler->failed = false;
+    compiler->data = NULL;
+    compiler->data_count = 0;
+    compiler->data_capacity = 0;
+    compiler->next_data = 0;
     
     return compiler;
 }
@@ -224,6 +1007,14 @@ void compiler_destroy(compiler_ctx_t *compiler) {
         if (compiler->output) fclose(compiler->output);
         free(compiler->output_filename);
         free(compiler->executable_name);
+        for (int i = 0; i < compiler->word_count; i++) {
+            free(compiler->words[i].definition);
+        }
+        free(compiler->words);
+        for (int i = 0; i < compiler->data_count; i++) {
+            free(compiler->data[i].cells);
+        }
+        free(compiler->data);
         free(compiler);
     }
 }
@@ -231,187 +1022,303 @@ void compiler_destroy(compiler_ctx_t *compiler) {
 bool compiler_generate_header(compiler_ctx_t *compiler) {
     if (!compiler || !compiler->output) return false;
     
+    /* The stacks and primitives come from the runtime header, the rest from librforth_runtime.a */
     fprintf(compiler->output, "/* Generated by RForth compiler */\n");
-    fprintf(compiler->output, "#include <stdio.h>\n");
-    fprintf(compiler->output, "#include <stdlib.h>\n");
-    fprintf(compiler->output, "#include <stdint.h>\n");
-    fprintf(compiler->output, "#include <string.h>\n");
-    fprintf(compiler->output, "#include <math.h>\n\n");
-    
-    fprintf(compiler->output, "#define DEFAULT_STACK_SIZE %d\n", DEFAULT_STACK_SIZE);
-    fprintf(compiler->output, "#define RETURN_STACK_SIZE %d\n\n", DEFAULT_STACK_SIZE);
-    
-    /* Runtime declarations */
-    fprintf(compiler->output, "/* Runtime stacks */\n");
-    fprintf(compiler->output, "static int64_t stack[DEFAULT_STACK_SIZE];\n");
-    fprintf(compiler->output, "static int64_t return_stack[RETURN_STACK_SIZE];\n");
-    fprintf(compiler->output, "static int sp = -1;\n");
-    fprintf(compiler->output, "static int rsp = -1;\n");
-    fprintf(compiler->output, "static int64_t *variables[1000];\n");
-    fprintf(compiler->output, "static int var_count = 0;\n");
-    fprintf(compiler->output, "static char input_buffer[1024];\n");
-    fprintf(compiler->output, "static int input_pos = 0;\n\n");
-    
-    /* Basic stack operations */
-    fprintf(compiler->output, "static void push(int64_t value) {\n");
-    fprintf(compiler->output, "    if (sp < DEFAULT_STACK_SIZE - 1) stack[++sp] = value;\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static int64_t pop(void) {\n");
-    fprintf(compiler->output, "    return (sp >= 0) ? stack[sp--] : 0;\n");
-    fprintf(compiler->output, "}\n\n");
+    fprintf(compiler->output, "#include \"rforth_runtime.h\"\n\n");
     
-    fprintf(compiler->output, "static void rpush(int64_t value) {\n");
-    fprintf(compiler->output, "    if (rsp < RETURN_STACK_SIZE - 1) return_stack[++rsp] = value;\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static int64_t rpop(void) {\n");
-    fprintf(compiler->output, "    return (rsp >= 0) ? return_stack[rsp--] : 0;\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    /* I/O Operations */
-    fprintf(compiler->output, "static void forth_dot(void) {\n");
-    fprintf(compiler->output, "    printf(\"%%ld \", (long)pop());\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_emit(void) {\n");
-    fprintf(compiler->output, "    printf(\"%%c\", (char)pop());\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_cr(void) {\n");
-    fprintf(compiler->output, "    printf(\"\\n\");\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_space(void) {\n");
-    fprintf(compiler->output, "    printf(\" \");\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_spaces(void) {\n");
-    fprintf(compiler->output, "    int64_t n = pop();\n");
-    fprintf(compiler->output, "    for(int i = 0; i < n; i++) printf(\" \");\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    /* Stack Operations */
-    fprintf(compiler->output, "static void forth_dup(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 0) push(stack[sp]);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_drop(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 0) sp--;\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_swap(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 1) { int64_t tmp = stack[sp]; stack[sp] = stack[sp-1]; stack[sp-1] = tmp; }\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_over(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 1) push(stack[sp-1]);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_rot(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 2) {\n");
-    fprintf(compiler->output, "        int64_t c = pop(), b = pop(), a = pop();\n");
-    fprintf(compiler->output, "        push(b); push(c); push(a);\n");
-    fprintf(compiler->output, "    }\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_2dup(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 1) { push(stack[sp-1]); push(stack[sp-1]); }\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_2drop(void) {\n");
-    fprintf(compiler->output, "    if (sp >= 0) sp--; if (sp >= 0) sp--;\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    /* Return Stack Operations */
-    fprintf(compiler->output, "static void forth_to_r(void) {\n");
-    fprintf(compiler->output, "    rpush(pop());\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_r_from(void) {\n");
-    fprintf(compiler->output, "    push(rpop());\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_r_fetch(void) {\n");
-    fprintf(compiler->output, "    if (rsp >= 0) push(return_stack[rsp]);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    /* Arithmetic Operations */
-    fprintf(compiler->output, "static void forth_add(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a + b);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_sub(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a - b);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_mul(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a * b);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_div(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); if(b) push(a / b);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_mod(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); if(b) push(a %% b);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_abs(void) {\n");
-    fprintf(compiler->output, "    int64_t a = pop(); push(a < 0 ? -a : a);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_negate(void) {\n");
-    fprintf(compiler->output, "    push(-pop());\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    /* Comparison Operations */
-    fprintf(compiler->output, "static void forth_equals(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a == b ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_not_equals(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a != b ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_less_than(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a < b ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
-    
-    fprintf(compiler->output, "static void forth_greater_than(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a > b ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
+    return true;
+}
+
+bool compiler_add_word(compiler_ctx_t *compiler, const char *name, const char *definition, size_t length) {
+    if (!compiler || !name || !definition) return false;
+    
+    if (compiler->word_count == compiler->word_capacity) {
+        int capacity = compiler->word_capacity ? compiler->word_capacity * 2 : 32;
+        compiled_word_t *words = realloc(compiler->words, sizeof(compiled_word_t) * capacity);
+        if (!words) return false;
+        compiler->words = words;
+        compiler->word_capacity = capacity;
+    }
     
-    fprintf(compiler->output, "static void forth_zero_equals(void) {\n");
-    fprintf(compiler->output, "    push(pop() == 0 ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
+    compiled_word_t *word = &compiler->words[compiler->word_count];
+    memset(word, 0, sizeof(*word));
+    lower_case_name(name, word->name, sizeof(word->name));
+    word->definition = malloc(length + 1);
+    if (!word->definition) return false;
+    memcpy(word->definition, definition, length);
+    word->definition[length] = '\0';
     
-    fprintf(compiler->output, "static void forth_zero_less(void) {\n");
-    fprintf(compiler->output, "    push(pop() < 0 ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
+    compiler->word_count++;
+    return true;
+}
+
+compiled_data_t* compiler_add_data(compiler_ctx_t *compiler, const char *name, data_kind_t kind) {
+    if (!compiler || !name) return NULL;
+    
+    if (compiler->data_count == compiler->data_capacity) {
+        int capacity = compiler->data_capacity ? compiler->data_capacity * 2 : 32;
+        compiled_data_t *data = realloc(compiler->data, sizeof(compiled_data_t) * capacity);
+        if (!data) return NULL;
+        compiler->data = data;
+        compiler->data_capacity = capacity;
+    }
     
-    fprintf(compiler->output, "static void forth_zero_greater(void) {\n");
-    fprintf(compiler->output, "    push(pop() > 0 ? -1 : 0);\n");
-    fprintf(compiler->output, "}\n\n");
+    compiled_data_t *data = &compiler->data[compiler->data_count++];
+    memset(data, 0, sizeof(*data));
+    lower_case_name(name, data->name, sizeof(data->name));
+    data->kind = kind;
+    data->words_before = compiler->word_count;
+    data->size = kind == DATA_CELLS ? 0 : 1;
+    return data;
+}
+
+/* Static storage for the variables, constants and CREATE regions */
+bool compiler_generate_data(compiler_ctx_t *compiler) {
+    if (!compiler || !compiler->output) return false;
+    if (compiler->data_count > 0) {
+        fprintf(compiler->output, "/* Data space */\n");
+    }
     
-    /* Logical Operations */
-    fprintf(compiler->output, "static void forth_and(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a & b);\n");
-    fprintf(compiler->output, "}\n\n");
+    for (int i = 0; i < compiler->data_count; i++) {
+        const compiled_data_t *data = &compiler->data[i];
+        char c_name[MAX_WORD_LENGTH + 16];
+        data_identifier(compiler, data, c_name, sizeof(c_name));
+        
+        switch (data->kind) {
+            case DATA_CELLS:
+                /* Zero-length arrays are not C: an empty CREATE still gets a cell */
+                fprintf(compiler->output, "static int64_t %s[%lld]", c_name,
+                        (long long)(data->size > 0 ? data->size : 1));
+                for (int64_t n = 0; n < data->cell_count; n++) {
+                    fprintf(compiler->output, n ? ", %lld" : " = {%lld", (long long)data->cells[n]);
+                }
+                fprintf(compiler->output, data->cell_count ? "}; /* %s */\n" : "; /* %s */\n", data->name);
+                break;
+            case DATA_FLOATS:
+                fprintf(compiler->output, "static double %s[1]; /* %s */\n", c_name, data->name);
+                break;
+            case DATA_CONSTANT:
+                if (data->literal) {
+                    fprintf(compiler->output, "static const int64_t %s = %lld; /* %s */\n",
+                            c_name, (long long)data->value, data->name);
+                } else {
+                    fprintf(compiler->output, "static int64_t %s; /* %s */\n", c_name, data->name);
+                }
+                break;
+            case DATA_FCONSTANT:
+                if (data->literal) {
+                    char literal[MAX_VALUE_LENGTH];
+                    format_double(data->float_value, literal, sizeof(literal));
+                    fprintf(compiler->output, "static const double %s = %s; /* %s */\n",
+                            c_name, literal, data->name);
+                } else {
+                    fprintf(compiler->output, "static double %s; /* %s */\n", c_name, data->name);
+                }
+                break;
+        }
+    }
+    if (compiler->data_count > 0) {
+        fprintf(compiler->output, "\n");
+    }
+    return true;
+}
+
+/* Cells taken by a word where control flow splits or joins, or -1 for any other word */
+static int control_word_inputs(const char *word_name) {
+    static const struct { const char *name; int inputs; } words[] = {
+        {"if", 1}, {"else", 0}, {"then", 0}, {"begin", 0}, {"until", 1}, {"while", 1},
+        {"repeat", 0}, {"again", 0}, {"do", 2}, {"loop", 0}, {"+loop", 1}, {"leave", 0},
+        {"exit", 0}
+    };
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        if (strcmp(word_name, words[i].name) == 0) return words[i].inputs;
+    }
+    return -1;
+}
+
+/* An open control structure during effect inference */
+typedef struct {
+    char kind;                  /* 'i' IF, 'b' BEGIN, 'd' DO */
+    int depth;                  /* Depth every path must rejoin at */
+    bool split;                 /* IF with ELSE, or BEGIN with WHILE */
+    int split_depth;            /* Depth at the ELSE, or after the WHILE */
+    bool split_dead;            /* The part before ELSE ended in EXIT or LEAVE */
+} effect_frame_t;
+
+/*
+ * Walk a definition keeping the stack depth relative to entry. The effect
+ * is fixed when every path through each control structure leaves the same
+ * depth and every word called has a fixed effect itself. Code after EXIT
+ * or LEAVE is dead until the next THEN, ELSE or loop end, and does not
+ * constrain the depth there.
+ */
+static bool infer_effect(compiler_ctx_t *compiler, compiled_word_t *word) {
+    effect_frame_t frames[64];
+    int frame_count = 0;
+    int depth = 0, lowest = 0, highest = 0;
+    int join_highest = 0;       /* Deepest stack where control flow joins */
+    int exit_depth = 0;
+    bool exits = false, joins = false, dead = false;
+    bool fixed = true;
     
-    fprintf(compiler->output, "static void forth_or(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a | b);\n");
-    fprintf(compiler->output, "}\n\n");
+    parser_t *parser = parser_create();
+    if (!parser) return false;
+    parser_set_input(parser, word->definition);
     
-    fprintf(compiler->output, "static void forth_xor(void) {\n");
-    fprintf(compiler->output, "    int64_t b = pop(), a = pop(); push(a ^ b);\n");
-    fprintf(compiler->output, "}\n\n");
+    token_t token;
+    while (fixed && (token = parser_next_token(parser)).type != TOKEN_EOF) {
+        if (token.type == TOKEN_NUMBER || token.type == TOKEN_FLOAT) {
+            if (!dead && ++depth > highest) highest = depth;
+            continue;
+        }
+        if (token.type != TOKEN_WORD) continue;
+        
+        char word_name[MAX_WORD_LENGTH];
+        token_word_name(&token, word_name, sizeof(word_name));
+        effect_frame_t *top = frame_count > 0 ? &frames[frame_count - 1] : NULL;
+        int taken = 0, left = 0;
+        int control_inputs = control_word_inputs(word_name);
+        if (!dead && control_inputs >= 0) {
+            if (!joins || depth - control_inputs > join_highest) join_highest = depth - control_inputs;
+            joins = true;
+        }
+        
+        if (builtin_effect(word_name, &taken, &left)) {
+            /* Applied below */
+        } else if (strcmp(word_name, "if") == 0 || strcmp(word_name, "begin") == 0 ||
+                   strcmp(word_name, "do") == 0) {
+            if (frame_count == 64 || dead) {
+                fixed = false;
+                break;
+            }
+            taken = word_name[0] == 'i' ? 1 : word_name[0] == 'd' ? 2 : 0;
+            depth -= taken;
+            if (depth < lowest) lowest = depth;
+            frames[frame_count].kind = word_name[0];
+            frames[frame_count].depth = depth;
+            frames[frame_count].split = false;
+            frame_count++;
+            continue;
+        } else if (strcmp(word_name, "else") == 0) {
+            fixed = top && top->kind == 'i' && !top->split;
+            if (fixed) {
+                top->split = true;
+                top->split_depth = depth;
+                top->split_dead = dead;
+                depth = top->depth;
+                dead = false;
+            }
+            continue;
+        } else if (strcmp(word_name, "then") == 0) {
+            fixed = top && top->kind == 'i';
+            if (fixed) {
+                bool other_dead = top->split && top->split_dead;
+                int other_depth = top->split ? top->split_depth : top->depth;
+                if (dead && !other_dead) {
+                    depth = other_depth;
+                } else if (!dead && !other_dead) {
+                    fixed = depth == other_depth;
+                }
+                dead = dead && other_dead;
+                frame_count--;
+            }
+            continue;
+        } else if (strcmp(word_name, "while") == 0) {
+            depth--;
+            if (depth < lowest) lowest = depth;
+            fixed = top && top->kind == 'b' && !top->split && !dead;
+            if (fixed) {
+                top->split = true;
+                top->split_depth = depth;
+            }
+            continue;
+        } else if (strcmp(word_name, "until") == 0 || strcmp(word_name, "repeat") == 0 ||
+                   strcmp(word_name, "again") == 0 || strcmp(word_name, "loop") == 0 ||
+                   strcmp(word_name, "+loop") == 0) {
+            /* The loop is left with the depth at its head, or at its WHILE */
+            char kind = strstr(word_name, "loop") ? 'd' : 'b';
+            if (word_name[0] == 'u' || word_name[0] == '+') depth--;
+            if (depth < lowest) lowest = depth;
+            fixed = top && top->kind == kind && (dead || depth == top->depth) &&
+                    (word_name[0] == 'r') == (kind == 'b' && top->split);
+            if (fixed) {
+                depth = top->split ? top->split_depth : top->depth;
+                dead = false;
+                frame_count--;
+            }
+            continue;
+        } else if (strcmp(word_name, "i") == 0 || strcmp(word_name, "j") == 0) {
+            left = 1;
+        } else if (strcmp(word_name, "leave") == 0) {
+            /* Leaves the loop with the depth its end would have */
+            int n = frame_count - 1;
+            while (n >= 0 && frames[n].kind != 'd') n--;
+            fixed = n >= 0 && (dead || depth == frames[n].depth);
+            dead = true;
+            continue;
+        } else if (strcmp(word_name, "exit") == 0) {
+            if (!dead) {
+                fixed = !exits || depth == exit_depth;
+                exits = true;
+                exit_depth = depth;
+            }
+            dead = true;
+            continue;
+        } else if (strcmp(word_name, ".\"") == 0) {
+            const char *text;
+            size_t length;
+            parse_dot_quote(parser, &text, &length);
+            continue;
+        } else if (strcmp(word_name, "unloop") == 0 || strcmp(word_name, "bye") == 0) {
+            continue;
+        } else {
+            const compiled_word_t *callee = find_word(compiler, word_name);
+            const compiled_data_t *data = find_data(compiler, word_name, callee);
+            if (data) {
+                /* An FCONSTANT leaves its value on the float stack */
+                left = data->kind == DATA_FCONSTANT ? 0 : 1;
+            } else if (!callee || !callee->fixed_effect) {
+                fixed = false;
+                break;
+            } else {
+                taken = callee->inputs;
+                left = callee->outputs;
+            }
+        }
+        
+        if (dead) continue;
+        depth -= taken;
+        if (depth < lowest) lowest = depth;
+        depth += left;
+        if (depth > highest) highest = depth;
+    }
+    parser_destroy(parser);
     
-    fprintf(compiler->output, "static void forth_invert(void) {\n");
-    fprintf(compiler->output, "    push(~pop());\n");
-    fprintf(compiler->output, "}\n\n");
+    if (!fixed || frame_count != 0) return false;
+    if (dead) {
+        depth = exit_depth;
+    } else if (exits && depth != exit_depth) {
+        return false;
+    }
+    word->inputs = -lowest;
+    word->outputs = depth - lowest;
+    word->slots = joins ? join_highest - lowest : 0;
     
-    return true;
+    /* Everything has to fit the pending cells and the argument lists */
+    return word->inputs <= MAX_WORD_PARAMETERS && word->outputs <= MAX_WORD_PARAMETERS &&
+           highest - lowest <= MAX_PENDING_VALUES;
+}
+
+void compiler_infer_effects(compiler_ctx_t *compiler) {
+    if (!compiler) return;
+    
+    /* A word can only call words defined before it, so one pass in order suffices */
+    for (int i = 0; i < compiler->word_count; i++) {
+        compiled_word_t *word = &compiler->words[i];
+        compiler->current_word = i;
+        word->fixed_effect = infer_effect(compiler, word);
+    }
+    compiler->current_word = -1;
 }
 
 bool compiler_generate_word(compiler_ctx_t *compiler, const char *name, const char *definition) {
@@ -421,8 +1328,40 @@ bool compiler_generate_word(compiler_ctx_t *compiler, const char *name, const ch
     char c_name[MAX_WORD_LENGTH];
     word_name_to_c_identifier(name, c_name, sizeof(c_name));
     
+    /* Find the collected definition, latest first like the dictionary */
+    char word_name[MAX_WORD_LENGTH];
+    lower_case_name(name, word_name, sizeof(word_name));
+    compiler->current_word = -1;
+    for (int i = compiler->word_count - 1; i >= 0; i--) {
+        if (strcmp(compiler->words[i].name, word_name) == 0) {
+            compiler->current_word = i;
+            break;
+        }
+    }
+    const compiled_word_t *word = current_signature(compiler);
+    compiler->value_depth = 0;
+    compiler->fvalue_depth = 0;
+    compiler->temp_counter = 0;
+    compiler->unreachable = false;
+    
     fprintf(compiler->output, "/* User word: %s */\n", name);
-    fprintf(compiler->output, "static void word_%s(void) {\n", c_name);
+    if (word) {
+        /* A fixed stack effect becomes a C signature; the inputs start out pending */
+        fprintf(compiler->output, "static inline %s word_%s(", word->outputs == 1 ? "int64_t" : "void", c_name);
+        for (int n = 1; n <= word->inputs; n++) {
+            char parameter[MAX_VALUE_LENGTH];
+            snprintf(parameter, sizeof(parameter), "p%d", n);
+            fprintf(compiler->output, n > 1 ? ", int64_t %s" : "int64_t %s", parameter);
+            push_value(compiler, parameter);
+        }
+        fprintf(compiler->output, word->inputs ? ") {\n" : "void) {\n");
+        for (int k = 0; k < word->slots; k++) {
+            fprintf(compiler->output, k ? ", s%d" : "    int64_t s%d", k);
+            if (k == word->slots - 1) fprintf(compiler->output, ";\n");
+        }
+    } else {
+        fprintf(compiler->output, "static void word_%s(void) {\n", c_name);
+    }
     
     /* Parse and compile the definition */
     parser_t *parser = parser_create();
@@ -431,25 +1370,19 @@ bool compiler_generate_word(compiler_ctx_t *compiler, const char *name, const ch
     parser_set_input(parser, definition);
     
     token_t token;
-    while ((token = parser_next_token(parser)).type != TOKEN_EOF) {
-        switch (token.type) {
-            case TOKEN_NUMBER:
-                fprintf(compiler->output, "    push(%ld);\n", (long)token.value.number);
-                break;
-                
-            case TOKEN_WORD:
-                generate_word_call(compiler, token.text);
-                break;
-                
-            default:
-                /* Skip other tokens */
-                break;
-        }
+    while (!compiler->failed && (token = parser_next_token(parser)).type != TOKEN_EOF) {
+        generate_token(compiler, parser, &token);
     }
     
+    if (word && word->outputs == 1) {
+        generate_return(compiler);
+    } else {
+        flush_values(compiler);
+    }
     fprintf(compiler->output, "}\n\n");
+    compiler->current_word = -1;
     parser_destroy(parser);
-    return true;
+    return !compiler->failed;
 }
 
 bool compiler_generate_main(compiler_ctx_t *compiler, const char *main_code) {
@@ -457,6 +1390,12 @@ bool compiler_generate_main(compiler_ctx_t *compiler, const char *main_code) {
     
     fprintf(compiler->output, "int main(int argc, char *argv[]) {\n");
     fprintf(compiler->output, "    (void)argc; (void)argv;\n\n");
+    compiler->in_main = true;
+    compiler->next_data = 0;
+    compiler->value_depth = 0;
+    compiler->fvalue_depth = 0;
+    compiler->temp_counter = 0;
+    compiler->unreachable = false;
     
     /* Parse and compile the main code */
     parser_t *parser = parser_create();
@@ -465,65 +1404,25 @@ bool compiler_generate_main(compiler_ctx_t *compiler, const char *main_code) {
     parser_set_input(parser, main_code);
     
     token_t token;
-    while ((token = parser_next_token(parser)).type != TOKEN_EOF) {
-        switch (token.type) {
-            case TOKEN_NUMBER:
-                fprintf(compiler->output, "    push(%ld);\n", (long)token.value.number);
-                break;
-                
-            case TOKEN_WORD:
-                /* Handle special words that expect strings */
-                if (strcmp(token.text, ".\"") == 0) {
-                    /* Manually parse the string content until closing quote */
-                    const char *current = parser->current;
-                    
-                    /* Skip whitespace */
-                    while (*current && isspace(*current)) current++;
-                    
-                    if (*current) {
-                        const char *start = current;
-                        const char *end = strchr(start, '"');
-                        if (end) {
-                            /* Extract the string content */
-                            size_t len = end - start;
-                            char string_content[1024];
-                            if (len < sizeof(string_content) - 1) {
-                                strncpy(string_content, start, len);
-                                string_content[len] = '\0';
-                                fprintf(compiler->output, "    printf(\"%s\");\n", string_content);
-                                
-                                /* Advance parser past the closing quote */
-                                parser->current = end + 1;
-                            }
-                        }
-                    }
-                } else {
-                    generate_word_call(compiler, token.text);
-                }
-                break;
-                
-            case TOKEN_STRING:
-                /* Handle standalone string literals */
-                fprintf(compiler->output, "    printf(\"%s\");\n", token.text);
-                break;
-                
-            default:
-                /* Skip other tokens */
-                break;
-        }
+    while (!compiler->failed && (token = parser_next_token(parser)).type != TOKEN_EOF) {
+        generate_token(compiler, parser, &token);
     }
     
     /* Close any remaining open control structures */
+    flush_values(compiler);
+    while (compiler->loop_depth > 0) {
+        close_loop(compiler, "break;");
+    }
     while (compiler->if_depth > 0) {
         int label = compiler->if_stack[--compiler->if_depth];
-        fprintf(compiler->output, "endif_%d:\n", label);
+        fprintf(compiler->output, "endif_%d: ;\n", label);
     }
     
     fprintf(compiler->output, "\n    return 0;\n");
     fprintf(compiler->output, "}\n");
     
     parser_destroy(parser);
-    return true;
+    return !compiler->failed;
 }
 
 bool compiler_generate_footer(compiler_ctx_t *compiler) {
@@ -581,108 +1480,124 @@ bool compile_forth_to_c(const char *input_file, const char *output_file) {
     
     parser_set_input(parser, content);
     
-    /* First pass: collect word definitions */
-    token_t token;
-    while ((token = parser_next_token(parser)).type != TOKEN_EOF) {
+    /*
+     * Collect the colon definitions as source text, and lay out what the
+     * defining words outside them create. Main is what is left with the
+     * definitions blanked out.
+     */
+    char *main_code = malloc(read_size + 1);
+    if (!main_code) {
+        parser_destroy(parser);
+        compiler_destroy(compiler);
+        free(content);
+        return false;
+    }
+    memcpy(main_code, content, read_size + 1);
+    
+    bool collected = true;
+    token_t token, previous = {0};
+    while (collected && (token = parser_next_token(parser)).type != TOKEN_EOF) {
+        char word_name[MAX_WORD_LENGTH] = "";
+        if (token.type == TOKEN_WORD) {
+            token_word_name(&token, word_name, sizeof(word_name));
+        }
+        
         if (token.type == TOKEN_COLON) {
             /* Word definition */
             token_t name_token = parser_next_token(parser);
             if (name_token.type != TOKEN_WORD) {
                 fprintf(stderr, "Error: Expected word name after ':'\n");
-                parser_destroy(parser);
-                compiler_destroy(compiler);
-                free(content);
-                return false;
+                collected = false;
+                break;
             }
             
-            /* Collect definition until semicolon */
-            char definition[MAX_DEFINITION_LENGTH] = "";
-            int def_pos = 0;
-            
-            while ((token = parser_next_token(parser)).type != TOKEN_EOF) {
-                if (token.type == TOKEN_SEMICOLON) {
+            /* The body runs up to the semicolon; a ." string may hold one */
+            const char *body = parser->current;
+            const char *body_end;
+            while (true) {
+                body_end = parser->current;
+                token_t body_token = parser_next_token(parser);
+                if (body_token.type == TOKEN_EOF) break;
+                if (body_token.type == TOKEN_SEMICOLON) {
+                    body_end = body_token.start;
                     break;
                 }
-                
-                /* Add token to definition */
-                if (def_pos > 0 && def_pos < (int)(sizeof(definition) - 2)) {
-                    definition[def_pos++] = ' ';
-                }
-                
-                const char *token_text = NULL;
-                char number_str[MAX_NUMBER_STRING_LENGTH];
-                
-                if (token.type == TOKEN_NUMBER) {
-                    snprintf(number_str, sizeof(number_str), "%ld", (long)token.value.number);
-                    token_text = number_str;
-                } else if (token.type == TOKEN_WORD) {
-                    token_text = token.text;
-                }
-                
-                if (token_text) {
-                    int len = (int)strlen(token_text);
-                    if (def_pos + len < (int)(sizeof(definition) - 1)) {
-                        strncpy(definition + def_pos, token_text, len);
-                        def_pos += len;
-                        definition[def_pos] = '\0';
-                    }
+                if (body_token.type == TOKEN_WORD && body_token.symbol == SYM_DOT_QUOTE) {
+                    const char *text;
+                    size_t length;
+                    parse_dot_quote(parser, &text, &length);
                 }
             }
             
-            definition[def_pos] = '\0';
-            
-            /* Generate the word function */
-            if (!compiler_generate_word(compiler, name_token.text, definition)) {
-                parser_destroy(parser);
-                compiler_destroy(compiler);
-                free(content);
-                return false;
+            for (const char *c = token.start; c < parser->current; c++) {
+                if (*c != '\n') main_code[c - content] = ' ';
             }
+            char name[MAX_WORD_LENGTH];
+            parser_token_text(&name_token, name, sizeof(name));
+            collected = compiler_add_word(compiler, name, body,
+                                          (size_t)(body_end - body));
+            previous.type = TOKEN_COLON;
+            continue;
         }
-    }
-    
-    /* Second pass: collect main code (everything not in word definitions) */
-    parser_set_input(parser, content);
-    char main_code[2048] = "";
-    int main_pos = 0;
-    bool in_definition = false;
-    
-    while ((token = parser_next_token(parser)).type != TOKEN_EOF) {
-        if (token.type == TOKEN_COLON) {
-            in_definition = true;
-        } else if (token.type == TOKEN_SEMICOLON) {
-            in_definition = false;
-        } else if (!in_definition && token.type != TOKEN_COMMENT_START) {
-            /* Add to main code */
-            if (main_pos > 0 && main_pos < (int)(sizeof(main_code) - 2)) {
-                main_code[main_pos++] = ' ';
-            }
-            
-            const char *token_text = NULL;
-            char number_str[MAX_NUMBER_STRING_LENGTH];
-            
-            if (token.type == TOKEN_NUMBER) {
-                snprintf(number_str, sizeof(number_str), "%ld", (long)token.value.number);
-                token_text = number_str;
-            } else if (token.type == TOKEN_WORD) {
-                token_text = token.text;
-            }
-            
-            if (token_text) {
-                int len = (int)strlen(token_text);
-                if (main_pos + len < (int)(sizeof(main_code) - 1)) {
-                    strncpy(main_code + main_pos, token_text, len);
-                    main_pos += len;
-                    main_code[main_pos] = '\0';
+        
+        if (token.type == TOKEN_WORD && token.symbol == SYM_DOT_QUOTE) {
+            const char *text;
+            size_t length;
+            parse_dot_quote(parser, &text, &length);
+        } else if (token.type == TOKEN_WORD && defining_word_kind(word_name) >= 0) {
+            token_t name_token = parser_next_token(parser);
+            if (name_token.type == TOKEN_WORD) {
+                char name[MAX_WORD_LENGTH];
+                parser_token_text(&name_token, name, sizeof(name));
+                compiled_data_t *data = compiler_add_data(compiler, name,
+                                                          defining_word_kind(word_name));
+                collected = data != NULL;
+                if (data && data->kind == DATA_CELLS) {
+                    /* VARIABLE is CREATE with its cell already allotted */
+                    if (word_name[0] == 'v') data->size = 1;
+                    collected = scan_data_region(parser, data);
+                } else if (data && data->kind == DATA_CONSTANT) {
+                    /* A literal just before it is what the constant takes */
+                    data->literal = previous.type == TOKEN_NUMBER || previous.type == TOKEN_FLOAT;
+                    if (previous.type == TOKEN_FLOAT) {
+                        memcpy(&data->value, &previous.value.float_val, sizeof(data->value));
+                    } else {
+                        data->value = previous.value.number;
+                    }
+                } else if (data && data->kind == DATA_FCONSTANT) {
+                    data->literal = previous.type == TOKEN_FLOAT_EXP;
+                    data->float_value = previous.value.float_val;
                 }
             }
         }
+        previous = token;
     }
     
-    main_code[main_pos] = '\0';
+    if (!collected) {
+        free(main_code);
+        parser_destroy(parser);
+        compiler_destroy(compiler);
+        free(content);
+        return false;
+    }
+    
+    /* Work out which words have fixed stack effects, then generate them all */
+    compiler_infer_effects(compiler);
+    compiler_generate_data(compiler);
+    for (int i = 0; i < compiler->word_count; i++) {
+        if (!compiler_generate_word(compiler, compiler->words[i].name, compiler->words[i].definition)) {
+            free(main_code);
+            parser_destroy(parser);
+            compiler_destroy(compiler);
+            free(content);
+            return false;
+        }
+    }
     
     /* Generate main function */
-    if (!compiler_generate_main(compiler, main_code)) {
+    bool generated = compiler_generate_main(compiler, main_code);
+    free(main_code);
+    if (!generated) {
         parser_destroy(parser);
         compiler_destroy(compiler);
         free(content);
@@ -716,6 +1631,60 @@ bool compile_forth_to_c(const char *input_file, const char *output_file) {
     return compile_success;
 }
 
+/* Directory the rforth executable is installed under: prefix of prefix/bin/rforth */
+static bool executable_prefix(char *prefix, size_t size) {
+#ifdef _WIN32
+    DWORD length = GetModuleFileNameA(NULL, prefix, (DWORD)size);
+    if (length == 0 || length >= size) return false;
+    for (char *c = prefix; *c; c++) {
+        if (*c == '\\') *c = '/';
+    }
+#else
+    ssize_t length = readlink("/proc/self/exe", prefix, size - 1);
+    if (length <= 0) return false;
+    prefix[length] = '\0';
+#endif
+    for (int part = 0; part < 2; part++) {
+        char *slash = strrchr(prefix, '/');
+        if (!slash) return false;
+        *slash = '\0';
+    }
+    return true;
+}
+
+/*
+ * Directory holding a runtime file for generated programs. The variable
+ * env overrides; otherwise the first of subdirs under the executable's
+ * prefix that has the file, so an installed or moved rforth finds its
+ * own runtime; otherwise the build tree rforth was configured in.
+ */
+static void runtime_dir(char *dir, size_t size, const char *env, const char *const *subdirs,
+                        const char *file, const char *fallback) {
+    const char *override = getenv(env);
+    if (override && *override) {
+        snprintf(dir, size, "%s", override);
+        return;
+    }
+    
+    char prefix[MAX_PATH_LENGTH];
+    if (executable_prefix(prefix, sizeof(prefix))) {
+        for (int i = 0; subdirs[i]; i++) {
+            char path[MAX_PATH_LENGTH];
+            int length = snprintf(dir, size, "%s/%s", prefix, subdirs[i]);
+            if (length < 0 || (size_t)length >= size) break;
+            length = snprintf(path, sizeof(path), "%s/%s", dir, file);
+            if (length < 0 || (size_t)length >= sizeof(path)) break;
+            
+            FILE *probe = fopen(path, "rb");
+            if (probe) {
+                fclose(probe);
+                return;
+            }
+        }
+    }
+    snprintf(dir, size, "%s", fallback);
+}
+
 bool invoke_c_compiler(const char *c_file, const char *output_file) {
     if (!c_file || !output_file) return false;
     
@@ -728,6 +1697,13 @@ bool invoke_c_compiler(const char *c_file, const char *output_file) {
         return false;
     }
     
+    /* Installs keep the header in include/rforth; the source tree has it in include */
+    static const char *const include_subdirs[] = {"include/rforth", "include", NULL};
+    static const char *const library_subdirs[] = {"lib", NULL};
+    char include_dir[MAX_PATH_LENGTH], library_dir[MAX_PATH_LENGTH];
+    runtime_dir(include_dir, sizeof(include_dir), "RFORTH_INCLUDE_DIR", include_subdirs,
+                "rforth_runtime.h", RFORTH_INCLUDE_DIR);
+    
 #ifdef _WIN32
     /* Windows process creation */
     char *args[] = {
@@ -740,9 +1716,11 @@ bool invoke_c_compiler(const char *c_file, const char *output_file) {
     };
     
     /* Build command string for Windows */
-    char command[1024];
-    snprintf(command, sizeof(command), "cl.exe /O2 /Fe:\"%s\" \"%s\"", 
-             output_file, c_file);
+    runtime_dir(library_dir, sizeof(library_dir), "RFORTH_LIBRARY_DIR", library_subdirs,
+                "rforth_runtime.lib", RFORTH_LIBRARY_DIR);
+    char command[3 * MAX_PATH_LENGTH];
+    snprintf(command, sizeof(command), "cl.exe /O2 /I\"%s\" /Fe:\"%s\" \"%s\" \"%s\\rforth_runtime.lib\"",
+             include_dir, output_file, c_file, library_dir);
     
     int result = system(command);
     if (result == 0) {
@@ -752,6 +1730,12 @@ bool invoke_c_compiler(const char *c_file, const char *output_file) {
         return false;
     }
 #else
+    runtime_dir(library_dir, sizeof(library_dir), "RFORTH_LIBRARY_DIR", library_subdirs,
+                "librforth_runtime.a", RFORTH_LIBRARY_DIR);
+    char include_flag[MAX_PATH_LENGTH + 2], library_flag[MAX_PATH_LENGTH + 2];
+    snprintf(include_flag, sizeof(include_flag), "-I%s", include_dir);
+    snprintf(library_flag, sizeof(library_flag), "-L%s", library_dir);
+    
     /* Unix fork and exec gcc safely */
     pid_t pid = fork();
     if (pid == -1) {
@@ -761,12 +1745,17 @@ bool invoke_c_compiler(const char *c_file, const char *output_file) {
     
     if (pid == 0) {
         /* Child process - exec gcc */
+        /* The program includes rforth_runtime.h and links librforth_runtime.a */
         char *args[] = {
             "gcc",
             "-O2",
+            include_flag,
             "-o",
             (char*)output_file,
             (char*)c_file,
+            library_flag,
+            "-lrforth_runtime",
+            "-lm",
             NULL
         };
         
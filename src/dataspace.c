@@ -0,0 +1,77 @@
+#include "dataspace.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#define DATASPACE_MMAP 1
+#endif
+
+static size_t round_up(size_t n, size_t alignment) {
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+bool dataspace_init(dataspace_t *space, size_t limit) {
+    memset(space, 0, sizeof(*space));
+    limit = round_up(limit, DATA_SPACE_COMMIT);
+
+#ifdef DATASPACE_MMAP
+    /* Reserve address space only; pages are committed by dataspace_allot */
+    void *region = mmap(NULL, limit, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return false;
+    space->base = region;
+#else
+    /* No reservation available: take the whole limit up front */
+    void *region = malloc(limit + DATA_SPACE_ALIGN);
+    if (!region) return false;
+    space->block = region;
+    space->base = (unsigned char*)round_up((size_t)(uintptr_t)region, DATA_SPACE_ALIGN);
+    space->committed = limit;
+#endif
+
+    space->limit = limit;
+    return true;
+}
+
+void dataspace_release(dataspace_t *space) {
+    if (!space->base) return;
+
+#ifdef DATASPACE_MMAP
+    munmap(space->base, space->limit);
+#else
+    free(space->block);
+#endif
+    memset(space, 0, sizeof(*space));
+}
+
+static bool dataspace_commit(dataspace_t *space, size_t size) {
+    if (size <= space->committed) return true;
+    if (size > space->limit) return false;
+
+#ifdef DATASPACE_MMAP
+    size_t target = round_up(size, DATA_SPACE_COMMIT);
+    if (mprotect(space->base + space->committed, target - space->committed, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+    space->committed = target;
+#endif
+    return true;
+}
+
+bool dataspace_allot(dataspace_t *space, int64_t n) {
+    if (n < 0 && (uint64_t)-n > space->here) return false;
+    if (n > 0 && (uint64_t)n > space->limit - space->here) return false;
+
+    size_t here = (size_t)((int64_t)space->here + n);
+    if (!dataspace_commit(space, here)) return false;
+
+    space->here = here;
+    return true;
+}
+
+bool dataspace_align(dataspace_t *space, size_t alignment) {
+    size_t aligned = round_up(space->here, alignment);
+    return dataspace_allot(space, (int64_t)(aligned - space->here));
+}
@@ -1,49 +1,114 @@
 #include "dict.h"
 #include "rforth.h"
+#include "vm.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* Marks a bucket whose word was forgotten; probing continues past it */
+static word_t dict_tombstone;
+#define TOMBSTONE (&dict_tombstone)
+
 dict_t* dict_create(void) {
     dict_t *dict = malloc(sizeof(dict_t));
     if (!dict) return NULL;
     
+    dict->capacity = INITIAL_DICT_CAPACITY;
+    dict->buckets = calloc(dict->capacity, sizeof(word_t*));
+    if (!dict->buckets) {
+        free(dict);
+        return NULL;
+    }
+    
     dict->latest = NULL;
     dict->count = 0;
+    dict->used = 0;
+    dict->slots = NULL;
+    dict->generation = 1;
+    dict->forgotten = NULL;
     return dict;
 }
 
+static void word_free(word_t *word) {
+    /* Free definition string and compiled body for user words */
+    if (word->type == WORD_USER && word->code.definition) {
+        free(word->code.definition);
+    }
+    vm_code_free(word->body, word->body_length);
+    free(word);
+}
+
 void dict_destroy(dict_t *dict) {
     if (!dict) return;
     
     word_t *current = dict->latest;
     while (current) {
         word_t *next = current->next;
-        
-        /* Free definition string for user words */
-        if (current->type == WORD_USER && current->code.definition) {
-            free(current->code.definition);
-        }
-        
-        free(current);
+        word_free(current);
         current = next;
     }
+    dict_reclaim(dict);
+    
+    dict_slots_t *block = dict->slots;
+    while (block) {
+        dict_slots_t *next = block->next;
+        free(block);
+        block = next;
+    }
     
+    free(dict->buckets);
     free(dict);
 }
 
+/* Bucket holding symbol, or the empty bucket ending its probe sequence */
+static word_t** dict_slot(dict_t *dict, symbol_t symbol, uint32_t hash) {
+    uint32_t mask = (uint32_t)dict->capacity - 1;
+    uint32_t i = hash & mask;
+    
+    while (dict->buckets[i]) {
+        word_t *word = dict->buckets[i];
+        if (word != TOMBSTONE && word->symbol == symbol) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return &dict->buckets[i];
+}
+
+word_t* dict_find_symbol(dict_t *dict, symbol_t symbol) {
+    if (!dict || symbol == SYMBOL_NONE) return NULL;
+    
+    return *dict_slot(dict, symbol, symbol_hash(symbol));
+}
+
 word_t* dict_find(dict_t *dict, const char *name) {
     if (!dict || !name) return NULL;
     
-    word_t *current = dict->latest;
-    while (current) {
-        if (strcmp(current->name, name) == 0) {
-            return current;
-        }
-        current = current->next;
+    /* Every defined name is interned, so a name that is not cannot be found */
+    return dict_find_symbol(dict, symbol_find(name, strlen(name)));
+}
+
+/* Rebuild the index at a new size, dropping tombstones */
+static bool dict_rehash(dict_t *dict, int capacity) {
+    word_t **old = dict->buckets;
+    int old_capacity = dict->capacity;
+    
+    dict->buckets = calloc(capacity, sizeof(word_t*));
+    if (!dict->buckets) {
+        dict->buckets = old;
+        return false;
     }
+    dict->capacity = capacity;
+    dict->used = 0;
     
-    return NULL;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i] && old[i] != TOMBSTONE) {
+            *dict_slot(dict, old[i]->symbol, old[i]->hash) = old[i];
+            dict->used++;
+        }
+    }
+    free(old);
+    return true;
 }
 
 static word_t* dict_create_word(const char *name) {
@@ -56,6 +121,17 @@ static word_t* dict_create_word(const char *name) {
     
     strncpy(word->name, name, MAX_WORD_LENGTH - 1);
     word->name[MAX_WORD_LENGTH - 1] = '\0';
+    word->body = NULL;
+    word->body_length = 0;
+    word->native_code = NULL;
+    word->jit_rejected = false;
+    word->symbol = symbol_intern(word->name, strlen(word->name));
+    if (word->symbol == SYMBOL_NONE) {
+        free(word);
+        return NULL;
+    }
+    word->hash = symbol_hash(word->symbol);
+    word->shadowed = NULL;
     word->next = NULL;
     return word;
 }
@@ -63,31 +139,65 @@ static word_t* dict_create_word(const char *name) {
 static bool dict_add_word(dict_t *dict, word_t *word) {
     if (!dict || !word) return false;
     
-    /* Check if word already exists and remove it to prevent memory leak */
-    word_t *existing = dict_find(dict, word->name);
-    if (existing) {
-        /* Remove old word from dictionary */
-        word_t **current = &dict->latest;
-        while (*current) {
-            if (*current == existing) {
-                *current = existing->next;
-                if (existing->type == WORD_USER && existing->code.definition) {
-                    free(existing->code.definition);
-                }
-                free(existing);
-                dict->count--;
-                break;
-            }
-            current = &(*current)->next;
-        }
+    /* Keep the load factor at or below one half */
+    if ((dict->used + 1) * 2 > dict->capacity &&
+        !dict_rehash(dict, dict->capacity * DICT_GROWTH_FACTOR)) {
+        return false;
+    }
+    
+    /* A redefinition shadows the old word rather than freeing it:
+     * compiled definitions may still hold pointers to it. */
+    word_t **slot = dict_slot(dict, word->symbol, word->hash);
+    if (*slot) {
+        word->shadowed = *slot;
+    } else {
+        dict->used++;
     }
+    *slot = word;
     
     word->next = dict->latest;
     dict->latest = word;
     dict->count++;
+    dict->generation++;
     return true;
 }
 
+/*
+ * Remove word and everything defined after it. A forgotten word may still
+ * be running (": x forget x ;", or FORGET inside EVALUATE), so its body is
+ * only freed by dict_reclaim. Data space and constant slots are not given
+ * back; HERE stays where it is.
+ */
+void dict_forget(dict_t *dict, word_t *word) {
+    if (!dict || !word) return;
+    
+    /* Newest first */
+    while (dict->latest) {
+        word_t *current = dict->latest;
+        bool last = (current == word);
+        word_t **slot = dict_slot(dict, current->symbol, current->hash);
+        
+        /* The newest word of a name is always the indexed one */
+        *slot = current->shadowed ? current->shadowed : TOMBSTONE;
+        dict->latest = current->next;
+        dict->count--;
+        current->next = dict->forgotten;
+        dict->forgotten = current;
+        
+        if (last) break;
+    }
+    dict->generation++;
+}
+
+/* Free forgotten words; only call when no Forth code is executing */
+void dict_reclaim(dict_t *dict) {
+    while (dict->forgotten) {
+        word_t *next = dict->forgotten->next;
+        word_free(dict->forgotten);
+        dict->forgotten = next;
+    }
+}
+
 bool dict_add_builtin(dict_t *dict, const char *name, void (*func)(rforth_ctx_t *ctx)) {
     if (!dict || !name || !func) return false;
     
@@ -100,8 +210,9 @@ bool dict_add_builtin(dict_t *dict, const char *name, void (*func)(rforth_ctx_t
     return dict_add_word(dict, word);
 }
 
-bool dict_add_user_word(dict_t *dict, const char *name, const char *definition) {
-    if (!dict || !name || !definition) return false;
+bool dict_add_user_word(dict_t *dict, const char *name, const char *definition,
+                        struct instr *body, int body_length) {
+    if (!dict || !name || !definition || !body) return false;
     
     word_t *word = dict_create_word(name);
     if (!word) return false;
@@ -117,10 +228,24 @@ bool dict_add_user_word(dict_t *dict, const char *name, const char *definition)
     word->code.definition[def_len] = '\0';
     
     word->type = WORD_USER;
+    word->body = body;
+    word->body_length = body_length;
     
     return dict_add_word(dict, word);
 }
 
+/* Allocate a constant slot; slots of consecutive constants are adjacent */
+static cell_t* dict_alloc_slot(dict_t *dict) {
+    if (!dict->slots || dict->slots->used == DICT_SLOT_BLOCK) {
+        dict_slots_t *block = malloc(sizeof(dict_slots_t));
+        if (!block) return NULL;
+        block->used = 0;
+        block->next = dict->slots;
+        dict->slots = block;
+    }
+    return &dict->slots->cells[dict->slots->used++];
+}
+
 bool dict_add_constant(dict_t *dict, const char *name, cell_t value) {
     if (!dict || !name) return false;
     
@@ -128,19 +253,31 @@ bool dict_add_constant(dict_t *dict, const char *name, cell_t value) {
     if (!word) return false;
     
     word->type = WORD_CONSTANT;
-    word->code.value = value;
+    word->code.slot = dict_alloc_slot(dict);
+    if (!word->code.slot) {
+        free(word);
+        return false;
+    }
+    *word->code.slot = value;
     
     return dict_add_word(dict, word);
 }
 
-bool dict_add_variable(dict_t *dict, const char *name, cell_t initial_value) {
-    if (!dict || !name) return false;
+bool dict_add_fconstant(dict_t *dict, const char *name, double value) {
+    if (!dict_add_constant(dict, name, cell_make_float(value))) return false;
+    dict->latest->type = WORD_FCONSTANT;
+    return true;
+}
+
+bool dict_add_variable(dict_t *dict, const char *name, cell_t *slot) {
+    if (!dict || !name || !slot) return false;
     
     word_t *word = dict_create_word(name);
     if (!word) return false;
     
+    /* The data lives in data space; the word only knows its address */
     word->type = WORD_VARIABLE;
-    word->code.value = initial_value;
+    word->code.slot = slot;
     
     return dict_add_word(dict, word);
 }
@@ -162,17 +299,20 @@ void dict_print(dict_t *dict) {
             case WORD_IMMEDIATE: type_str = "immediate"; break;
             case WORD_CONSTANT: type_str = "constant"; break;
             case WORD_VARIABLE: type_str = "variable"; break;
+            case WORD_FCONSTANT: type_str = "fconstant"; break;
             default: type_str = "unknown"; break;
         }
         
         printf("  %-20s (%s)", current->name, type_str);
         
-        if (current->type == WORD_CONSTANT || current->type == WORD_VARIABLE) {
-            if (current->code.value.type == CELL_INT) {
-                printf(" = %ld", (long)current->code.value.value.i);
+        if (current->type == WORD_CONSTANT) {
+            if (CELL_TYPE(*current->code.slot) == CELL_INT) {
+                printf(" = %ld", (long)current->code.slot->value.i);
             } else {
-                printf(" = %.6g", current->code.value.value.f);
+                printf(" = %.6g", current->code.slot->value.f);
             }
+        } else if (current->type == WORD_FCONSTANT) {
+            printf(" = %.6g", current->code.slot->value.f);
         } else if (current->type == WORD_USER) {
             printf(" : %s", current->code.definition ? current->code.definition : "<null>");
         }
@@ -193,47 +333,24 @@ void word_execute(rforth_ctx_t *ctx, word_t *word) {
             break;
             
         case WORD_USER:
-            if (word->code.definition) {
-                /* Execute user-defined word by interpreting its definition */
-                /* Save current parser state */
-                parser_t *saved_parser = ctx->parser;
-                parse_state_t saved_state = ctx->state;
-                
-                /* Create temporary parser for user word execution */
-                ctx->parser = parser_create();
-                if (!ctx->parser) {
-                    RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to create parser for word execution");
-                    ctx->parser = saved_parser;
-                    return;
-                }
-                
-                ctx->state = PARSE_INTERPRET;
-                int result = rforth_interpret_string(ctx, word->code.definition);
-                
-                /* Restore parser state */
-                parser_destroy(ctx->parser);
-                ctx->parser = saved_parser;
-                ctx->state = saved_state;
-                
-                if (result != 0) {
-                    /* Error occurred during user word execution */
-                    if (ctx->last_error.code == RFORTH_OK) {
-                        /* Set a generic error if none was set */
-                        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_EXECUTION_ERROR, "Error executing user word");
-                    }
-                }
-            }
+            /* Run the compiled body directly */
+            vm_execute(ctx, word);
             break;
             
         case WORD_CONSTANT:
             /* Push constant value onto stack */
-            stack_push_cell(ctx->data_stack, word->code.value);
+            stack_push_cell(ctx->data_stack, *word->code.slot);
+            break;
+            
+        case WORD_FCONSTANT:
+            if (!fstack_push(ctx->float_stack, word->code.slot->value.f)) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Float stack overflow");
+            }
             break;
             
         case WORD_VARIABLE:
             /* Push variable address onto stack */
-            /* The address of the value field in the word structure */
-            uintptr_t addr = (uintptr_t)&word->code.value;
+            uintptr_t addr = (uintptr_t)word->code.slot;
             stack_push_int(ctx->data_stack, (int64_t)addr);
             break;
             
@@ -0,0 +1,195 @@
+#include "evalcache.h"
+#include "vm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* One interpreted string and the code it compiled to */
+typedef struct {
+    char *text;                 /* Copy of the string, NULL when the entry is free */
+    size_t length;
+    uint32_t hash;
+    uint32_t generation;        /* Dictionary generation it was compiled in */
+    bool compiled;              /* False: the string needs the outer interpreter */
+    int running;                /* Executions in progress; the entry is kept until they end */
+    word_t code;                /* Anonymous word holding the threaded code */
+} eval_entry_t;
+
+struct eval_cache {
+    eval_entry_t entries[EVAL_CACHE_SIZE];  /* Direct-mapped by hash */
+    uint64_t hits;
+    uint64_t misses;
+};
+
+/*
+ * Words whose interpretation is not a call of their compiled form: they
+ * parse the input themselves, leave pointers into it, or only mean
+ * something inside a definition.
+ */
+static bool interpret_only(symbol_t symbol) {
+    switch (symbol) {
+        case SYM_LEFT_BRACKET: case SYM_RIGHT_BRACKET: case SYM_EXIT: case SYM_RECURSE:
+        case SYM_LITERAL: case SYM_POSTPONE: case SYM_QUIT: case SYM_S_QUOTE:
+        case SYM_VARIABLE: case SYM_CONSTANT: case SYM_CREATE: case SYM_DOES:
+        case SYM_FORGET: case SYM_FVARIABLE: case SYM_FCONSTANT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Loop parameter words compile like the interpreter runs them only inside a DO loop */
+static bool loop_word(symbol_t symbol) {
+    return symbol == SYM_I || symbol == SYM_J || symbol == SYM_UNLOOP;
+}
+
+eval_cache_t* eval_cache_create(void) {
+    return calloc(1, sizeof(eval_cache_t));
+}
+
+static void entry_clear(eval_entry_t *entry) {
+    vm_code_free(entry->code.body, entry->code.body_length);
+    free(entry->text);
+    memset(entry, 0, sizeof(*entry));
+}
+
+void eval_cache_destroy(eval_cache_t *cache) {
+    if (!cache) return;
+
+    for (int i = 0; i < EVAL_CACHE_SIZE; i++) {
+        entry_clear(&cache->entries[i]);
+    }
+    free(cache);
+}
+
+/* Would compiling this token do what interpreting it does? */
+static bool cacheable_token(rforth_ctx_t *ctx, const vm_builder_t *builder, const token_t *token) {
+    switch (token->type) {
+        case TOKEN_NUMBER:
+        case TOKEN_FLOAT:
+        case TOKEN_FLOAT_EXP:
+            return true;
+
+        case TOKEN_WORD: {
+            if (interpret_only(token->symbol)) return false;
+            if (builder->cf_sp == 0 && loop_word(token->symbol)) return false;
+
+            /* Control words compile here just as the interpreter compiles them */
+            word_t *word = dict_find_symbol(ctx->dict, token->symbol);
+            return word && word->type != WORD_IMMEDIATE;
+        }
+
+        default:
+            return false;
+    }
+}
+
+/* Compile the whole of input into entry->code; false if it has to be interpreted */
+static bool compile_entry(rforth_ctx_t *ctx, eval_entry_t *entry, const char *input) {
+    vm_builder_t *builder = vm_builder_create();
+    if (!builder) return false;
+
+    /* The string may define words that it then uses: "mk nw ." */
+    builder->late_bind = true;
+    parser_set_input(ctx->parser, input);
+
+    bool ok = true;
+    token_t token;
+    while (ok && (token = parser_next_token(ctx->parser)).type != TOKEN_EOF) {
+        ok = cacheable_token(ctx, builder, &token) && vm_compile_token(ctx, builder, &token);
+    }
+    ok = ok && vm_builder_finish(ctx, builder, &entry->code.body, &entry->code.body_length);
+    vm_builder_destroy(builder);
+
+    /* A failed attempt is reported, if at all, by the outer interpreter */
+    rforth_clear_error(ctx);
+    if (!ok) return false;
+
+    strcpy(entry->code.name, "(evaluate)");
+    entry->code.type = WORD_USER;
+    return true;
+}
+
+bool eval_cache_run(rforth_ctx_t *ctx, const char *input, int *result) {
+    eval_cache_t *cache = ctx->eval_cache;
+    if (!cache) return false;
+
+    /* FNV-1a, as for dictionary names; long strings are not worth keeping */
+    uint32_t hash = 2166136261u;
+    size_t length = 0;
+    for (; input[length]; length++) {
+        if (length == EVAL_CACHE_MAX_LENGTH) return false;
+        hash = (hash ^ (unsigned char)input[length]) * 16777619u;
+    }
+
+    eval_entry_t *entry = &cache->entries[hash & (EVAL_CACHE_SIZE - 1)];
+    bool found = entry->text && entry->hash == hash && entry->length == length &&
+                 entry->generation == ctx->dict->generation &&
+                 memcmp(entry->text, input, length) == 0;
+
+    if (!found) {
+        cache->misses++;
+        if (entry->running) return false;
+
+        entry_clear(entry);
+        entry->text = malloc(length + 1);
+        if (!entry->text) return false;
+        memcpy(entry->text, input, length + 1);
+        entry->length = length;
+        entry->hash = hash;
+        entry->generation = ctx->dict->generation;
+        entry->compiled = compile_entry(ctx, entry, input);
+    } else if (entry->compiled) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    if (!entry->compiled) return false;
+
+    /*
+     * A body that checks its depth once on entry would fail before doing
+     * anything; the interpreter runs the words up to the one that fails.
+     */
+    const instr_t *first = &entry->code.body[0];
+    rforth_stack_t *ds = ctx->data_stack;
+    if (first->op == OP_CHECK_DEPTH &&
+        (ds->sp < first->arg.depth.need - 1 ||
+         (first->arg.depth.room > 0 && ds->sp + first->arg.depth.room >= ds->size))) {
+        return false;
+    }
+
+    rforth_clear_error(ctx);
+    entry->running++;
+    vm_execute(ctx, &entry->code);
+    entry->running--;
+
+    if (ctx->last_error.code != RFORTH_OK) {
+        rforth_print_error(ctx);
+        *result = -1;
+    } else {
+        *result = 0;
+    }
+    return true;
+}
+
+void eval_cache_stats(const eval_cache_t *cache, uint64_t *hits, uint64_t *misses) {
+    *hits = cache ? cache->hits : 0;
+    *misses = cache ? cache->misses : 0;
+}
+
+void eval_cache_report(const eval_cache_t *cache) {
+    if (!cache) return;
+
+    int compiled = 0, interpreted = 0;
+    for (int i = 0; i < EVAL_CACHE_SIZE; i++) {
+        if (!cache->entries[i].text) continue;
+        if (cache->entries[i].compiled) {
+            compiled++;
+        } else {
+            interpreted++;
+        }
+    }
+    printf("Evaluate cache: %llu hits, %llu misses; %d compiled and %d interpreted strings of %d entries\n",
+           (unsigned long long)cache->hits, (unsigned long long)cache->misses,
+           compiled, interpreted, EVAL_CACHE_SIZE);
+}
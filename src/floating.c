@@ -0,0 +1,443 @@
+#include "floating.h"
+#include "rforth.h"
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#define FS      (ctx->float_stack)
+#define FTOS    (FS->data[FS->sp])
+#define FNOS    (FS->data[FS->sp - 1])
+
+/* Each word checks float stack depth once, then works on doubles in place */
+static bool fneed(rforth_ctx_t *ctx, int n, const char *word) {
+    if (FS->sp + 1 >= n) return true;
+    rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Float stack underflow",
+                     word, __FILE__, __LINE__, 0);
+    return false;
+}
+
+static bool froom(rforth_ctx_t *ctx, int n, const char *word) {
+    if (FS->sp + n < FS->size) return true;
+    rforth_set_error(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Float stack overflow",
+                     word, __FILE__, __LINE__, 0);
+    return false;
+}
+
+static bool pop_int(rforth_ctx_t *ctx, int64_t *value, const char *word) {
+    cell_t cell;
+    if (!stack_pop(ctx->data_stack, &cell)) {
+        rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Stack underflow",
+                         word, __FILE__, __LINE__, 0);
+        return false;
+    }
+    if (CELL_TYPE(cell) != CELL_INT) {
+        rforth_set_error(ctx, RFORTH_ERROR_TYPE_MISMATCH, "Integer required",
+                         word, __FILE__, __LINE__, 0);
+        return false;
+    }
+    *value = cell.value.i;
+    return true;
+}
+
+static void push_flag(rforth_ctx_t *ctx, bool flag) {
+    if (!stack_push_int(ctx->data_stack, flag ? -1 : 0)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow");
+    }
+}
+
+/* Float stack manipulation */
+
+void builtin_fdrop(rforth_ctx_t *ctx) {
+    /* FDROP ( F: r -- ) */
+    if (!fneed(ctx, 1, "FDROP")) return;
+    FS->sp--;
+}
+
+void builtin_fdup(rforth_ctx_t *ctx) {
+    /* FDUP ( F: r -- r r ) */
+    if (!fneed(ctx, 1, "FDUP") || !froom(ctx, 1, "FDUP")) return;
+    FS->data[FS->sp + 1] = FTOS;
+    FS->sp++;
+}
+
+void builtin_fswap(rforth_ctx_t *ctx) {
+    /* FSWAP ( F: r1 r2 -- r2 r1 ) */
+    if (!fneed(ctx, 2, "FSWAP")) return;
+    double r = FTOS;
+    FTOS = FNOS;
+    FNOS = r;
+}
+
+void builtin_fover(rforth_ctx_t *ctx) {
+    /* FOVER ( F: r1 r2 -- r1 r2 r1 ) */
+    if (!fneed(ctx, 2, "FOVER") || !froom(ctx, 1, "FOVER")) return;
+    FS->data[FS->sp + 1] = FNOS;
+    FS->sp++;
+}
+
+void builtin_frot(rforth_ctx_t *ctx) {
+    /* FROT ( F: r1 r2 r3 -- r2 r3 r1 ) */
+    if (!fneed(ctx, 3, "FROT")) return;
+    double *r = &FS->data[FS->sp - 2];
+    double r1 = r[0];
+    r[0] = r[1];
+    r[1] = r[2];
+    r[2] = r1;
+}
+
+void builtin_fdepth(rforth_ctx_t *ctx) {
+    /* FDEPTH ( -- n ) */
+    if (!stack_push_int(ctx->data_stack, FS->sp + 1)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow");
+    }
+}
+
+/* Arithmetic */
+
+void builtin_f_plus(rforth_ctx_t *ctx) {
+    /* F+ ( F: r1 r2 -- r3 ) */
+    if (!fneed(ctx, 2, "F+")) return;
+    FNOS += FTOS;
+    FS->sp--;
+}
+
+void builtin_f_minus(rforth_ctx_t *ctx) {
+    /* F- ( F: r1 r2 -- r3 ) */
+    if (!fneed(ctx, 2, "F-")) return;
+    FNOS -= FTOS;
+    FS->sp--;
+}
+
+void builtin_f_star(rforth_ctx_t *ctx) {
+    /* F* ( F: r1 r2 -- r3 ) */
+    if (!fneed(ctx, 2, "F*")) return;
+    FNOS *= FTOS;
+    FS->sp--;
+}
+
+void builtin_f_slash(rforth_ctx_t *ctx) {
+    /* F/ ( F: r1 r2 -- r3 ) IEEE division: x/0 gives an infinity or NaN */
+    if (!fneed(ctx, 2, "F/")) return;
+    FNOS /= FTOS;
+    FS->sp--;
+}
+
+void builtin_f_star_star(rforth_ctx_t *ctx) {
+    /* F** ( F: r1 r2 -- r1^r2 ) */
+    if (!fneed(ctx, 2, "F**")) return;
+    FNOS = pow(FNOS, FTOS);
+    FS->sp--;
+}
+
+void builtin_fnegate(rforth_ctx_t *ctx) {
+    /* FNEGATE ( F: r -- -r ) */
+    if (!fneed(ctx, 1, "FNEGATE")) return;
+    FTOS = -FTOS;
+}
+
+void builtin_fabs(rforth_ctx_t *ctx) {
+    /* FABS ( F: r -- |r| ) */
+    if (!fneed(ctx, 1, "FABS")) return;
+    FTOS = fabs(FTOS);
+}
+
+void builtin_fmax(rforth_ctx_t *ctx) {
+    /* FMAX ( F: r1 r2 -- r3 ) */
+    if (!fneed(ctx, 2, "FMAX")) return;
+    FNOS = FNOS > FTOS ? FNOS : FTOS;
+    FS->sp--;
+}
+
+void builtin_fmin(rforth_ctx_t *ctx) {
+    /* FMIN ( F: r1 r2 -- r3 ) */
+    if (!fneed(ctx, 2, "FMIN")) return;
+    FNOS = FNOS < FTOS ? FNOS : FTOS;
+    FS->sp--;
+}
+
+void builtin_fsqrt(rforth_ctx_t *ctx) {
+    /* FSQRT ( F: r -- sqrt(r) ) */
+    if (!fneed(ctx, 1, "FSQRT")) return;
+    if (FTOS < 0.0) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_OPERATION, "FSQRT of negative number");
+        return;
+    }
+    FTOS = sqrt(FTOS);
+}
+
+void builtin_floor(rforth_ctx_t *ctx) {
+    /* FLOOR ( F: r1 -- r2 ) Round toward negative infinity */
+    if (!fneed(ctx, 1, "FLOOR")) return;
+    FTOS = floor(FTOS);
+}
+
+void builtin_fround(rforth_ctx_t *ctx) {
+    /* FROUND ( F: r1 -- r2 ) Round to nearest, ties to even */
+    if (!fneed(ctx, 1, "FROUND")) return;
+    FTOS = nearbyint(FTOS);
+}
+
+void builtin_ftrunc(rforth_ctx_t *ctx) {
+    /* FTRUNC ( F: r1 -- r2 ) Round toward zero */
+    if (!fneed(ctx, 1, "FTRUNC")) return;
+    FTOS = trunc(FTOS);
+}
+
+void builtin_fexp(rforth_ctx_t *ctx) {
+    /* FEXP ( F: r1 -- e^r1 ) */
+    if (!fneed(ctx, 1, "FEXP")) return;
+    FTOS = exp(FTOS);
+}
+
+void builtin_fln(rforth_ctx_t *ctx) {
+    /* FLN ( F: r1 -- ln r1 ) */
+    if (!fneed(ctx, 1, "FLN")) return;
+    FTOS = log(FTOS);
+}
+
+void builtin_flog(rforth_ctx_t *ctx) {
+    /* FLOG ( F: r1 -- log10 r1 ) */
+    if (!fneed(ctx, 1, "FLOG")) return;
+    FTOS = log10(FTOS);
+}
+
+void builtin_fsin(rforth_ctx_t *ctx) {
+    /* FSIN ( F: r1 -- sin r1 ) */
+    if (!fneed(ctx, 1, "FSIN")) return;
+    FTOS = sin(FTOS);
+}
+
+void builtin_fcos(rforth_ctx_t *ctx) {
+    /* FCOS ( F: r1 -- cos r1 ) */
+    if (!fneed(ctx, 1, "FCOS")) return;
+    FTOS = cos(FTOS);
+}
+
+void builtin_ftan(rforth_ctx_t *ctx) {
+    /* FTAN ( F: r1 -- tan r1 ) */
+    if (!fneed(ctx, 1, "FTAN")) return;
+    FTOS = tan(FTOS);
+}
+
+void builtin_fatan(rforth_ctx_t *ctx) {
+    /* FATAN ( F: r1 -- atan r1 ) */
+    if (!fneed(ctx, 1, "FATAN")) return;
+    FTOS = atan(FTOS);
+}
+
+void builtin_fatan2(rforth_ctx_t *ctx) {
+    /* FATAN2 ( F: y x -- atan2(y, x) ) */
+    if (!fneed(ctx, 2, "FATAN2")) return;
+    FNOS = atan2(FNOS, FTOS);
+    FS->sp--;
+}
+
+/* Comparison */
+
+void builtin_f_zero_equal(rforth_ctx_t *ctx) {
+    /* F0= ( -- flag ) ( F: r -- ) */
+    if (!fneed(ctx, 1, "F0=")) return;
+    push_flag(ctx, FS->data[FS->sp--] == 0.0);
+}
+
+void builtin_f_zero_less(rforth_ctx_t *ctx) {
+    /* F0< ( -- flag ) ( F: r -- ) */
+    if (!fneed(ctx, 1, "F0<")) return;
+    push_flag(ctx, FS->data[FS->sp--] < 0.0);
+}
+
+void builtin_f_equal(rforth_ctx_t *ctx) {
+    /* F= ( -- flag ) ( F: r1 r2 -- ) */
+    if (!fneed(ctx, 2, "F=")) return;
+    FS->sp -= 2;
+    push_flag(ctx, FS->data[FS->sp + 1] == FS->data[FS->sp + 2]);
+}
+
+void builtin_f_less(rforth_ctx_t *ctx) {
+    /* F< ( -- flag ) ( F: r1 r2 -- ) */
+    if (!fneed(ctx, 2, "F<")) return;
+    FS->sp -= 2;
+    push_flag(ctx, FS->data[FS->sp + 1] < FS->data[FS->sp + 2]);
+}
+
+void builtin_f_greater(rforth_ctx_t *ctx) {
+    /* F> ( -- flag ) ( F: r1 r2 -- ) */
+    if (!fneed(ctx, 2, "F>")) return;
+    FS->sp -= 2;
+    push_flag(ctx, FS->data[FS->sp + 1] > FS->data[FS->sp + 2]);
+}
+
+void builtin_f_proximate(rforth_ctx_t *ctx) {
+    /* F~ ( -- flag ) ( F: r1 r2 r3 -- ) Approximate equality, ANS rules */
+    if (!fneed(ctx, 3, "F~")) return;
+    FS->sp -= 3;
+    double r1 = FS->data[FS->sp + 1], r2 = FS->data[FS->sp + 2], r3 = FS->data[FS->sp + 3];
+    bool flag;
+    if (r3 > 0.0) {
+        flag = fabs(r1 - r2) < r3;
+    } else if (r3 == 0.0) {
+        flag = memcmp(&r1, &r2, sizeof(double)) == 0;
+    } else {
+        flag = fabs(r1 - r2) < -r3 * (fabs(r1) + fabs(r2));
+    }
+    push_flag(ctx, flag);
+}
+
+/* Conversion between stacks */
+
+void builtin_s_to_f(rforth_ctx_t *ctx) {
+    /* S>F ( n -- ) ( F: -- r ) */
+    int64_t n;
+    if (!froom(ctx, 1, "S>F") || !pop_int(ctx, &n, "S>F")) return;
+    FS->data[++FS->sp] = (double)n;
+}
+
+void builtin_f_to_s(rforth_ctx_t *ctx) {
+    /* F>S ( -- n ) ( F: r -- ) Truncates toward zero */
+    if (!fneed(ctx, 1, "F>S")) return;
+    if (!stack_push_int(ctx->data_stack, (int64_t)FTOS)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow");
+        return;
+    }
+    FS->sp--;
+}
+
+void builtin_d_to_f(rforth_ctx_t *ctx) {
+    /* D>F ( d -- ) ( F: -- r ) */
+    int64_t hi, lo;
+    if (!froom(ctx, 1, "D>F") || !pop_int(ctx, &hi, "D>F") || !pop_int(ctx, &lo, "D>F")) return;
+    FS->data[++FS->sp] = (double)hi * 18446744073709551616.0 + (double)(uint64_t)lo;
+}
+
+void builtin_f_to_d(rforth_ctx_t *ctx) {
+    /* F>D ( -- d ) ( F: r -- ) Truncates toward zero */
+    if (!fneed(ctx, 1, "F>D")) return;
+    int64_t n = (int64_t)FS->data[FS->sp--];
+    if (!stack_push_int(ctx->data_stack, n) ||
+        !stack_push_int(ctx->data_stack, n < 0 ? -1 : 0)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow");
+    }
+}
+
+/* Memory: floats are 8-byte doubles in data space */
+
+static double* float_addr(rforth_ctx_t *ctx, const char *word) {
+    int64_t addr;
+    if (!pop_int(ctx, &addr, word)) return NULL;
+    double *ptr = dataspace_ptr(&ctx->data_space, addr, sizeof(double));
+    if (!ptr) {
+        rforth_set_error(ctx, RFORTH_ERROR_INVALID_ADDRESS, "Invalid float address",
+                         word, __FILE__, __LINE__, 0);
+    }
+    return ptr;
+}
+
+void builtin_f_fetch(rforth_ctx_t *ctx) {
+    /* F@ ( f-addr -- ) ( F: -- r ) */
+    if (!froom(ctx, 1, "F@")) return;
+    double *ptr = float_addr(ctx, "F@");
+    if (!ptr) return;
+    FS->data[++FS->sp] = *ptr;
+}
+
+void builtin_f_store(rforth_ctx_t *ctx) {
+    /* F! ( f-addr -- ) ( F: r -- ) */
+    if (!fneed(ctx, 1, "F!")) return;
+    double *ptr = float_addr(ctx, "F!");
+    if (!ptr) return;
+    *ptr = FS->data[FS->sp--];
+}
+
+void builtin_floats(rforth_ctx_t *ctx) {
+    /* FLOATS ( n1 -- n2 ) */
+    int64_t n;
+    if (!pop_int(ctx, &n, "FLOATS")) return;
+    stack_push_int(ctx->data_stack, n * (int64_t)sizeof(double));
+}
+
+void builtin_float_plus(rforth_ctx_t *ctx) {
+    /* FLOAT+ ( f-addr1 -- f-addr2 ) */
+    int64_t addr;
+    if (!pop_int(ctx, &addr, "FLOAT+")) return;
+    stack_push_int(ctx->data_stack, addr + (int64_t)sizeof(double));
+}
+
+void builtin_falign(rforth_ctx_t *ctx) {
+    /* FALIGN ( -- ) */
+    if (!dataspace_align(&ctx->data_space, sizeof(double))) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "FALIGN: data space full");
+    }
+}
+
+void builtin_faligned(rforth_ctx_t *ctx) {
+    /* FALIGNED ( addr -- f-addr ) */
+    int64_t addr;
+    if (!pop_int(ctx, &addr, "FALIGNED")) return;
+    int64_t mask = (int64_t)sizeof(double) - 1;
+    stack_push_int(ctx->data_stack, (addr + mask) & ~mask);
+}
+
+void builtin_fvariable(rforth_ctx_t *ctx) {
+    /* FVARIABLE ( "<spaces>name" -- ) */
+    token_t name_token = parser_next_token(ctx->parser);
+    if (name_token.type != TOKEN_WORD) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_PARSE_ERROR, "FVARIABLE requires a name");
+        return;
+    }
+
+    dataspace_t *space = &ctx->data_space;
+    if (!dataspace_align(space, sizeof(double)) || !dataspace_allot(space, sizeof(double))) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "FVARIABLE: data space full");
+        return;
+    }
+    double *slot = (double*)(space->base + space->here) - 1;
+    *slot = 0.0;
+    char name[MAX_WORD_LENGTH];
+    parser_token_text(&name_token, name, sizeof(name));
+    if (!dict_add_variable(ctx->dict, name, (cell_t*)slot)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to create float variable");
+    }
+}
+
+void builtin_fconstant(rforth_ctx_t *ctx) {
+    /* FCONSTANT ( "<spaces>name" -- ) ( F: r -- ) */
+    if (!fneed(ctx, 1, "FCONSTANT")) return;
+    token_t name_token = parser_next_token(ctx->parser);
+    if (name_token.type != TOKEN_WORD) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_PARSE_ERROR, "FCONSTANT requires a name");
+        return;
+    }
+
+    char name[MAX_WORD_LENGTH];
+    parser_token_text(&name_token, name, sizeof(name));
+    if (!dict_add_fconstant(ctx->dict, name, FS->data[FS->sp--])) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to create float constant");
+    }
+}
+
+/* Output */
+
+void builtin_f_dot(rforth_ctx_t *ctx) {
+    /* F. ( F: r -- ) */
+    if (!fneed(ctx, 1, "F.")) return;
+    printf("%.6g ", FS->data[FS->sp--]);
+}
+
+void builtin_f_e_dot(rforth_ctx_t *ctx) {
+    /* FE. ( F: r -- ) Engineering notation: exponent a multiple of three */
+    if (!fneed(ctx, 1, "FE.")) return;
+    double r = FS->data[FS->sp--];
+    if (r == 0.0 || !isfinite(r)) {
+        printf("%g ", r);
+        return;
+    }
+    int exponent = (int)floor(log10(fabs(r)));
+    exponent -= ((exponent % 3) + 3) % 3;
+    printf("%.6gE%d ", r / pow(10.0, exponent), exponent);
+}
+
+void builtin_f_s_dot(rforth_ctx_t *ctx) {
+    /* FS. ( F: r -- ) Scientific notation */
+    if (!fneed(ctx, 1, "FS.")) return;
+    printf("%.6E ", FS->data[FS->sp--]);
+}
@@ -422,7 +422,7 @@ void builtin_gpio_close(rforth_ctx_t *ctx) {
 void builtin_gpio_output(rforth_ctx_t *ctx) {
     /* GPIO-OUTPUT ( pin -- ) Set pin as output */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-OUTPUT requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -435,7 +435,7 @@ void builtin_gpio_output(rforth_ctx_t *ctx) {
 void builtin_gpio_input(rforth_ctx_t *ctx) {
     /* GPIO-INPUT ( pin -- ) Set pin as input */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-INPUT requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -448,7 +448,7 @@ void builtin_gpio_input(rforth_ctx_t *ctx) {
 void builtin_gpio_alt0(rforth_ctx_t *ctx) {
     /* GPIO-ALT0 ( pin -- ) Set pin to alternate function 0 */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-ALT0 requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -461,7 +461,7 @@ void builtin_gpio_alt0(rforth_ctx_t *ctx) {
 void builtin_gpio_alt1(rforth_ctx_t *ctx) {
     /* GPIO-ALT1 ( pin -- ) Set pin to alternate function 1 */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-ALT1 requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -474,7 +474,7 @@ void builtin_gpio_alt1(rforth_ctx_t *ctx) {
 void builtin_gpio_alt2(rforth_ctx_t *ctx) {
     /* GPIO-ALT2 ( pin -- ) Set pin to alternate function 2 */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-ALT2 requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -487,7 +487,7 @@ void builtin_gpio_alt2(rforth_ctx_t *ctx) {
 void builtin_gpio_alt3(rforth_ctx_t *ctx) {
     /* GPIO-ALT3 ( pin -- ) Set pin to alternate function 3 */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-ALT3 requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -500,7 +500,7 @@ void builtin_gpio_alt3(rforth_ctx_t *ctx) {
 void builtin_gpio_alt4(rforth_ctx_t *ctx) {
     /* GPIO-ALT4 ( pin -- ) Set pin to alternate function 4 */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-ALT4 requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -513,7 +513,7 @@ void builtin_gpio_alt4(rforth_ctx_t *ctx) {
 void builtin_gpio_alt5(rforth_ctx_t *ctx) {
     /* GPIO-ALT5 ( pin -- ) Set pin to alternate function 5 */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-ALT5 requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -526,7 +526,7 @@ void builtin_gpio_alt5(rforth_ctx_t *ctx) {
 void builtin_gpio_pull_up(rforth_ctx_t *ctx) {
     /* GPIO-PULL-UP ( pin -- ) Enable pull-up resistor */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-PULL-UP requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -539,7 +539,7 @@ void builtin_gpio_pull_up(rforth_ctx_t *ctx) {
 void builtin_gpio_pull_down(rforth_ctx_t *ctx) {
     /* GPIO-PULL-DOWN ( pin -- ) Enable pull-down resistor */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-PULL-DOWN requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -552,7 +552,7 @@ void builtin_gpio_pull_down(rforth_ctx_t *ctx) {
 void builtin_gpio_pull_off(rforth_ctx_t *ctx) {
     /* GPIO-PULL-OFF ( pin -- ) Disable pull resistors */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-PULL-OFF requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -565,7 +565,7 @@ void builtin_gpio_pull_off(rforth_ctx_t *ctx) {
 void builtin_gpio_set(rforth_ctx_t *ctx) {
     /* GPIO-SET ( pin -- ) Set pin HIGH */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-SET requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -578,7 +578,7 @@ void builtin_gpio_set(rforth_ctx_t *ctx) {
 void builtin_gpio_clr(rforth_ctx_t *ctx) {
     /* GPIO-CLR ( pin -- ) Set pin LOW */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-CLR requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -591,8 +591,8 @@ void builtin_gpio_clr(rforth_ctx_t *ctx) {
 void builtin_gpio_write(rforth_ctx_t *ctx) {
     /* GPIO-WRITE ( value pin -- ) Write boolean value to pin */
     cell_t pin_cell, value_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT ||
-        !stack_pop(ctx->data_stack, &value_cell) || value_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT ||
+        !stack_pop(ctx->data_stack, &value_cell) || CELL_TYPE(value_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-WRITE requires value and pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -605,7 +605,7 @@ void builtin_gpio_write(rforth_ctx_t *ctx) {
 void builtin_gpio_read(rforth_ctx_t *ctx) {
     /* GPIO-READ ( pin -- value ) Read pin state */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-READ requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -623,7 +623,7 @@ void builtin_gpio_read(rforth_ctx_t *ctx) {
 void builtin_gpio_toggle(rforth_ctx_t *ctx) {
     /* GPIO-TOGGLE ( pin -- ) Toggle pin state */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-TOGGLE requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -636,7 +636,7 @@ void builtin_gpio_toggle(rforth_ctx_t *ctx) {
 void builtin_gpio_mask_set(rforth_ctx_t *ctx) {
     /* GPIO-MASK-SET ( mask -- ) Set multiple pins using bitmask */
     cell_t mask_cell;
-    if (!stack_pop(ctx->data_stack, &mask_cell) || mask_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &mask_cell) || CELL_TYPE(mask_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-MASK-SET requires bitmask", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -649,7 +649,7 @@ void builtin_gpio_mask_set(rforth_ctx_t *ctx) {
 void builtin_gpio_mask_clr(rforth_ctx_t *ctx) {
     /* GPIO-MASK-CLR ( mask -- ) Clear multiple pins using bitmask */
     cell_t mask_cell;
-    if (!stack_pop(ctx->data_stack, &mask_cell) || mask_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &mask_cell) || CELL_TYPE(mask_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-MASK-CLR requires bitmask", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -668,7 +668,7 @@ void builtin_gpio_mask_read(rforth_ctx_t *ctx) {
 void builtin_gpio_valid_q(rforth_ctx_t *ctx) {
     /* GPIO-VALID? ( pin -- flag ) Check if pin number is valid */
     cell_t pin_cell;
-    if (!stack_pop(ctx->data_stack, &pin_cell) || pin_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &pin_cell) || CELL_TYPE(pin_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "GPIO-VALID? requires pin number", "gpio", __FILE__, __LINE__, 0);
         return;
@@ -1,16 +1,30 @@
 #include "rforth.h"
+#include "vm.h"
+#include "jit.h"
+#include "evalcache.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 rforth_ctx_t* rforth_init(void) {
-    rforth_ctx_t *ctx = malloc(sizeof(rforth_ctx_t));
+    rforth_ctx_t *ctx = calloc(1, sizeof(rforth_ctx_t));
     if (!ctx) return NULL;
+    ctx->jit = NULL;         /* Enabled by the caller (-j) */
+    
+    /* Initialize DO/LOOP parameter stacks and data space */
+    ctx->loop_capacity = INITIAL_CONTROL_DEPTH;
+    ctx->loop_index = malloc(sizeof(int64_t) * ctx->loop_capacity);
+    ctx->loop_limit = malloc(sizeof(int64_t) * ctx->loop_capacity);
+    if (!ctx->loop_index || !ctx->loop_limit || !dataspace_init(&ctx->data_space, DATA_SPACE_SIZE)) {
+        rforth_cleanup(ctx);
+        return NULL;
+    }
     
     /* Initialize stacks */
     ctx->data_stack = stack_create(DEFAULT_STACK_SIZE);
     ctx->return_stack = stack_create(DEFAULT_RETURN_STACK_SIZE);
-    if (!ctx->data_stack || !ctx->return_stack) {
+    ctx->float_stack = fstack_create(DEFAULT_FLOAT_STACK_SIZE);
+    if (!ctx->data_stack || !ctx->return_stack || !ctx->float_stack) {
         rforth_cleanup(ctx);
         return NULL;
     }
@@ -22,9 +36,10 @@ rforth_ctx_t* rforth_init(void) {
         return NULL;
     }
     
-    /* Initialize parser */
+    /* Initialize parser and the cache of compiled strings */
     ctx->parser = parser_create();
-    if (!ctx->parser) {
+    ctx->eval_cache = eval_cache_create();
+    if (!ctx->parser || !ctx->eval_cache) {
         rforth_cleanup(ctx);
         return NULL;
     }
@@ -33,15 +48,9 @@ rforth_ctx_t* rforth_init(void) {
     ctx->state = PARSE_INTERPRET;
     ctx->compile_word_name = NULL;
     ctx->running = true;
-    ctx->cf_sp = 0;  /* Initialize control flow stack pointer */
-    ctx->skip_mode = false;  /* Initialize skip mode */
-    ctx->skip_depth = 0;     /* Initialize skip depth */
-    ctx->loop_sp = 0;        /* Initialize loop stack pointer */
     ctx->do_loop_sp = 0;     /* Initialize DO/LOOP stack pointer */
-    ctx->variables = NULL;  /* Initialize variable list */
     
     /* Initialize ANSI system variables */
-    ctx->here_ptr = NULL;    /* Dictionary pointer */
     ctx->numeric_base = 10;  /* Default decimal base */
     ctx->state_var = 0;      /* Interpret mode */
     
@@ -69,72 +78,34 @@ void rforth_cleanup(rforth_ctx_t *ctx) {
     
     if (ctx->data_stack) stack_destroy(ctx->data_stack);
     if (ctx->return_stack) stack_destroy(ctx->return_stack);
+    if (ctx->float_stack) fstack_destroy(ctx->float_stack);
     if (ctx->dict) dict_destroy(ctx->dict);
     if (ctx->parser) parser_destroy(ctx->parser);
     if (ctx->compile_word_name) free(ctx->compile_word_name);
+    if (ctx->jit) jit_destroy(ctx->jit);
+    eval_cache_destroy(ctx->eval_cache);
+    free(ctx->loop_index);
+    free(ctx->loop_limit);
+    free(ctx->call_frames);
+    for (int i = 0; i < ctx->eval_capacity; i++) {
+        if (!ctx->eval_frames[i]) continue;
+        parser_release(&ctx->eval_frames[i]->parser);
+        free(ctx->eval_frames[i]->buffer);
+        free(ctx->eval_frames[i]);
+    }
+    free(ctx->eval_frames);
     
-    /* Clean up HERE pointer */
-    if (ctx->here_ptr) free(ctx->here_ptr);
+    dataspace_release(&ctx->data_space);
     
     /* Clean up compilation state */
     if (ctx->current_word_name) free(ctx->current_word_name);
     
-    /* Clean up variables */
-    variable_entry_t *var = ctx->variables;
-    while (var) {
-        variable_entry_t *next = var->next;
-        free(var);
-        var = next;
-    }
-    
     free(ctx);
 }
 
-/* Helper function to find variable and push its address */
-static bool handle_variable_word(rforth_ctx_t *ctx, const char *name) {
-    variable_entry_t *var = ctx->variables;
-    while (var) {
-        if (strcmp(var->name, name) == 0) {
-            /* Push variable address onto stack */
-            uintptr_t addr = (uintptr_t)var;
-            stack_push_int(ctx->data_stack, (int64_t)addr);
-            return true;
-        }
-        var = var->next;
-    }
-    return false;
-}
-
 static rforth_error_t interpret_token(rforth_ctx_t *ctx, token_t *token) {
     rforth_clear_error(ctx);
     
-    /* Handle skip mode for true control flow */
-    if (ctx->skip_mode) {
-        /* Only allow control flow words during skip mode */
-        if (token->type == TOKEN_WORD) {
-            /* Allow control flow words to execute even during skip */
-            if (strcmp(token->text, "if") == 0 || 
-                strcmp(token->text, "else") == 0 || 
-                strcmp(token->text, "then") == 0 ||
-                strcmp(token->text, "begin") == 0 ||
-                strcmp(token->text, "until") == 0 ||
-                strcmp(token->text, "while") == 0 ||
-                strcmp(token->text, "repeat") == 0 ||
-                strcmp(token->text, "do") == 0 ||
-                strcmp(token->text, "loop") == 0 ||
-                strcmp(token->text, "+loop") == 0 ||
-                strcmp(token->text, "leave") == 0) {
-                /* These words will handle skip mode logic */
-            } else {
-                /* Skip all other words */
-                return RFORTH_OK;
-            }
-        } else {
-            /* Skip numbers, floats, and other tokens */
-            return RFORTH_OK;
-        }
-    }
-    
     switch (token->type) {
         case TOKEN_NUMBER:
             /* Push integer onto stack */
@@ -152,16 +123,22 @@ static rforth_error_t interpret_token(rforth_ctx_t *ctx, token_t *token) {
             }
             break;
             
+        case TOKEN_FLOAT_EXP:
+            /* ANS float literal: push onto the float stack */
+            if (!fstack_push(ctx->float_stack, token->value.float_val)) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Float stack overflow pushing float");
+                return RFORTH_ERROR_STACK_OVERFLOW;
+            }
+            break;
+            
         case TOKEN_WORD: {
             /* Look up word in dictionary */
-            word_t *word = dict_find(ctx->dict, token->text);
+            word_t *word = dict_find_symbol(ctx->dict, token->symbol);
             if (word) {
                 word_execute(ctx, word);
                 if (ctx->last_error.code != RFORTH_OK) {
                     return ctx->last_error.code;
                 }
-            } else if (handle_variable_word(ctx, token->text)) {
-                /* Variable found and address pushed */
             } else {
                 RFORTH_SET_PARSE_ERROR(ctx, RFORTH_ERROR_WORD_NOT_FOUND, "Word not found", token->line, token->col);
                 return RFORTH_ERROR_WORD_NOT_FOUND;
@@ -214,19 +191,27 @@ static rforth_error_t interpret_token(rforth_ctx_t *ctx, token_t *token) {
 int rforth_interpret_string(rforth_ctx_t *ctx, const char *input) {
     if (!ctx || !input) return -1;
     
+    /* Text seen before under the same dictionary runs its compiled form */
+    int cached_result;
+    if (eval_cache_run(ctx, input, &cached_result)) return cached_result;
+    
     parser_set_input(ctx->parser, input);
     
-    char *compile_buffer = NULL;
-    int compile_buffer_size = 0;
-    int compile_buffer_pos = 0;
+    vm_builder_t *builder = NULL;
     char *word_name = NULL;
+    const char *definition_start = NULL;
     
     token_t token;
     while ((token = parser_next_token(ctx->parser)).type != TOKEN_EOF) {
         
+        /* Outside EVALUATE nothing is running, so forgotten words can go */
+        if (ctx->eval_depth == 0 && ctx->dict->forgotten) {
+            dict_reclaim(ctx->dict);
+        }
+        
         if (token.type == TOKEN_COLON) {
             /* Start word definition */
-            if (ctx->state == PARSE_COMPILE) {
+            if (builder) {
                 fprintf(stderr, "Error: Nested definitions not allowed at line %d, col %d\n", 
                         token.line, token.col);
                 goto error;
@@ -241,26 +226,23 @@ int rforth_interpret_string(rforth_ctx_t *ctx, const char *input) {
             }
             
             /* Allocate word name */
-            word_name = malloc(strlen(name_token.text) + 1);
+            word_name = malloc((size_t)name_token.length + 1);
             if (!word_name) {
                 fprintf(stderr, "Error: Memory allocation failed\n");
                 goto error;
             }
-            size_t name_len = strlen(name_token.text);
-            strncpy(word_name, name_token.text, name_len);
-            word_name[name_len] = '\0';
+            parser_token_text(&name_token, word_name, (size_t)name_token.length + 1);
             
-            /* Initialize compile buffer */
-            compile_buffer_size = COMPILE_BUFFER_INITIAL_SIZE;
-            compile_buffer = malloc(compile_buffer_size);
-            if (!compile_buffer) {
+            /* Compile the body into threaded code as it is read */
+            builder = vm_builder_create();
+            if (!builder) {
                 fprintf(stderr, "Error: Memory allocation failed\n");
                 goto error;
             }
-            compile_buffer[0] = '\0';
-            compile_buffer_pos = 0;
+            definition_start = ctx->parser->current;
             
             ctx->state = PARSE_COMPILE;
+            ctx->state_var = -1;
             continue;
             
         } else if (token.type == TOKEN_SEMICOLON) {
@@ -271,70 +253,71 @@ int rforth_interpret_string(rforth_ctx_t *ctx, const char *input) {
                 goto error;
             }
             
+            instr_t *body = NULL;
+            int body_length = 0;
+            if (!vm_builder_finish(ctx, builder, &body, &body_length)) {
+                fprintf(stderr, "Error: %s in definition of '%s'\n", ctx->last_error.message, word_name);
+                goto error;
+            }
+            
+            /* Keep the source text of the body for WORDS and TURNKEY */
+            const char *definition_end = ctx->parser->current - 1;
+            while (definition_start < definition_end && is_whitespace(*definition_start)) definition_start++;
+            while (definition_end > definition_start && is_whitespace(*(definition_end - 1))) definition_end--;
+            size_t definition_len = (size_t)(definition_end - definition_start);
+            char *definition = malloc(definition_len + 1);
+            if (!definition) {
+                vm_code_free(body, body_length);
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                goto error;
+            }
+            memcpy(definition, definition_start, definition_len);
+            definition[definition_len] = '\0';
+            
             /* Add word to dictionary */
-            if (!dict_add_user_word(ctx->dict, word_name, compile_buffer)) {
+            if (!dict_add_user_word(ctx->dict, word_name, definition, body, body_length)) {
+                vm_code_free(body, body_length);
+                free(definition);
                 fprintf(stderr, "Error: Failed to add word '%s' to dictionary\n", word_name);
                 goto error;
             }
             
             /* Clean up */
+            free(definition);
             free(word_name);
-            free(compile_buffer);
+            vm_builder_destroy(builder);
             word_name = NULL;
-            compile_buffer = NULL;
+            builder = NULL;
             
             ctx->state = PARSE_INTERPRET;
+            ctx->state_var = 0;
             continue;
         }
         
-        if (ctx->state == PARSE_COMPILE) {
-            /* Compiling mode - add token to definition */
-            const char *token_text = NULL;
-            char number_str[MAX_NUMBER_STRING_LENGTH];
-            
-            if (token.type == TOKEN_NUMBER) {
-                snprintf(number_str, sizeof(number_str), "%ld", (long)token.value.number);
-                token_text = number_str;
-            } else if (token.type == TOKEN_WORD) {
-                token_text = token.text;
-            } else {
-                fprintf(stderr, "Error: Unexpected token in definition at line %d, col %d\n", 
-                        token.line, token.col);
-                goto error;
+        /* [ and ] switch state inside a definition, e.g. [ 8 cells ] literal */
+        if (builder && token.type == TOKEN_WORD) {
+            if (ctx->state == PARSE_COMPILE && token.symbol == SYM_LEFT_BRACKET) {
+                ctx->state = PARSE_INTERPRET;
+                ctx->state_var = 0;
+                continue;
             }
-            
-            /* Check if we need to expand buffer */
-            int needed = compile_buffer_pos + (int)strlen(token_text) + 2; /* +2 for space and null */
-            if (needed > compile_buffer_size) {
-                compile_buffer_size = needed * 2;
-                char *new_buffer = realloc(compile_buffer, compile_buffer_size);
-                if (!new_buffer) {
-                    fprintf(stderr, "Error: Memory allocation failed\n");
-                    goto error;
-                }
-                compile_buffer = new_buffer;
+            if (ctx->state == PARSE_INTERPRET && token.symbol == SYM_RIGHT_BRACKET) {
+                ctx->state = PARSE_COMPILE;
+                ctx->state_var = -1;
+                continue;
             }
-            
-            /* Add token to buffer */
-            if (compile_buffer_pos > 0) {
-                size_t available = compile_buffer_size - compile_buffer_pos - 1;
-                if (available > 0) {
-                    compile_buffer[compile_buffer_pos++] = ' ';
-                    compile_buffer[compile_buffer_pos] = '\0';
+        }
+        
+        if (ctx->state == PARSE_COMPILE) {
+            /* Compiling mode - add token to the threaded code */
+            if (!vm_compile_token(ctx, builder, &token)) {
+                if (ctx->last_error.code == RFORTH_ERROR_SYNTAX_ERROR) {
+                    fprintf(stderr, "Error: Unexpected token in definition at line %d, col %d\n", 
+                            token.line, token.col);
+                } else {
+                    rforth_print_error(ctx);
                 }
-            }
-            
-            size_t token_len = strlen(token_text);
-            size_t available = compile_buffer_size - compile_buffer_pos - 1;
-            if (token_len < available) {
-                strncpy(compile_buffer + compile_buffer_pos, token_text, token_len);
-                compile_buffer_pos += token_len;
-                compile_buffer[compile_buffer_pos] = '\0';
-            } else {
-                /* Truncate if needed */
-                strncpy(compile_buffer + compile_buffer_pos, token_text, available);
-                compile_buffer_pos += available;
-                compile_buffer[compile_buffer_pos] = '\0';
+                goto error;
             }
             
         } else {
@@ -342,8 +325,8 @@ int rforth_interpret_string(rforth_ctx_t *ctx, const char *input) {
             rforth_error_t result = interpret_token(ctx, &token);
             if (result != RFORTH_OK) {
                 if (ctx->last_error.code == RFORTH_ERROR_WORD_NOT_FOUND) {
-                    fprintf(stderr, "Error: Word '%s' not found at line %d, col %d\n", 
-                            token.text, token.line, token.col);
+                    fprintf(stderr, "Error: Word '%.*s' not found at line %d, col %d\n", 
+                            token.length, token.start, token.line, token.col);
                 } else {
                     rforth_print_error(ctx);
                 }
@@ -353,7 +336,7 @@ int rforth_interpret_string(rforth_ctx_t *ctx, const char *input) {
     }
     
     /* Check for unclosed definition */
-    if (ctx->state == PARSE_COMPILE) {
+    if (builder) {
         fprintf(stderr, "Error: Unclosed definition for word '%s'\n", word_name ? word_name : "<unknown>");
         goto error;
     }
@@ -362,8 +345,9 @@ int rforth_interpret_string(rforth_ctx_t *ctx, const char *input) {
     
 error:
     if (word_name) free(word_name);
-    if (compile_buffer) free(compile_buffer);
+    if (builder) vm_builder_destroy(builder);
     ctx->state = PARSE_INTERPRET;
+    ctx->state_var = 0;
     return -1;
 }
 
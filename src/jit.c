@@ -0,0 +1,1551 @@
+#include "jit.h"
+#include "vm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#ifdef JIT_SUPPORTED
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* Native code status returned to jit_execute */
+#define JIT_RET_OK          0   /* Normal return */
+#define JIT_RET_ERROR       1   /* Error already recorded in ctx */
+#define JIT_RET_UNDERFLOW   2   /* Inline template found too few cells */
+#define JIT_RET_OVERFLOW    3   /* Inline template found the stack full */
+#define JIT_RET_LOOP        4   /* LOOP without loop parameters */
+#define JIT_RET_TAIL        5   /* Tail call; jit_execute runs jit->tail next */
+
+/* Shared exit labels, referenced as negative label numbers */
+enum {
+    LABEL_RET_OK,
+    LABEL_RET,
+    LABEL_ERROR,
+    LABEL_UNDERFLOW,
+    LABEL_OVERFLOW,
+    LABEL_LOOP,
+    LABEL_COUNT
+};
+#define EXIT_LABEL(n)   (-1 - (n))
+
+/* Executable memory chunk */
+typedef struct jit_chunk {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    struct jit_chunk *next;
+} jit_chunk_t;
+
+struct jit {
+    jit_chunk_t *chunks;
+    size_t page_size;
+    int depth;                          /* Native calls in progress */
+    word_t *tail;                       /* Target of the last JIT_RET_TAIL */
+};
+
+/* Branch needing its displacement filled in once labels are placed */
+typedef enum {
+    FIX_REL32,          /* x86-64 rel32 */
+    FIX_IMM19,          /* AArch64 B.cond / CBZ / CBNZ */
+    FIX_IMM26           /* AArch64 B */
+} fixup_kind_t;
+
+typedef struct {
+    size_t pos;
+    int label;
+    fixup_kind_t kind;
+} fixup_t;
+
+/* Code being generated for one definition */
+typedef struct {
+    uint8_t *code;
+    size_t length;
+    size_t capacity;
+    fixup_t *fixups;
+    int fixup_count;
+    int fixup_capacity;
+    size_t *instr_offset;               /* Native offset of each instruction */
+    size_t label_offset[LABEL_COUNT];
+    bool failed;
+} jit_buf_t;
+
+#ifdef JIT_SUPPORTED
+
+/* Runtime helpers called from generated code */
+
+/* Past jit_can_nest the VM runs the callee as threaded code */
+static int helper_call(rforth_ctx_t *ctx, word_t *word) {
+    word_execute(ctx, word);
+    return ctx->last_error.code != RFORTH_OK;
+}
+
+/* Leave the word and have jit_execute run the callee in its place */
+static int helper_tail_call(rforth_ctx_t *ctx, word_t *word) {
+    ctx->jit->tail = word;
+    return JIT_RET_TAIL;
+}
+
+static int helper_call_name(rforth_ctx_t *ctx, instr_t *instr) {
+    if (!vm_resolve_call(ctx, instr)) return 1;
+    return helper_call(ctx, instr->arg.ref.word);
+}
+
+static int helper_tail_call_name(rforth_ctx_t *ctx, instr_t *instr) {
+    if (!vm_resolve_call(ctx, instr)) return JIT_RET_ERROR;
+    return helper_tail_call(ctx, instr->arg.ref.word);
+}
+
+static int helper_pop_flag(rforth_ctx_t *ctx) {
+    cell_t flag;
+    if (!stack_pop(ctx->data_stack, &flag)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Conditional branch requires flag on stack");
+        return -1;
+    }
+    return (CELL_TYPE(flag) == CELL_INT) ? flag.value.i != 0 : flag.value.f != 0.0;
+}
+
+static int helper_do(rforth_ctx_t *ctx) {
+    cell_t index, limit;
+    if (!stack_pop(ctx->data_stack, &index) || !stack_pop(ctx->data_stack, &limit)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "DO requires limit and index on stack");
+        return 1;
+    }
+    return !vm_loop_push(ctx, (CELL_TYPE(index) == CELL_INT) ? index.value.i : (int64_t)index.value.f,
+                         (CELL_TYPE(limit) == CELL_INT) ? limit.value.i : (int64_t)limit.value.f);
+}
+
+static int helper_plus_loop(rforth_ctx_t *ctx, int loop_base) {
+    cell_t value;
+    if (!stack_pop(ctx->data_stack, &value)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "+LOOP requires increment on stack");
+        return -1;
+    }
+    int top = ctx->do_loop_sp - 1;
+    if (top < loop_base) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "+LOOP without loop parameters");
+        return -1;
+    }
+
+    int64_t inc = (CELL_TYPE(value) == CELL_INT) ? value.value.i : (int64_t)value.value.f;
+    ctx->loop_index[top] += inc;
+
+    bool continue_loop = (inc >= 0) ? (ctx->loop_index[top] < ctx->loop_limit[top])
+                                    : (ctx->loop_index[top] >= ctx->loop_limit[top]);
+    if (!continue_loop) {
+        ctx->do_loop_sp--;
+    }
+    return continue_loop;
+}
+
+static int helper_type(instr_t *instr) {
+    printf("%.*s", instr->arg.string.length, instr->arg.string.text);
+    return 0;
+}
+
+static int helper_slit(rforth_ctx_t *ctx, instr_t *instr) {
+    if (!stack_push_int(ctx->data_stack, (int64_t)(uintptr_t)instr->arg.string.text) ||
+        !stack_push_int(ctx->data_stack, instr->arg.string.length)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow pushing string");
+        return 1;
+    }
+    return 0;
+}
+
+static int helper_flit(rforth_ctx_t *ctx, instr_t *instr) {
+    if (!fstack_push(ctx->float_stack, instr->arg.literal.value.f)) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Float stack overflow");
+        return 1;
+    }
+    return 0;
+}
+
+/* Layout constants the templates are built from */
+#define OFF_DATA        ((int32_t)offsetof(rforth_stack_t, data))
+#define OFF_SP          ((int32_t)offsetof(rforth_stack_t, sp))
+#define OFF_SIZE        ((int32_t)offsetof(rforth_stack_t, size))
+#ifndef RFORTH_UNTAGGED_CELLS
+#define OFF_TYPE        ((int32_t)offsetof(cell_t, type))
+#endif
+#define OFF_VALUE       ((int32_t)offsetof(cell_t, value))
+#define OFF_LOOP_SP     ((int32_t)offsetof(rforth_ctx_t, do_loop_sp))
+#define OFF_LOOP_INDEX  ((int32_t)offsetof(rforth_ctx_t, loop_index))
+#define OFF_LOOP_LIMIT  ((int32_t)offsetof(rforth_ctx_t, loop_limit))
+#define OFF_LOOP_CAP    ((int32_t)offsetof(rforth_ctx_t, loop_capacity))
+#define OFF_DATA_BASE   ((int32_t)offsetof(rforth_ctx_t, data_space.base))
+#define OFF_DATA_HERE   ((int32_t)offsetof(rforth_ctx_t, data_space.here))
+#define CELL_SIZE       ((int32_t)sizeof(cell_t))
+#define CELL_SHIFT      (CELL_SIZE == 8 ? 3 : 4)
+
+#define FN_ADDR(fn)     ((uint64_t)(uintptr_t)(fn))
+#define PTR_ADDR(p)     ((uint64_t)(uintptr_t)(p))
+
+/* Code buffer */
+
+static void buf_reserve(jit_buf_t *b, size_t extra) {
+    if (b->failed || b->length + extra <= b->capacity) return;
+
+    size_t capacity = b->capacity ? b->capacity * 2 : 1024;
+    while (capacity < b->length + extra) capacity *= 2;
+
+    uint8_t *code = realloc(b->code, capacity);
+    if (!code) {
+        b->failed = true;
+        return;
+    }
+    b->code = code;
+    b->capacity = capacity;
+}
+
+static void emit8(jit_buf_t *b, uint8_t byte) {
+    buf_reserve(b, 1);
+    if (b->failed) return;
+    b->code[b->length++] = byte;
+}
+
+static void emit32(jit_buf_t *b, uint32_t value) {
+    buf_reserve(b, 4);
+    if (b->failed) return;
+    memcpy(b->code + b->length, &value, 4);
+    b->length += 4;
+}
+
+static void emit64(jit_buf_t *b, uint64_t value) {
+    buf_reserve(b, 8);
+    if (b->failed) return;
+    memcpy(b->code + b->length, &value, 8);
+    b->length += 8;
+}
+
+static void add_fixup(jit_buf_t *b, size_t pos, int label, fixup_kind_t kind) {
+    if (b->failed) return;
+
+    if (b->fixup_count >= b->fixup_capacity) {
+        int capacity = b->fixup_capacity ? b->fixup_capacity * 2 : 64;
+        fixup_t *fixups = realloc(b->fixups, sizeof(fixup_t) * capacity);
+        if (!fixups) {
+            b->failed = true;
+            return;
+        }
+        b->fixups = fixups;
+        b->fixup_capacity = capacity;
+    }
+
+    b->fixups[b->fixup_count].pos = pos;
+    b->fixups[b->fixup_count].label = label;
+    b->fixups[b->fixup_count].kind = kind;
+    b->fixup_count++;
+}
+
+static void patch_branch(jit_buf_t *b, size_t pos, size_t target, fixup_kind_t kind) {
+    if (kind == FIX_REL32) {
+        int32_t rel = (int32_t)((int64_t)target - (int64_t)(pos + 4));
+        memcpy(b->code + pos, &rel, 4);
+        return;
+    }
+
+    uint32_t insn;
+    int64_t words = ((int64_t)target - (int64_t)pos) / 4;
+    memcpy(&insn, b->code + pos, 4);
+    if (kind == FIX_IMM19) {
+        insn = (insn & ~(0x7FFFFu << 5)) | (((uint32_t)words & 0x7FFFF) << 5);
+    } else {
+        insn = (insn & ~0x3FFFFFFu) | ((uint32_t)words & 0x3FFFFFF);
+    }
+    memcpy(b->code + pos, &insn, 4);
+}
+
+/* Point a forward branch inside a template at the current position */
+static void bind_here(jit_buf_t *b, size_t pos, fixup_kind_t kind) {
+    if (b->failed) return;
+    patch_branch(b, pos, b->length, kind);
+}
+
+static void resolve_fixups(jit_buf_t *b) {
+    for (int i = 0; i < b->fixup_count && !b->failed; i++) {
+        fixup_t *fix = &b->fixups[i];
+        size_t target = (fix->label >= 0) ? b->instr_offset[fix->label]
+                                           : b->label_offset[-1 - fix->label];
+        patch_branch(b, fix->pos, target, fix->kind);
+    }
+}
+
+#if defined(__x86_64__)
+
+/*
+ * x86-64 backend (System V ABI).
+ * rbx = ctx, r12 = data stack, r13 = stack cells, r14d = loop base.
+ * Templates keep sp in memory so helpers and builtins see it.
+ */
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+#define R_CTX   RBX
+#define R_DS    R12
+#define R_DATA  R13
+#define R_BASE  R14
+
+/* Condition codes */
+enum { CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_S = 0x8, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF, CC_ALWAYS = -1 };
+
+static void x64_rex(jit_buf_t *b, int w, int reg, int index, int base) {
+    uint8_t rex = 0x40 | (w << 3) | ((reg & 8) >> 1) | ((index & 8) >> 2) | ((base & 8) >> 3);
+    if (rex != 0x40) emit8(b, rex);
+}
+
+static void x64_opcode(jit_buf_t *b, int op) {
+    if (op > 0xFF) emit8(b, (uint8_t)(op >> 8));
+    emit8(b, (uint8_t)op);
+}
+
+/* op reg, [base + disp] */
+static void x64_mem(jit_buf_t *b, int w, int op, int reg, int base, int32_t disp) {
+    bool short_disp = disp >= -128 && disp <= 127;
+
+    x64_rex(b, w, reg, 0, base);
+    x64_opcode(b, op);
+    emit8(b, (uint8_t)((short_disp ? 0x40 : 0x80) | ((reg & 7) << 3) | (base & 7)));
+    if ((base & 7) == RSP) emit8(b, 0x24);
+    if (short_disp) emit8(b, (uint8_t)disp);
+    else emit32(b, (uint32_t)disp);
+}
+
+/* op reg, [base + index*8 + disp32] */
+static void x64_mem_index(jit_buf_t *b, int w, int op, int reg, int base, int index, int32_t disp) {
+    x64_rex(b, w, reg, index, base);
+    x64_opcode(b, op);
+    emit8(b, (uint8_t)(0x80 | ((reg & 7) << 3) | 4));
+    emit8(b, (uint8_t)(0xC0 | ((index & 7) << 3) | (base & 7)));
+    emit32(b, (uint32_t)disp);
+}
+
+/* op reg, rm (register direct) */
+static void x64_reg(jit_buf_t *b, int w, int op, int reg, int rm) {
+    x64_rex(b, w, reg, 0, rm);
+    x64_opcode(b, op);
+    emit8(b, (uint8_t)(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+}
+
+static void x64_mov_imm64(jit_buf_t *b, int reg, uint64_t value) {
+    x64_rex(b, 1, 0, 0, reg);
+    emit8(b, (uint8_t)(0xB8 | (reg & 7)));
+    emit64(b, value);
+}
+
+static void x64_jump(jit_buf_t *b, int cc, int label) {
+    if (cc == CC_ALWAYS) {
+        emit8(b, 0xE9);
+    } else {
+        emit8(b, 0x0F);
+        emit8(b, (uint8_t)(0x80 | cc));
+    }
+    add_fixup(b, b->length, label, FIX_REL32);
+    emit32(b, 0);
+}
+
+/* Forward branch within a template; bind with bind_here */
+static size_t x64_jump_local(jit_buf_t *b, int cc) {
+    if (cc == CC_ALWAYS) {
+        emit8(b, 0xE9);
+    } else {
+        emit8(b, 0x0F);
+        emit8(b, (uint8_t)(0x80 | cc));
+    }
+    size_t pos = b->length;
+    emit32(b, 0);
+    return pos;
+}
+
+/* helper(ctx [, arg]) with the result tested against zero */
+static void x64_call(jit_buf_t *b, uint64_t fn, bool has_arg, uint64_t arg) {
+    x64_reg(b, 1, 0x89, R_CTX, RDI);            /* mov rdi, rbx */
+    if (has_arg) x64_mov_imm64(b, RSI, arg);    /* mov rsi, arg */
+    x64_mov_imm64(b, RAX, fn);
+    x64_reg(b, 0, 0xFF, 2, RAX);                /* call rax */
+    x64_reg(b, 0, 0x85, RAX, RAX);              /* test eax, eax */
+}
+
+/* Slow path: run the builtin the primitive was compiled from */
+static void x64_call_word(jit_buf_t *b, word_t *word) {
+    x64_call(b, FN_ADDR(helper_call), true, PTR_ADDR(word));
+    x64_jump(b, CC_NE, EXIT_LABEL(LABEL_ERROR));
+}
+
+static void x64_load_sp(jit_buf_t *b, int reg) {
+    x64_mem(b, 0, 0x8B, reg, R_DS, OFF_SP);
+}
+
+static void x64_store_sp(jit_buf_t *b, int reg) {
+    x64_mem(b, 0, 0x89, reg, R_DS, OFF_SP);
+}
+
+/* rax = &cells[eax] */
+static void x64_cell_addr(jit_buf_t *b) {
+    x64_reg(b, 1, 0x63, RAX, RAX);              /* movsxd rax, eax */
+    x64_reg(b, 1, 0xC1, 4, RAX);                /* shl rax, log2(cell) */
+    emit8(b, CELL_SHIFT);
+    x64_reg(b, 1, 0x03, RAX, R_DATA);           /* add rax, r13 */
+}
+
+/* eax = sp, branching to target if fewer than n cells */
+static void x64_need(jit_buf_t *b, int n, int label) {
+    x64_load_sp(b, RAX);
+    x64_reg(b, 0, 0x83, 7, RAX);                /* cmp eax, n-1 */
+    emit8(b, (uint8_t)(n - 1));
+    x64_jump(b, CC_L, label);
+}
+
+static size_t x64_need_local(jit_buf_t *b, int n) {
+    x64_load_sp(b, RAX);
+    x64_reg(b, 0, 0x83, 7, RAX);
+    emit8(b, (uint8_t)(n - 1));
+    return x64_jump_local(b, CC_L);
+}
+
+/* ecx = sp + n, checked against the stack size and stored */
+static void x64_grow(jit_buf_t *b, int n) {
+    x64_mem(b, 0, 0x8D, RCX, RAX, n);           /* lea ecx, [rax+n] */
+    x64_mem(b, 0, 0x3B, RCX, R_DS, OFF_SIZE);   /* cmp ecx, [r12+size] */
+    x64_jump(b, CC_GE, EXIT_LABEL(LABEL_OVERFLOW));
+    x64_store_sp(b, RCX);
+}
+
+static void x64_shrink(jit_buf_t *b, int n) {
+    x64_mem(b, 0, 0x83, 5, R_DS, OFF_SP);       /* sub dword [r12+sp], n */
+    emit8(b, (uint8_t)n);
+}
+
+/* Branch to label unless the cell at [rax+disp] is an integer */
+static void x64_require_int(jit_buf_t *b, int32_t disp, size_t *slow, int *slow_count) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    (void)b; (void)disp; (void)slow; (void)slow_count;     /* every cell is */
+#else
+    x64_mem(b, 0, 0x83, 7, RAX, disp + OFF_TYPE);   /* cmp dword [rax+type], CELL_INT */
+    emit8(b, CELL_INT);
+    slow[(*slow_count)++] = x64_jump_local(b, CC_NE);
+#endif
+}
+
+/* Whole-cell moves through scratch n: xmm0/xmm1, or rdx/rsi for 8-byte cells */
+static void x64_load_cell(jit_buf_t *b, int n, int base, int32_t disp) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    x64_mem(b, 1, 0x8B, n ? RSI : RDX, base, disp);
+#else
+    x64_mem(b, 0, 0x0F10, n, base, disp);           /* movups xmmN, [base+disp] */
+#endif
+}
+
+static void x64_store_cell(jit_buf_t *b, int n, int base, int32_t disp) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    x64_mem(b, 1, 0x89, n ? RSI : RDX, base, disp);
+#else
+    x64_mem(b, 0, 0x0F11, n, base, disp);           /* movups [base+disp], xmmN */
+#endif
+}
+
+static void x64_prologue(jit_buf_t *b) {
+    emit8(b, 0x53);                             /* push rbx */
+    emit8(b, 0x41); emit8(b, 0x54);             /* push r12 */
+    emit8(b, 0x41); emit8(b, 0x55);             /* push r13 */
+    emit8(b, 0x41); emit8(b, 0x56);             /* push r14 */
+    x64_reg(b, 1, 0x83, 5, RSP);                /* sub rsp, 8 (keep 16-byte alignment) */
+    emit8(b, 8);
+    x64_reg(b, 1, 0x89, RDI, R_CTX);            /* mov rbx, rdi */
+    x64_reg(b, 1, 0x89, RSI, R_DS);             /* mov r12, rsi */
+    x64_reg(b, 0, 0x89, RDX, R_BASE);           /* mov r14d, edx */
+    x64_mem(b, 1, 0x8B, R_DATA, R_DS, OFF_DATA);    /* mov r13, [r12+data] */
+}
+
+static void x64_epilogue(jit_buf_t *b) {
+    b->label_offset[LABEL_RET_OK] = b->length;
+    x64_reg(b, 0, 0x31, RAX, RAX);              /* xor eax, eax */
+    b->label_offset[LABEL_RET] = b->length;
+    x64_reg(b, 1, 0x83, 0, RSP);                /* add rsp, 8 */
+    emit8(b, 8);
+    emit8(b, 0x41); emit8(b, 0x5E);             /* pop r14 */
+    emit8(b, 0x41); emit8(b, 0x5D);             /* pop r13 */
+    emit8(b, 0x41); emit8(b, 0x5C);             /* pop r12 */
+    emit8(b, 0x5B);                             /* pop rbx */
+    emit8(b, 0xC3);                             /* ret */
+
+    static const struct { int label; int code; } exits[] = {
+        {LABEL_ERROR, JIT_RET_ERROR},
+        {LABEL_UNDERFLOW, JIT_RET_UNDERFLOW},
+        {LABEL_OVERFLOW, JIT_RET_OVERFLOW},
+        {LABEL_LOOP, JIT_RET_LOOP}
+    };
+    for (size_t i = 0; i < sizeof(exits) / sizeof(exits[0]); i++) {
+        b->label_offset[exits[i].label] = b->length;
+        emit8(b, 0xB8);                         /* mov eax, code */
+        emit32(b, (uint32_t)exits[i].code);
+        x64_jump(b, CC_ALWAYS, EXIT_LABEL(LABEL_RET));
+    }
+}
+
+/* Integer fast path for + - and comparisons, builtin otherwise */
+static void x64_binary(jit_buf_t *b, instr_t *instr) {
+    size_t slow[4];
+    int slow_count = 0;
+
+    slow[slow_count++] = x64_need_local(b, 2);
+    x64_cell_addr(b);
+    x64_require_int(b, 0, slow, &slow_count);
+    x64_require_int(b, -CELL_SIZE, slow, &slow_count);
+
+    x64_mem(b, 1, 0x8B, RCX, RAX, OFF_VALUE);               /* mov rcx, [tos] */
+    switch (instr->op) {
+        case OP_ADD:
+            x64_mem(b, 1, 0x01, RCX, RAX, OFF_VALUE - CELL_SIZE);   /* add [nos], rcx */
+            break;
+        case OP_SUB:
+            x64_mem(b, 1, 0x29, RCX, RAX, OFF_VALUE - CELL_SIZE);   /* sub [nos], rcx */
+            break;
+        default: {
+            int cc = (instr->op == OP_EQUAL) ? CC_E : (instr->op == OP_LESS) ? CC_L : CC_G;
+            x64_mem(b, 1, 0x8B, RDX, RAX, OFF_VALUE - CELL_SIZE);   /* mov rdx, [nos] */
+            x64_reg(b, 1, 0x39, RCX, RDX);                          /* cmp rdx, rcx */
+            x64_reg(b, 0, 0x0F90 | cc, 0, RDX);                     /* setcc dl */
+            x64_reg(b, 0, 0x0FB6, RDX, RDX);                        /* movzx edx, dl */
+            x64_reg(b, 1, 0xF7, 3, RDX);                            /* neg rdx */
+            x64_mem(b, 1, 0x89, RDX, RAX, OFF_VALUE - CELL_SIZE);   /* mov [nos], rdx */
+            break;
+        }
+    }
+    x64_shrink(b, 1);
+    size_t done = x64_jump_local(b, CC_ALWAYS);
+
+    for (int i = 0; i < slow_count; i++) bind_here(b, slow[i], FIX_REL32);
+    x64_call_word(b, instr->arg.word);
+    bind_here(b, done, FIX_REL32);
+}
+
+/* Integer fast path for 1+ 1- 0= */
+static void x64_unary(jit_buf_t *b, instr_t *instr) {
+    size_t slow[2];
+    int slow_count = 0;
+
+    slow[slow_count++] = x64_need_local(b, 1);
+    x64_cell_addr(b);
+    x64_require_int(b, 0, slow, &slow_count);
+
+    switch (instr->op) {
+        case OP_ONE_PLUS:
+            x64_mem(b, 1, 0x83, 0, RAX, OFF_VALUE);     /* add qword [tos], 1 */
+            emit8(b, 1);
+            break;
+        case OP_ONE_MINUS:
+            x64_mem(b, 1, 0x83, 5, RAX, OFF_VALUE);     /* sub qword [tos], 1 */
+            emit8(b, 1);
+            break;
+        default:
+            x64_mem(b, 1, 0x83, 7, RAX, OFF_VALUE);     /* cmp qword [tos], 0 */
+            emit8(b, 0);
+            x64_reg(b, 0, 0x0F90 | CC_E, 0, RDX);       /* sete dl */
+            x64_reg(b, 0, 0x0FB6, RDX, RDX);
+            x64_reg(b, 1, 0xF7, 3, RDX);
+            x64_mem(b, 1, 0x89, RDX, RAX, OFF_VALUE);
+            break;
+    }
+    size_t done = x64_jump_local(b, CC_ALWAYS);
+
+    for (int i = 0; i < slow_count; i++) bind_here(b, slow[i], FIX_REL32);
+    x64_call_word(b, instr->arg.word);
+    bind_here(b, done, FIX_REL32);
+}
+
+/* @ and ! on cells inside data space; anything else goes to the builtin */
+static void x64_memory(jit_buf_t *b, instr_t *instr) {
+    size_t slow[5];
+    int slow_count = 0;
+    bool store = instr->op == OP_STORE;
+
+    slow[slow_count++] = x64_need_local(b, store ? 2 : 1);
+    x64_cell_addr(b);
+    x64_require_int(b, 0, slow, &slow_count);
+    x64_mem(b, 1, 0x8B, RCX, RAX, OFF_VALUE);               /* mov rcx, [tos] */
+    x64_mem(b, 1, 0x2B, RCX, R_CTX, OFF_DATA_BASE);         /* sub rcx, base: offset */
+    x64_mem(b, 1, 0x3B, RCX, R_CTX, OFF_DATA_HERE);
+    slow[slow_count++] = x64_jump_local(b, CC_AE);
+    x64_mem(b, 1, 0x8D, RDX, RCX, CELL_SIZE);               /* lea rdx, [rcx+cell] */
+    x64_mem(b, 1, 0x3B, RDX, R_CTX, OFF_DATA_HERE);
+    slow[slow_count++] = x64_jump_local(b, CC_A);
+    x64_mem(b, 1, 0x03, RCX, R_CTX, OFF_DATA_BASE);         /* add rcx, base */
+
+    if (store) {
+        x64_load_cell(b, 0, RAX, -CELL_SIZE);               /* [rcx] = nos */
+        x64_store_cell(b, 0, RCX, 0);
+        x64_shrink(b, 2);
+    } else {
+        x64_load_cell(b, 0, RCX, 0);                        /* tos = [rcx] */
+        x64_store_cell(b, 0, RAX, 0);
+    }
+    size_t done = x64_jump_local(b, CC_ALWAYS);
+
+    for (int i = 0; i < slow_count; i++) bind_here(b, slow[i], FIX_REL32);
+    x64_call_word(b, instr->arg.word);
+    bind_here(b, done, FIX_REL32);
+}
+
+static bool compile_instr(jit_buf_t *b, word_t *word, instr_t *instr) {
+    switch (instr->op) {
+        case OP_CALL:
+            x64_call_word(b, instr->arg.word);
+            return true;
+
+        case OP_CALL_NAME:
+            x64_call(b, FN_ADDR(helper_call_name), true, PTR_ADDR(instr));
+            x64_jump(b, CC_NE, EXIT_LABEL(LABEL_ERROR));
+            return true;
+
+        case OP_RECURSE:
+            x64_call_word(b, word);
+            return true;
+
+        case OP_TAIL_CALL:
+            x64_call(b, FN_ADDR(helper_tail_call), true, PTR_ADDR(instr->arg.word));
+            x64_jump(b, CC_ALWAYS, EXIT_LABEL(LABEL_RET));
+            return true;
+
+        case OP_TAIL_CALL_NAME:
+            x64_call(b, FN_ADDR(helper_tail_call_name), true, PTR_ADDR(instr));
+            x64_jump(b, CC_ALWAYS, EXIT_LABEL(LABEL_RET));
+            return true;
+
+        case OP_TAIL_RECURSE:
+            x64_mem(b, 0, 0x89, R_BASE, R_CTX, OFF_LOOP_SP);   /* drop this word's loop frames */
+            x64_jump(b, CC_ALWAYS, 0);
+            return true;
+
+        case OP_LIT:
+            x64_load_sp(b, RAX);
+            x64_grow(b, 1);
+            x64_reg(b, 0, 0x89, RCX, RAX);                  /* mov eax, ecx */
+            x64_cell_addr(b);
+#ifndef RFORTH_UNTAGGED_CELLS
+            x64_mem(b, 0, 0xC7, 0, RAX, OFF_TYPE);          /* mov dword [tos], type */
+            emit32(b, (uint32_t)instr->arg.literal.type);
+#endif
+            x64_mov_imm64(b, RCX, (uint64_t)instr->arg.literal.value.i);
+            x64_mem(b, 1, 0x89, RCX, RAX, OFF_VALUE);       /* mov [tos+value], rcx */
+            return true;
+
+        case OP_BRANCH:
+            x64_jump(b, CC_ALWAYS, instr->arg.target);
+            return true;
+
+        case OP_0BRANCH: {
+            size_t slow[2];
+            int slow_count = 0;
+            slow[slow_count++] = x64_need_local(b, 1);
+            x64_cell_addr(b);
+            x64_require_int(b, 0, slow, &slow_count);
+            x64_mem(b, 1, 0x8B, RCX, RAX, OFF_VALUE);
+            x64_shrink(b, 1);
+            x64_reg(b, 1, 0x85, RCX, RCX);                  /* test rcx, rcx */
+            x64_jump(b, CC_E, instr->arg.target);
+            size_t done = x64_jump_local(b, CC_ALWAYS);
+
+            /* Floats and underflow go through the helper */
+            for (int i = 0; i < slow_count; i++) bind_here(b, slow[i], FIX_REL32);
+            x64_call(b, FN_ADDR(helper_pop_flag), false, 0);
+            x64_jump(b, CC_S, EXIT_LABEL(LABEL_ERROR));
+            x64_jump(b, CC_E, instr->arg.target);
+            bind_here(b, done, FIX_REL32);
+            return true;
+        }
+
+        case OP_DO: {
+            size_t slow[4];
+            int slow_count = 0;
+            slow[slow_count++] = x64_need_local(b, 2);
+            x64_cell_addr(b);
+            x64_require_int(b, 0, slow, &slow_count);
+            x64_require_int(b, -CELL_SIZE, slow, &slow_count);
+            x64_mem(b, 0, 0x8B, RCX, R_CTX, OFF_LOOP_SP);   /* mov ecx, [ctx+do_loop_sp] */
+            x64_mem(b, 0, 0x3B, RCX, R_CTX, OFF_LOOP_CAP);  /* full: the helper grows it */
+            slow[slow_count++] = x64_jump_local(b, CC_GE);
+
+            x64_reg(b, 1, 0x63, RCX, RCX);                  /* movsxd rcx, ecx */
+            x64_mem(b, 1, 0x8B, RDX, RAX, OFF_VALUE);       /* index */
+            x64_mem(b, 1, 0x8B, RSI, RAX, OFF_VALUE - CELL_SIZE);   /* limit */
+            x64_mem(b, 1, 0x8B, R8, R_CTX, OFF_LOOP_INDEX);
+            x64_mem_index(b, 1, 0x89, RDX, R8, RCX, 0);
+            x64_mem(b, 1, 0x8B, R8, R_CTX, OFF_LOOP_LIMIT);
+            x64_mem_index(b, 1, 0x89, RSI, R8, RCX, 0);
+            x64_reg(b, 0, 0x83, 0, RCX);                    /* add ecx, 1 */
+            emit8(b, 1);
+            x64_mem(b, 0, 0x89, RCX, R_CTX, OFF_LOOP_SP);
+            x64_shrink(b, 2);
+            size_t done = x64_jump_local(b, CC_ALWAYS);
+
+            for (int i = 0; i < slow_count; i++) bind_here(b, slow[i], FIX_REL32);
+            x64_call(b, FN_ADDR(helper_do), false, 0);
+            x64_jump(b, CC_NE, EXIT_LABEL(LABEL_ERROR));
+            bind_here(b, done, FIX_REL32);
+            return true;
+        }
+
+        case OP_LOOP:
+            x64_mem(b, 0, 0x8B, RCX, R_CTX, OFF_LOOP_SP);
+            x64_reg(b, 0, 0x83, 5, RCX);                    /* sub ecx, 1 */
+            emit8(b, 1);
+            x64_reg(b, 0, 0x3B, RCX, R_BASE);               /* cmp ecx, r14d */
+            x64_jump(b, CC_L, EXIT_LABEL(LABEL_LOOP));
+            x64_reg(b, 1, 0x63, RCX, RCX);
+            x64_mem(b, 1, 0x8B, R8, R_CTX, OFF_LOOP_INDEX);
+            x64_mem_index(b, 1, 0x8B, RDX, R8, RCX, 0);
+            x64_reg(b, 1, 0x83, 0, RDX);                    /* add rdx, 1 */
+            emit8(b, 1);
+            x64_mem_index(b, 1, 0x89, RDX, R8, RCX, 0);
+            x64_mem(b, 1, 0x8B, R8, R_CTX, OFF_LOOP_LIMIT);
+            x64_mem_index(b, 1, 0x3B, RDX, R8, RCX, 0);
+            x64_jump(b, CC_L, instr->arg.target);
+            x64_mem(b, 0, 0x89, RCX, R_CTX, OFF_LOOP_SP);   /* drop loop frame */
+            return true;
+
+        case OP_PLUS_LOOP:
+            x64_reg(b, 1, 0x89, R_CTX, RDI);
+            x64_reg(b, 0, 0x89, R_BASE, RSI);               /* mov esi, r14d */
+            x64_mov_imm64(b, RAX, FN_ADDR(helper_plus_loop));
+            x64_reg(b, 0, 0xFF, 2, RAX);
+            x64_reg(b, 0, 0x85, RAX, RAX);
+            x64_jump(b, CC_S, EXIT_LABEL(LABEL_ERROR));
+            x64_jump(b, CC_NE, instr->arg.target);
+            return true;
+
+        case OP_LEAVE: {
+            x64_mem(b, 0, 0x8B, RCX, R_CTX, OFF_LOOP_SP);
+            x64_reg(b, 0, 0x3B, RCX, R_BASE);
+            size_t skip = x64_jump_local(b, CC_LE);
+            x64_reg(b, 0, 0x83, 5, RCX);
+            emit8(b, 1);
+            x64_mem(b, 0, 0x89, RCX, R_CTX, OFF_LOOP_SP);
+            bind_here(b, skip, FIX_REL32);
+            x64_jump(b, CC_ALWAYS, instr->arg.target);
+            return true;
+        }
+
+        case OP_EXIT:
+            x64_jump(b, CC_ALWAYS, EXIT_LABEL(LABEL_RET_OK));
+            return true;
+
+        case OP_TYPE:
+            x64_mov_imm64(b, RDI, PTR_ADDR(instr));
+            x64_mov_imm64(b, RAX, FN_ADDR(helper_type));
+            x64_reg(b, 0, 0xFF, 2, RAX);
+            return true;
+
+        case OP_SLIT:
+            x64_call(b, FN_ADDR(helper_slit), true, PTR_ADDR(instr));
+            x64_jump(b, CC_NE, EXIT_LABEL(LABEL_ERROR));
+            return true;
+
+        case OP_FLIT:
+            x64_call(b, FN_ADDR(helper_flit), true, PTR_ADDR(instr));
+            x64_jump(b, CC_NE, EXIT_LABEL(LABEL_ERROR));
+            return true;
+
+        case OP_DUP:
+        case OP_OVER: {
+            int n = (instr->op == OP_DUP) ? 1 : 2;
+            x64_need(b, n, EXIT_LABEL(LABEL_UNDERFLOW));
+            x64_grow(b, 1);
+            x64_cell_addr(b);
+            x64_load_cell(b, 0, RAX, -(n - 1) * CELL_SIZE);
+            x64_store_cell(b, 0, RAX, CELL_SIZE);
+            return true;
+        }
+
+        case OP_DROP:
+            x64_need(b, 1, EXIT_LABEL(LABEL_UNDERFLOW));
+            x64_shrink(b, 1);
+            return true;
+
+        case OP_SWAP:
+            x64_need(b, 2, EXIT_LABEL(LABEL_UNDERFLOW));
+            x64_cell_addr(b);
+            x64_load_cell(b, 0, RAX, 0);
+            x64_load_cell(b, 1, RAX, -CELL_SIZE);
+            x64_store_cell(b, 0, RAX, -CELL_SIZE);
+            x64_store_cell(b, 1, RAX, 0);
+            return true;
+
+        case OP_ADD:
+        case OP_SUB:
+        case OP_EQUAL:
+        case OP_LESS:
+        case OP_GREATER:
+            x64_binary(b, instr);
+            return true;
+
+        case OP_ZERO_EQUAL:
+        case OP_ONE_PLUS:
+        case OP_ONE_MINUS:
+            x64_unary(b, instr);
+            return true;
+
+        case OP_FETCH:
+        case OP_STORE:
+            x64_memory(b, instr);
+            return true;
+
+        case OP_I: {
+            x64_mem(b, 0, 0x8B, RCX, R_CTX, OFF_LOOP_SP);
+            x64_reg(b, 0, 0x85, RCX, RCX);
+            size_t slow = x64_jump_local(b, CC_LE);
+            x64_load_sp(b, RAX);
+            x64_reg(b, 0, 0x89, RCX, RDX);                  /* mov edx, ecx */
+            x64_grow(b, 1);
+            x64_reg(b, 0, 0x89, RCX, RAX);
+            x64_cell_addr(b);
+            x64_reg(b, 1, 0x63, RDX, RDX);
+            x64_mem(b, 1, 0x8B, R8, R_CTX, OFF_LOOP_INDEX);
+            x64_mem_index(b, 1, 0x8B, RDX, R8, RDX, -8);
+#ifndef RFORTH_UNTAGGED_CELLS
+            x64_mem(b, 0, 0xC7, 0, RAX, OFF_TYPE);
+            emit32(b, CELL_INT);
+#endif
+            x64_mem(b, 1, 0x89, RDX, RAX, OFF_VALUE);
+            size_t done = x64_jump_local(b, CC_ALWAYS);
+            bind_here(b, slow, FIX_REL32);
+            x64_call_word(b, instr->arg.word);
+            bind_here(b, done, FIX_REL32);
+            return true;
+        }
+
+        case OP_MUL:
+        case OP_J:
+            x64_call_word(b, instr->arg.word);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+#define arch_prologue   x64_prologue
+#define arch_epilogue   x64_epilogue
+
+#elif defined(__aarch64__)
+
+/*
+ * AArch64 backend (AAPCS64).
+ * x19 = ctx, x20 = data stack, x21 = stack cells, w22 = loop base.
+ * Templates keep sp in memory so helpers and builtins see it.
+ */
+
+#define R_CTX   19
+#define R_DS    20
+#define R_DATA  21
+#define R_BASE  22
+#define XZR     31
+
+/* Condition codes */
+enum { CC_EQ = 0x0, CC_NE = 0x1, CC_HS = 0x2, CC_MI = 0x4, CC_HI = 0x8, CC_GE = 0xA, CC_LT = 0xB, CC_GT = 0xC, CC_LE = 0xD };
+
+#define A64_LDR_W(t, n, off)    (0xB9400000u | ((uint32_t)(off) / 4) << 10 | (n) << 5 | (t))
+#define A64_STR_W(t, n, off)    (0xB9000000u | ((uint32_t)(off) / 4) << 10 | (n) << 5 | (t))
+#define A64_LDR_X(t, n, off)    (0xF9400000u | ((uint32_t)(off) / 8) << 10 | (n) << 5 | (t))
+#define A64_LDUR_W(t, n, off)   (0xB8400000u | ((uint32_t)(off) & 0x1FF) << 12 | (n) << 5 | (t))
+#define A64_STUR_W(t, n, off)   (0xB8000000u | ((uint32_t)(off) & 0x1FF) << 12 | (n) << 5 | (t))
+#define A64_LDUR_X(t, n, off)   (0xF8400000u | ((uint32_t)(off) & 0x1FF) << 12 | (n) << 5 | (t))
+#define A64_STUR_X(t, n, off)   (0xF8000000u | ((uint32_t)(off) & 0x1FF) << 12 | (n) << 5 | (t))
+#define A64_LDUR_Q(t, n, off)   (0x3CC00000u | ((uint32_t)(off) & 0x1FF) << 12 | (n) << 5 | (t))
+#define A64_STUR_Q(t, n, off)   (0x3C800000u | ((uint32_t)(off) & 0x1FF) << 12 | (n) << 5 | (t))
+#define A64_LDR_X_LSL3(t, n, m) (0xF8607800u | (m) << 16 | (n) << 5 | (t))
+#define A64_STR_X_LSL3(t, n, m) (0xF8207800u | (m) << 16 | (n) << 5 | (t))
+#define A64_ADD_W_IMM(d, n, i)  (0x11000000u | (uint32_t)(i) << 10 | (n) << 5 | (d))
+#define A64_SUB_W_IMM(d, n, i)  (0x51000000u | (uint32_t)(i) << 10 | (n) << 5 | (d))
+#define A64_ADD_X_IMM(d, n, i)  (0x91000000u | (uint32_t)(i) << 10 | (n) << 5 | (d))
+#define A64_SUB_X_IMM(d, n, i)  (0xD1000000u | (uint32_t)(i) << 10 | (n) << 5 | (d))
+#define A64_CMP_W_IMM(n, i)     (0x7100001Fu | (uint32_t)(i) << 10 | (n) << 5)
+#define A64_CMP_X_IMM(n, i)     (0xF100001Fu | (uint32_t)(i) << 10 | (n) << 5)
+#define A64_CMP_W(n, m)         (0x6B00001Fu | (m) << 16 | (n) << 5)
+#define A64_CMP_X(n, m)         (0xEB00001Fu | (m) << 16 | (n) << 5)
+#define A64_ADD_X(d, n, m)      (0x8B000000u | (m) << 16 | (n) << 5 | (d))
+#define A64_SUB_X(d, n, m)      (0xCB000000u | (m) << 16 | (n) << 5 | (d))
+#define A64_ADD_X_LSL(d, n, m, s) (0x8B000000u | (m) << 16 | (uint32_t)(s) << 10 | (n) << 5 | (d))
+#define A64_SXTW(d, n)          (0x93407C00u | (n) << 5 | (d))
+#define A64_MOV_X(d, m)         (0xAA0003E0u | (m) << 16 | (d))
+#define A64_MOV_W(d, m)         (0x2A0003E0u | (m) << 16 | (d))
+#define A64_MOVZ_X(d, i, hw)    (0xD2800000u | (uint32_t)(hw) << 21 | (uint32_t)(i) << 5 | (d))
+#define A64_MOVK_X(d, i, hw)    (0xF2800000u | (uint32_t)(hw) << 21 | (uint32_t)(i) << 5 | (d))
+#define A64_CSETM_X(d, cond)    (0xDA9F03E0u | (uint32_t)((cond) ^ 1) << 12 | (d))
+#define A64_BLR(n)              (0xD63F0000u | (n) << 5)
+#define A64_B_COND(cond)        (0x54000000u | (cond))
+#define A64_B                   0x14000000u
+#define A64_CBZ_X(t)            (0xB4000000u | (t))
+#define A64_CBNZ_W(t)           (0x35000000u | (t))
+#define A64_RET                 0xD65F03C0u
+
+static void a64_mov_imm64(jit_buf_t *b, int reg, uint64_t value) {
+    emit32(b, A64_MOVZ_X(reg, value & 0xFFFF, 0));
+    for (int hw = 1; hw < 4; hw++) {
+        uint32_t part = (uint32_t)(value >> (hw * 16)) & 0xFFFF;
+        if (part) emit32(b, A64_MOVK_X(reg, part, hw));
+    }
+}
+
+static void a64_branch(jit_buf_t *b, uint32_t insn, int label) {
+    add_fixup(b, b->length, label, (insn & 0xFC000000u) == A64_B ? FIX_IMM26 : FIX_IMM19);
+    emit32(b, insn);
+}
+
+static size_t a64_branch_local(jit_buf_t *b, uint32_t insn) {
+    size_t pos = b->length;
+    emit32(b, insn);
+    return pos;
+}
+
+static void a64_bind(jit_buf_t *b, size_t pos) {
+    uint32_t insn;
+    if (b->failed) return;
+    memcpy(&insn, b->code + pos, 4);
+    bind_here(b, pos, (insn & 0xFC000000u) == A64_B ? FIX_IMM26 : FIX_IMM19);
+}
+
+/* helper(ctx [, arg]) leaving the result in w0 */
+static void a64_call(jit_buf_t *b, uint64_t fn, bool has_arg, uint64_t arg) {
+    emit32(b, A64_MOV_X(0, R_CTX));
+    if (has_arg) a64_mov_imm64(b, 1, arg);
+    a64_mov_imm64(b, 16, fn);
+    emit32(b, A64_BLR(16));
+}
+
+/* Slow path: run the builtin the primitive was compiled from */
+static void a64_call_word(jit_buf_t *b, word_t *word) {
+    a64_call(b, FN_ADDR(helper_call), true, PTR_ADDR(word));
+    a64_branch(b, A64_CBNZ_W(0), EXIT_LABEL(LABEL_ERROR));
+}
+
+/* x0 = &cells[w0] */
+static void a64_cell_addr(jit_buf_t *b) {
+    emit32(b, A64_SXTW(0, 0));
+    emit32(b, A64_ADD_X_LSL(0, R_DATA, 0, CELL_SHIFT));
+}
+
+/* x10 = ctx + offset */
+static void a64_ctx_field(jit_buf_t *b, int reg, int32_t offset) {
+    a64_mov_imm64(b, reg, (uint64_t)offset);
+    emit32(b, A64_ADD_X(reg, R_CTX, reg));
+}
+
+/* w0 = sp, branching if fewer than n cells */
+static void a64_need(jit_buf_t *b, int n, int label) {
+    emit32(b, A64_LDR_W(0, R_DS, OFF_SP));
+    emit32(b, A64_CMP_W_IMM(0, n - 1));
+    a64_branch(b, A64_B_COND(CC_LT), label);
+}
+
+static size_t a64_need_local(jit_buf_t *b, int n) {
+    emit32(b, A64_LDR_W(0, R_DS, OFF_SP));
+    emit32(b, A64_CMP_W_IMM(0, n - 1));
+    return a64_branch_local(b, A64_B_COND(CC_LT));
+}
+
+/* w1 = sp + n, checked against the stack size and stored */
+static void a64_grow(jit_buf_t *b, int n) {
+    emit32(b, A64_ADD_W_IMM(1, 0, n));
+    emit32(b, A64_LDR_W(2, R_DS, OFF_SIZE));
+    emit32(b, A64_CMP_W(1, 2));
+    a64_branch(b, A64_B_COND(CC_GE), EXIT_LABEL(LABEL_OVERFLOW));
+    emit32(b, A64_STR_W(1, R_DS, OFF_SP));
+}
+
+static void a64_shrink(jit_buf_t *b, int n) {
+    emit32(b, A64_LDR_W(1, R_DS, OFF_SP));
+    emit32(b, A64_SUB_W_IMM(1, 1, n));
+    emit32(b, A64_STR_W(1, R_DS, OFF_SP));
+}
+
+/* Branch to the slow path unless the cell at [x0+disp] is an integer */
+static void a64_require_int(jit_buf_t *b, int32_t disp, size_t *slow, int *slow_count) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    (void)b; (void)disp; (void)slow; (void)slow_count;     /* every cell is */
+#else
+    emit32(b, A64_LDUR_W(1, 0, disp + OFF_TYPE));
+    emit32(b, A64_CMP_W_IMM(1, CELL_INT));
+    slow[(*slow_count)++] = a64_branch_local(b, A64_B_COND(CC_NE));
+#endif
+}
+
+/* Whole-cell moves through scratch n: q0/q1, or x6/x7 for 8-byte cells */
+static void a64_load_cell(jit_buf_t *b, int n, int base, int32_t off) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    emit32(b, A64_LDUR_X(6 + n, base, off));
+#else
+    emit32(b, A64_LDUR_Q(n, base, off));
+#endif
+}
+
+static void a64_store_cell(jit_buf_t *b, int n, int base, int32_t off) {
+#ifdef RFORTH_UNTAGGED_CELLS
+    emit32(b, A64_STUR_X(6 + n, base, off));
+#else
+    emit32(b, A64_STUR_Q(n, base, off));
+#endif
+}
+
+static void a64_prologue(jit_buf_t *b) {
+    emit32(b, 0xA9BD7BFDu);                     /* stp x29, x30, [sp, #-48]! */
+    emit32(b, 0x910003FDu);                     /* mov x29, sp */
+    emit32(b, 0xA90153F3u);                     /* stp x19, x20, [sp, #16] */
+    emit32(b, 0xA9025BF5u);                     /* stp x21, x22, [sp, #32] */
+    emit32(b, A64_MOV_X(R_CTX, 0));
+    emit32(b, A64_MOV_X(R_DS, 1));
+    emit32(b, A64_MOV_W(R_BASE, 2));
+    emit32(b, A64_LDR_X(R_DATA, R_DS, OFF_DATA));
+}
+
+static void a64_epilogue(jit_buf_t *b) {
+    b->label_offset[LABEL_RET_OK] = b->length;
+    emit32(b, A64_MOV_W(0, XZR));
+    b->label_offset[LABEL_RET] = b->length;
+    emit32(b, 0xA9425BF5u);                     /* ldp x21, x22, [sp, #32] */
+    emit32(b, 0xA94153F3u);                     /* ldp x19, x20, [sp, #16] */
+    emit32(b, 0xA8C37BFDu);                     /* ldp x29, x30, [sp], #48 */
+    emit32(b, A64_RET);
+
+    static const struct { int label; int code; } exits[] = {
+        {LABEL_ERROR, JIT_RET_ERROR},
+        {LABEL_UNDERFLOW, JIT_RET_UNDERFLOW},
+        {LABEL_OVERFLOW, JIT_RET_OVERFLOW},
+        {LABEL_LOOP, JIT_RET_LOOP}
+    };
+    for (size_t i = 0; i < sizeof(exits) / sizeof(exits[0]); i++) {
+        b->label_offset[exits[i].label] = b->length;
+        emit32(b, A64_MOVZ_X(0, exits[i].code, 0));
+        a64_branch(b, A64_B, EXIT_LABEL(LABEL_RET));
+    }
+}
+
+/* Integer fast path for + - and comparisons, builtin otherwise */
+static void a64_binary(jit_buf_t *b, instr_t *instr) {
+    size_t slow[4];
+    int slow_count = 0;
+
+    slow[slow_count++] = a64_need_local(b, 2);
+    a64_cell_addr(b);
+    a64_require_int(b, 0, slow, &slow_count);
+    a64_require_int(b, -CELL_SIZE, slow, &slow_count);
+
+    emit32(b, A64_LDUR_X(2, 0, OFF_VALUE - CELL_SIZE));     /* nos */
+    emit32(b, A64_LDUR_X(3, 0, OFF_VALUE));                 /* tos */
+    switch (instr->op) {
+        case OP_ADD:
+            emit32(b, A64_ADD_X(2, 2, 3));
+            break;
+        case OP_SUB:
+            emit32(b, A64_SUB_X(2, 2, 3));
+            break;
+        default: {
+            int cc = (instr->op == OP_EQUAL) ? CC_EQ : (instr->op == OP_LESS) ? CC_LT : CC_GT;
+            emit32(b, A64_CMP_X(2, 3));
+            emit32(b, A64_CSETM_X(2, cc));
+            break;
+        }
+    }
+    emit32(b, A64_STUR_X(2, 0, OFF_VALUE - CELL_SIZE));
+    a64_shrink(b, 1);
+    size_t done = a64_branch_local(b, A64_B);
+
+    for (int i = 0; i < slow_count; i++) a64_bind(b, slow[i]);
+    a64_call_word(b, instr->arg.word);
+    a64_bind(b, done);
+}
+
+/* Integer fast path for 1+ 1- 0= */
+static void a64_unary(jit_buf_t *b, instr_t *instr) {
+    size_t slow[2];
+    int slow_count = 0;
+
+    slow[slow_count++] = a64_need_local(b, 1);
+    a64_cell_addr(b);
+    a64_require_int(b, 0, slow, &slow_count);
+
+    emit32(b, A64_LDUR_X(2, 0, OFF_VALUE));
+    switch (instr->op) {
+        case OP_ONE_PLUS:
+            emit32(b, A64_ADD_X_IMM(2, 2, 1));
+            break;
+        case OP_ONE_MINUS:
+            emit32(b, A64_SUB_X_IMM(2, 2, 1));
+            break;
+        default:
+            emit32(b, A64_CMP_X_IMM(2, 0));
+            emit32(b, A64_CSETM_X(2, CC_EQ));
+            break;
+    }
+    emit32(b, A64_STUR_X(2, 0, OFF_VALUE));
+    size_t done = a64_branch_local(b, A64_B);
+
+    for (int i = 0; i < slow_count; i++) a64_bind(b, slow[i]);
+    a64_call_word(b, instr->arg.word);
+    a64_bind(b, done);
+}
+
+/* @ and ! on cells inside data space; anything else goes to the builtin */
+static void a64_memory(jit_buf_t *b, instr_t *instr) {
+    size_t slow[5];
+    int slow_count = 0;
+    bool store = instr->op == OP_STORE;
+
+    slow[slow_count++] = a64_need_local(b, store ? 2 : 1);
+    a64_cell_addr(b);
+    a64_require_int(b, 0, slow, &slow_count);
+    emit32(b, A64_LDUR_X(2, 0, OFF_VALUE));
+    a64_ctx_field(b, 3, OFF_DATA_BASE);
+    emit32(b, A64_LDR_X(3, 3, 0));
+    a64_ctx_field(b, 4, OFF_DATA_HERE);
+    emit32(b, A64_LDR_X(4, 4, 0));
+    emit32(b, A64_SUB_X(2, 2, 3));                          /* offset */
+    emit32(b, A64_CMP_X(2, 4));
+    slow[slow_count++] = a64_branch_local(b, A64_B_COND(CC_HS));
+    emit32(b, A64_ADD_X_IMM(5, 2, CELL_SIZE));
+    emit32(b, A64_CMP_X(5, 4));
+    slow[slow_count++] = a64_branch_local(b, A64_B_COND(CC_HI));
+    emit32(b, A64_ADD_X(2, 2, 3));
+
+    if (store) {
+        a64_load_cell(b, 0, 0, -CELL_SIZE);
+        a64_store_cell(b, 0, 2, 0);
+        a64_shrink(b, 2);
+    } else {
+        a64_load_cell(b, 0, 2, 0);
+        a64_store_cell(b, 0, 0, 0);
+    }
+    size_t done = a64_branch_local(b, A64_B);
+
+    for (int i = 0; i < slow_count; i++) a64_bind(b, slow[i]);
+    a64_call_word(b, instr->arg.word);
+    a64_bind(b, done);
+}
+
+static bool compile_instr(jit_buf_t *b, word_t *word, instr_t *instr) {
+    switch (instr->op) {
+        case OP_CALL:
+            a64_call_word(b, instr->arg.word);
+            return true;
+
+        case OP_CALL_NAME:
+            a64_call(b, FN_ADDR(helper_call_name), true, PTR_ADDR(instr));
+            a64_branch(b, A64_CBNZ_W(0), EXIT_LABEL(LABEL_ERROR));
+            return true;
+
+        case OP_RECURSE:
+            a64_call_word(b, word);
+            return true;
+
+        case OP_TAIL_CALL:
+            a64_call(b, FN_ADDR(helper_tail_call), true, PTR_ADDR(instr->arg.word));
+            a64_branch(b, A64_B, EXIT_LABEL(LABEL_RET));
+            return true;
+
+        case OP_TAIL_CALL_NAME:
+            a64_call(b, FN_ADDR(helper_tail_call_name), true, PTR_ADDR(instr));
+            a64_branch(b, A64_B, EXIT_LABEL(LABEL_RET));
+            return true;
+
+        case OP_TAIL_RECURSE:
+            a64_ctx_field(b, 10, OFF_LOOP_SP);
+            emit32(b, A64_STR_W(R_BASE, 10, 0));                    /* drop this word's loop frames */
+            a64_branch(b, A64_B, 0);
+            return true;
+
+        case OP_LIT:
+            emit32(b, A64_LDR_W(0, R_DS, OFF_SP));
+            a64_grow(b, 1);
+            emit32(b, A64_MOV_W(0, 1));
+            a64_cell_addr(b);
+#ifndef RFORTH_UNTAGGED_CELLS
+            a64_mov_imm64(b, 2, (uint64_t)instr->arg.literal.type);
+            emit32(b, A64_STUR_W(2, 0, OFF_TYPE));
+#endif
+            a64_mov_imm64(b, 2, (uint64_t)instr->arg.literal.value.i);
+            emit32(b, A64_STUR_X(2, 0, OFF_VALUE));
+            return true;
+
+        case OP_BRANCH:
+            a64_branch(b, A64_B, instr->arg.target);
+            return true;
+
+        case OP_0BRANCH: {
+            size_t slow[2];
+            int slow_count = 0;
+            slow[slow_count++] = a64_need_local(b, 1);
+            a64_cell_addr(b);
+            a64_require_int(b, 0, slow, &slow_count);
+            emit32(b, A64_LDUR_X(3, 0, OFF_VALUE));
+            a64_shrink(b, 1);
+            a64_branch(b, A64_CBZ_X(3), instr->arg.target);
+            size_t done = a64_branch_local(b, A64_B);
+
+            /* Floats and underflow go through the helper */
+            for (int i = 0; i < slow_count; i++) a64_bind(b, slow[i]);
+            a64_call(b, FN_ADDR(helper_pop_flag), false, 0);
+            emit32(b, A64_CMP_W_IMM(0, 0));
+            a64_branch(b, A64_B_COND(CC_LT), EXIT_LABEL(LABEL_ERROR));
+            a64_branch(b, A64_B_COND(CC_EQ), instr->arg.target);
+            a64_bind(b, done);
+            return true;
+        }
+
+        case OP_DO: {
+            size_t slow[4];
+            int slow_count = 0;
+            slow[slow_count++] = a64_need_local(b, 2);
+            a64_cell_addr(b);
+            a64_require_int(b, 0, slow, &slow_count);
+            a64_require_int(b, -CELL_SIZE, slow, &slow_count);
+            a64_ctx_field(b, 10, OFF_LOOP_SP);
+            emit32(b, A64_LDR_W(9, 10, 0));
+            a64_ctx_field(b, 11, OFF_LOOP_CAP);
+            emit32(b, A64_LDR_W(11, 11, 0));
+            emit32(b, A64_CMP_W(9, 11));                            /* full: the helper grows it */
+            slow[slow_count++] = a64_branch_local(b, A64_B_COND(CC_GE));
+
+            emit32(b, A64_SXTW(9, 9));
+            emit32(b, A64_LDUR_X(2, 0, OFF_VALUE));                 /* index */
+            emit32(b, A64_LDUR_X(3, 0, OFF_VALUE - CELL_SIZE));     /* limit */
+            a64_ctx_field(b, 11, OFF_LOOP_INDEX);
+            emit32(b, A64_LDR_X(11, 11, 0));
+            emit32(b, A64_STR_X_LSL3(2, 11, 9));
+            a64_ctx_field(b, 11, OFF_LOOP_LIMIT);
+            emit32(b, A64_LDR_X(11, 11, 0));
+            emit32(b, A64_STR_X_LSL3(3, 11, 9));
+            emit32(b, A64_ADD_W_IMM(9, 9, 1));
+            emit32(b, A64_STR_W(9, 10, 0));
+            a64_shrink(b, 2);
+            size_t done = a64_branch_local(b, A64_B);
+
+            for (int i = 0; i < slow_count; i++) a64_bind(b, slow[i]);
+            a64_call(b, FN_ADDR(helper_do), false, 0);
+            a64_branch(b, A64_CBNZ_W(0), EXIT_LABEL(LABEL_ERROR));
+            a64_bind(b, done);
+            return true;
+        }
+
+        case OP_LOOP:
+            a64_ctx_field(b, 10, OFF_LOOP_SP);
+            emit32(b, A64_LDR_W(9, 10, 0));
+            emit32(b, A64_SUB_W_IMM(9, 9, 1));
+            emit32(b, A64_CMP_W(9, R_BASE));
+            a64_branch(b, A64_B_COND(CC_LT), EXIT_LABEL(LABEL_LOOP));
+            emit32(b, A64_SXTW(9, 9));
+            a64_ctx_field(b, 11, OFF_LOOP_INDEX);
+            emit32(b, A64_LDR_X(11, 11, 0));
+            emit32(b, A64_LDR_X_LSL3(2, 11, 9));
+            emit32(b, A64_ADD_X_IMM(2, 2, 1));
+            emit32(b, A64_STR_X_LSL3(2, 11, 9));
+            a64_ctx_field(b, 11, OFF_LOOP_LIMIT);
+            emit32(b, A64_LDR_X(11, 11, 0));
+            emit32(b, A64_LDR_X_LSL3(3, 11, 9));
+            emit32(b, A64_CMP_X(2, 3));
+            a64_branch(b, A64_B_COND(CC_LT), instr->arg.target);
+            emit32(b, A64_STR_W(9, 10, 0));                         /* drop loop frame */
+            return true;
+
+        case OP_PLUS_LOOP:
+            emit32(b, A64_MOV_X(0, R_CTX));
+            emit32(b, A64_MOV_W(1, R_BASE));
+            a64_mov_imm64(b, 16, FN_ADDR(helper_plus_loop));
+            emit32(b, A64_BLR(16));
+            emit32(b, A64_CMP_W_IMM(0, 0));
+            a64_branch(b, A64_B_COND(CC_LT), EXIT_LABEL(LABEL_ERROR));
+            a64_branch(b, A64_B_COND(CC_NE), instr->arg.target);
+            return true;
+
+        case OP_LEAVE: {
+            a64_ctx_field(b, 10, OFF_LOOP_SP);
+            emit32(b, A64_LDR_W(9, 10, 0));
+            emit32(b, A64_CMP_W(9, R_BASE));
+            size_t skip = a64_branch_local(b, A64_B_COND(CC_LE));
+            emit32(b, A64_SUB_W_IMM(9, 9, 1));
+            emit32(b, A64_STR_W(9, 10, 0));
+            a64_bind(b, skip);
+            a64_branch(b, A64_B, instr->arg.target);
+            return true;
+        }
+
+        case OP_EXIT:
+            a64_branch(b, A64_B, EXIT_LABEL(LABEL_RET_OK));
+            return true;
+
+        case OP_TYPE:
+            a64_mov_imm64(b, 0, PTR_ADDR(instr));
+            a64_mov_imm64(b, 16, FN_ADDR(helper_type));
+            emit32(b, A64_BLR(16));
+            return true;
+
+        case OP_SLIT:
+            a64_call(b, FN_ADDR(helper_slit), true, PTR_ADDR(instr));
+            a64_branch(b, A64_CBNZ_W(0), EXIT_LABEL(LABEL_ERROR));
+            return true;
+
+        case OP_FLIT:
+            a64_call(b, FN_ADDR(helper_flit), true, PTR_ADDR(instr));
+            a64_branch(b, A64_CBNZ_W(0), EXIT_LABEL(LABEL_ERROR));
+            return true;
+
+        case OP_DUP:
+        case OP_OVER: {
+            int n = (instr->op == OP_DUP) ? 1 : 2;
+            a64_need(b, n, EXIT_LABEL(LABEL_UNDERFLOW));
+            a64_grow(b, 1);
+            a64_cell_addr(b);
+            a64_load_cell(b, 0, 0, -(n - 1) * CELL_SIZE);
+            a64_store_cell(b, 0, 0, CELL_SIZE);
+            return true;
+        }
+
+        case OP_DROP:
+            a64_need(b, 1, EXIT_LABEL(LABEL_UNDERFLOW));
+            emit32(b, A64_SUB_W_IMM(0, 0, 1));
+            emit32(b, A64_STR_W(0, R_DS, OFF_SP));
+            return true;
+
+        case OP_SWAP:
+            a64_need(b, 2, EXIT_LABEL(LABEL_UNDERFLOW));
+            a64_cell_addr(b);
+            a64_load_cell(b, 0, 0, 0);
+            a64_load_cell(b, 1, 0, -CELL_SIZE);
+            a64_store_cell(b, 0, 0, -CELL_SIZE);
+            a64_store_cell(b, 1, 0, 0);
+            return true;
+
+        case OP_ADD:
+        case OP_SUB:
+        case OP_EQUAL:
+        case OP_LESS:
+        case OP_GREATER:
+            a64_binary(b, instr);
+            return true;
+
+        case OP_ZERO_EQUAL:
+        case OP_ONE_PLUS:
+        case OP_ONE_MINUS:
+            a64_unary(b, instr);
+            return true;
+
+        case OP_FETCH:
+        case OP_STORE:
+            a64_memory(b, instr);
+            return true;
+
+        case OP_I: {
+            a64_ctx_field(b, 10, OFF_LOOP_SP);
+            emit32(b, A64_LDR_W(9, 10, 0));
+            emit32(b, A64_CMP_W_IMM(9, 0));
+            size_t slow = a64_branch_local(b, A64_B_COND(CC_LE));
+            emit32(b, A64_LDR_W(0, R_DS, OFF_SP));
+            a64_grow(b, 1);
+            emit32(b, A64_MOV_W(0, 1));
+            a64_cell_addr(b);
+            emit32(b, A64_SXTW(9, 9));
+            emit32(b, A64_SUB_X_IMM(9, 9, 1));
+            a64_ctx_field(b, 11, OFF_LOOP_INDEX);
+            emit32(b, A64_LDR_X(11, 11, 0));
+            emit32(b, A64_LDR_X_LSL3(2, 11, 9));
+#ifndef RFORTH_UNTAGGED_CELLS
+            emit32(b, A64_STUR_W(XZR, 0, OFF_TYPE));
+#endif
+            emit32(b, A64_STUR_X(2, 0, OFF_VALUE));
+            size_t done = a64_branch_local(b, A64_B);
+            a64_bind(b, slow);
+            a64_call_word(b, instr->arg.word);
+            a64_bind(b, done);
+            return true;
+        }
+
+        case OP_MUL:
+        case OP_J:
+            a64_call_word(b, instr->arg.word);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+#define arch_prologue   a64_prologue
+#define arch_epilogue   a64_epilogue
+
+#endif /* architecture */
+
+/* Executable memory */
+
+#define JIT_CHUNK_SIZE (64 * 1024)
+
+static void* jit_alloc_code(jit_t *jit, const uint8_t *code, size_t length) {
+    jit_chunk_t *chunk = jit->chunks;
+
+    if (!chunk || chunk->size - chunk->used < length) {
+        size_t size = JIT_CHUNK_SIZE;
+        if (length > size) {
+            size = (length + jit->page_size - 1) & ~(jit->page_size - 1);
+        }
+
+        chunk = malloc(sizeof(jit_chunk_t));
+        if (!chunk) return NULL;
+
+        chunk->base = mmap(NULL, size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk->base == MAP_FAILED) {
+            free(chunk);
+            return NULL;
+        }
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = jit->chunks;
+        jit->chunks = chunk;
+    }
+
+    /* Never writable and executable at the same time */
+    if (mprotect(chunk->base, chunk->size, PROT_READ | PROT_WRITE) != 0) return NULL;
+
+    uint8_t *dest = chunk->base + chunk->used;
+    memcpy(dest, code, length);
+    chunk->used = (chunk->used + length + 15) & ~(size_t)15;
+
+    if (mprotect(chunk->base, chunk->size, PROT_READ | PROT_EXEC) != 0) return NULL;
+
+    __builtin___clear_cache((char*)dest, (char*)dest + length);
+    return dest;
+}
+
+jit_t* jit_create(void) {
+    jit_t *jit = malloc(sizeof(jit_t));
+    if (!jit) return NULL;
+
+    jit->chunks = NULL;
+    jit->page_size = (size_t)sysconf(_SC_PAGESIZE);
+    jit->depth = 0;
+    jit->tail = NULL;
+    return jit;
+}
+
+void jit_destroy(jit_t *jit) {
+    if (!jit) return;
+
+    jit_chunk_t *chunk = jit->chunks;
+    while (chunk) {
+        jit_chunk_t *next = chunk->next;
+        munmap(chunk->base, chunk->size);
+        free(chunk);
+        chunk = next;
+    }
+    free(jit);
+}
+
+const char* jit_arch_name(void) {
+#if defined(__x86_64__)
+    return "x86-64";
+#else
+    return "AArch64";
+#endif
+}
+
+bool jit_compile(jit_t *jit, word_t *word) {
+    if (!jit || !word) return false;
+    if (word->native_code) return true;
+    if (word->jit_rejected || !word->body) return false;
+
+    jit_buf_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.instr_offset = malloc(sizeof(size_t) * word->body_length);
+    if (!buf.instr_offset) {
+        word->jit_rejected = true;
+        return false;
+    }
+
+    bool ok = true;
+    arch_prologue(&buf);
+    for (int i = 0; i < word->body_length && ok; i++) {
+        buf.instr_offset[i] = buf.length;
+        ok = compile_instr(&buf, word, &word->body[i]);
+    }
+
+    if (ok) {
+        arch_epilogue(&buf);
+        resolve_fixups(&buf);
+    }
+
+    if (ok && !buf.failed) {
+        word->native_code = jit_alloc_code(jit, buf.code, buf.length);
+    }
+    if (!word->native_code) {
+        /* Unsupported opcode or out of memory: keep interpreting */
+        word->jit_rejected = true;
+    }
+
+    free(buf.code);
+    free(buf.fixups);
+    free(buf.instr_offset);
+    return word->native_code != NULL;
+}
+
+#else /* !JIT_SUPPORTED */
+
+jit_t* jit_create(void) {
+    return NULL;
+}
+
+void jit_destroy(jit_t *jit) {
+    (void)jit;
+}
+
+const char* jit_arch_name(void) {
+    return "none";
+}
+
+bool jit_compile(jit_t *jit, word_t *word) {
+    (void)jit;
+    if (word) word->jit_rejected = true;
+    return false;
+}
+
+#endif /* JIT_SUPPORTED */
+
+/* Each call between native words is a C call; stop before the C stack runs out */
+bool jit_can_nest(const jit_t *jit) {
+    return jit->depth < JIT_MAX_CALL_DEPTH;
+}
+
+void jit_execute(rforth_ctx_t *ctx, word_t *word) {
+    int loop_base = ctx->do_loop_sp;
+    jit_fn_t fn;
+
+    /* Object pointer to function pointer, as mmap'd code requires */
+    memcpy(&fn, &word->native_code, sizeof(fn));
+
+    ctx->jit->depth++;
+    int status;
+    while ((status = fn(ctx, ctx->data_stack, loop_base)) == JIT_RET_TAIL) {
+        /* The callee replaces the word that tail-called it, without nesting */
+        word = ctx->jit->tail;
+        ctx->do_loop_sp = loop_base;
+        if (!jit_compile(ctx->jit, word)) {
+            word_execute(ctx, word);
+            break;
+        }
+        memcpy(&fn, &word->native_code, sizeof(fn));
+    }
+    ctx->jit->depth--;
+
+    switch (status) {
+        case JIT_RET_UNDERFLOW:
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Stack underflow");
+            break;
+        case JIT_RET_OVERFLOW:
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow");
+            break;
+        case JIT_RET_LOOP:
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "LOOP without loop parameters");
+            break;
+        default:
+            break;
+    }
+
+    /* Drop loop frames the definition left open */
+    ctx->do_loop_sp = loop_base;
+}
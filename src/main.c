@@ -1,4 +1,5 @@
 #include "rforth.h"
+#include "jit.h"
 
 /* Function prototypes */
 static void print_usage(const char *program_name);
@@ -7,6 +8,7 @@ static void print_version(void);
 int main(int argc, char *argv[]) {
     bool repl_mode = false;
     bool compile_mode = false;
+    bool jit_mode = false;
     char *input_file = NULL;
     char *output_file = NULL;
     
@@ -32,6 +34,9 @@ int main(int argc, char *argv[]) {
                 case 'c':
                     compile_mode = true;
                     break;
+                case 'j':
+                    jit_mode = true;
+                    break;
                 case 'i':
                     /* Next argument is input file */
                     if (i + 1 < argc) {
@@ -80,6 +85,14 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    /* Compile definitions to native code on first execution */
+    if (jit_mode) {
+        ctx->jit = jit_create();
+        if (!ctx->jit) {
+            fprintf(stderr, "Warning: JIT not available on this platform, using interpreter\n");
+        }
+    }
+    
     int result = 0;
     
     /* Determine mode and execute */
@@ -130,12 +143,14 @@ static void print_usage(const char *program_name) {
     printf("  -v          Show version information\n");
     printf("  -r          Start REPL mode\n");
     printf("  -c          Compile mode (requires -o)\n");
+    printf("  -j          JIT-compile definitions to native code\n");
     printf("  -i FILE     Interpret FILE\n");
     printf("  -o FILE     Output file for compile mode\n");
     printf("\nExamples:\n");
     printf("  %s -r                    # Start REPL\n", program_name);
     printf("  %s hello.f               # Interpret hello.f\n", program_name);
     printf("  %s -i hello.f            # Interpret hello.f\n", program_name);
+    printf("  %s -j bench.f            # Interpret bench.f with the JIT\n", program_name);
     printf("  %s -c hello.f -o hello   # Compile hello.f to executable\n", program_name);
 }
 
@@ -9,6 +9,11 @@ parser_t* parser_create(void) {
     parser_t *parser = malloc(sizeof(parser_t));
     if (!parser) return NULL;
     
+    parser_init(parser);
+    return parser;
+}
+
+void parser_init(parser_t *parser) {
     parser->input = NULL;
     parser->current = NULL;
     parser->line = 1;
@@ -17,15 +22,18 @@ parser_t* parser_create(void) {
     parser->compile_buffer = NULL;
     parser->compile_buffer_size = 0;
     parser->compile_buffer_pos = 0;
-    
-    return parser;
+}
+
+void parser_release(parser_t *parser) {
+    free(parser->compile_buffer);
+    parser->compile_buffer = NULL;
+    parser->compile_buffer_size = 0;
+    parser->compile_buffer_pos = 0;
 }
 
 void parser_destroy(parser_t *parser) {
     if (parser) {
-        if (parser->compile_buffer) {
-            free(parser->compile_buffer);
-        }
+        parser_release(parser);
         free(parser);
     }
 }
@@ -128,6 +136,11 @@ bool parser_is_float(const char *text, double *value) {
     char *endptr;
     double result = strtod(text, &endptr);
     
+    /* ANS allows an empty exponent: 1E and 1.5e mean 1E0 and 1.5e0 */
+    if (endptr != text && (*endptr == 'e' || *endptr == 'E') && endptr[1] == '\0') {
+        endptr++;
+    }
+    
     /* Check if entire string was consumed and contains decimal point or exponent */
     if (*endptr == '\0' && endptr != text) {
         /* Must contain '.' or 'e'/'E' to be considered a float */
@@ -140,22 +153,21 @@ bool parser_is_float(const char *text, double *value) {
     return false;
 }
 
-static token_type_t get_keyword_token(const char *text) {
-    if (!text) return TOKEN_WORD;
-    
+static token_type_t get_keyword_token(symbol_t symbol) {
     /* Control flow keywords */
-    if (strcmp(text, "if") == 0) return TOKEN_IF;
-    if (strcmp(text, "then") == 0) return TOKEN_THEN;
-    if (strcmp(text, "else") == 0) return TOKEN_ELSE;
-    if (strcmp(text, "begin") == 0) return TOKEN_BEGIN;
-    if (strcmp(text, "until") == 0) return TOKEN_UNTIL;
-    if (strcmp(text, "while") == 0) return TOKEN_WHILE;
-    if (strcmp(text, "repeat") == 0) return TOKEN_REPEAT;
-    if (strcmp(text, "do") == 0) return TOKEN_DO;
-    if (strcmp(text, "loop") == 0) return TOKEN_LOOP;
-    if (strcmp(text, "leave") == 0) return TOKEN_LEAVE;
-    
-    return TOKEN_WORD;  /* Not a keyword */
+    switch (symbol) {
+        case SYM_IF: return TOKEN_IF;
+        case SYM_THEN: return TOKEN_THEN;
+        case SYM_ELSE: return TOKEN_ELSE;
+        case SYM_BEGIN: return TOKEN_BEGIN;
+        case SYM_UNTIL: return TOKEN_UNTIL;
+        case SYM_WHILE: return TOKEN_WHILE;
+        case SYM_REPEAT: return TOKEN_REPEAT;
+        case SYM_DO: return TOKEN_DO;
+        case SYM_LOOP: return TOKEN_LOOP;
+        case SYM_LEAVE: return TOKEN_LEAVE;
+        default: return TOKEN_WORD;  /* Not a keyword */
+    }
 }
 
 token_t parser_next_token(parser_t *parser) {
@@ -203,6 +215,7 @@ token_t parser_next_token(parser_t *parser) {
     /* Save position */
     token.line = parser->line;
     token.col = parser->col;
+    token.start = parser->current;
     
     /* Parse token based on first character */
     char c = *parser->current;
@@ -210,7 +223,7 @@ token_t parser_next_token(parser_t *parser) {
     if (c == ':') {
         /* Colon */
         token.type = TOKEN_COLON;
-        strcpy(token.text, ":");
+        token.length = 1;
         parser->current++;
         parser->col++;
         return token;
@@ -219,7 +232,7 @@ token_t parser_next_token(parser_t *parser) {
     if (c == ';') {
         /* Semicolon */
         token.type = TOKEN_SEMICOLON;
-        strcpy(token.text, ";");
+        token.length = 1;
         parser->current++;
         parser->col++;
         return token;
@@ -230,13 +243,14 @@ token_t parser_next_token(parser_t *parser) {
         token.type = TOKEN_STRING;
         parser->current++;
         parser->col++;
+        token.start = parser->current;
         
-        int i = 0;
-        while (*parser->current && *parser->current != '"' && i < MAX_WORD_LENGTH - 1) {
-            token.text[i++] = *parser->current++;
+        while (*parser->current && *parser->current != '"' &&
+               parser->current - token.start < MAX_WORD_LENGTH - 1) {
+            parser->current++;
             parser->col++;
         }
-        token.text[i] = '\0';
+        token.length = (int)(parser->current - token.start);
         
         if (*parser->current == '"') {
             parser->current++;
@@ -246,31 +260,45 @@ token_t parser_next_token(parser_t *parser) {
         return token;
     }
     
-    /* Parse word or number */
-    int i = 0;
-    
     /* Collect non-whitespace characters */
     while (*parser->current && !is_whitespace(*parser->current) && 
            *parser->current != '(' && *parser->current != ')' &&
-           i < MAX_WORD_LENGTH - 1) {
-        token.text[i++] = *parser->current++;
+           parser->current - token.start < MAX_WORD_LENGTH - 1) {
+        parser->current++;
         parser->col++;
     }
-    token.text[i] = '\0';
+    token.length = (int)(parser->current - token.start);
     
-    /* Determine if it's a number, float, or word */
-    int64_t number_value;
-    double float_value;
-    
-    if (parser_is_float(token.text, &float_value)) {
-        token.type = TOKEN_FLOAT;
-        token.value.float_val = float_value;
-    } else if (parser_is_number(token.text, &number_value)) {
-        token.type = TOKEN_NUMBER;
-        token.value.number = number_value;
-    } else {
-        token.type = TOKEN_WORD;
+    /* Only text starting like a number needs a NUL-terminated copy for strtod/strtoll */
+    c = token.start[0];
+    if (is_digit(c) || c == '-' || c == '+' || c == '.') {
+        char text[MAX_WORD_LENGTH];
+        memcpy(text, token.start, token.length);
+        text[token.length] = '\0';
+        
+        int64_t number_value;
+        double float_value;
+        if (parser_is_float(text, &float_value)) {
+            token.type = strpbrk(text, "eE") ? TOKEN_FLOAT_EXP : TOKEN_FLOAT;
+            token.value.float_val = float_value;
+            return token;
+        }
+        if (parser_is_number(text, &number_value)) {
+            token.type = TOKEN_NUMBER;
+            token.value.number = number_value;
+            return token;
+        }
     }
     
+    /* Only names something was defined or compiled under are interned; others find nothing */
+    token.type = TOKEN_WORD;
+    token.symbol = symbol_find(token.start, token.length);
+    
     return token;
-}
\ No newline at end of file
+}
+
+void parser_token_text(const token_t *token, char *text, size_t size) {
+    size_t length = (size_t)token->length < size - 1 ? (size_t)token->length : size - 1;
+    memcpy(text, token->start, length);
+    text[length] = '\0';
+}
@@ -1,4 +1,5 @@
 #include "rforth.h"
+#include "gpio_rpi.h"
 
 /* Placeholder implementations - to be implemented later */
 
@@ -43,7 +44,7 @@ cell_t rf_pop(void) {
 }
 
 void rf_print_num(cell_t value) {
-    if (value.type == CELL_INT) {
+    if (CELL_TYPE(value) == CELL_INT) {
         printf("%ld ", (long)value.value.i);
     } else {
         printf("%.6g ", value.value.f);
@@ -52,7 +53,7 @@ void rf_print_num(cell_t value) {
 
 void rf_print_char(cell_t value) {
     int ch;
-    if (value.type == CELL_INT) {
+    if (CELL_TYPE(value) == CELL_INT) {
         ch = (int)value.value.i;
     } else {
         ch = (int)value.value.f;
@@ -62,4 +63,18 @@ void rf_print_char(cell_t value) {
 
 void rf_newline(void) {
     printf("\n");
-}
\ No newline at end of file
+}
+
+/* A GPIO word failed in a compiled program: report it and stop, as the interpreter would */
+void rf_gpio_check(gpio_error_t err, const char *word) {
+    if (err != GPIO_OK) {
+        fprintf(stderr, "Error: %s: %s\n", word, gpio_error_string(err));
+        exit(1);
+    }
+}
+
+/* A compiled program ran a stack past either end: report it and stop, as the interpreter would */
+void rf_stack_error(const char *message) {
+    fprintf(stderr, "Error: %s\n", message);
+    exit(1);
+}
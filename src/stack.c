@@ -2,27 +2,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-/* Cell creation utilities */
-cell_t cell_make_int(int64_t value) {
-    cell_t cell;
-    cell.type = CELL_INT;
-    cell.value.i = value;
-    return cell;
-}
-
-cell_t cell_make_float(double value) {
-    cell_t cell;
-    cell.type = CELL_FLOAT;
-    cell.value.f = value;
-    return cell;
-}
-
+/* Cell queries */
 bool cell_is_int(const cell_t *cell) {
-    return cell && cell->type == CELL_INT;
+    return cell && CELL_TYPE(*cell) == CELL_INT;
 }
 
 bool cell_is_float(const cell_t *cell) {
-    return cell && cell->type == CELL_FLOAT;
+    return cell && CELL_TYPE(*cell) == CELL_FLOAT;
 }
 
 int64_t cell_get_int(const cell_t *cell) {
@@ -33,25 +19,18 @@ double cell_get_float(const cell_t *cell) {
     return cell ? cell->value.f : 0.0;
 }
 
-double cell_to_float(const cell_t *cell) {
-    if (!cell) return 0.0;
-    if (cell->type == CELL_FLOAT) {
-        return cell->value.f;
-    } else {
-        return (double)cell->value.i;
-    }
-}
-
 rforth_stack_t* stack_create(int size) {
     rforth_stack_t *stack = malloc(sizeof(rforth_stack_t));
     if (!stack) return NULL;
     
-    stack->data = malloc(sizeof(cell_t) * size);
-    if (!stack->data) {
+    /* One extra cell below data[0] for the interpreter's TOS spill */
+    cell_t *block = calloc(size + 1, sizeof(cell_t));
+    if (!block) {
         free(stack);
         return NULL;
     }
     
+    stack->data = block + 1;
     stack->sp = -1;  /* Empty stack */
     stack->size = size;
     return stack;
@@ -59,7 +38,7 @@ rforth_stack_t* stack_create(int size) {
 
 void stack_destroy(rforth_stack_t *stack) {
     if (stack) {
-        free(stack->data);
+        free(stack->data - 1);
         free(stack);
     }
 }
@@ -100,7 +79,7 @@ bool stack_pop_int(rforth_stack_t *stack, int64_t *value) {
     }
     
     if (value) {
-        if (cell.type == CELL_INT) {
+        if (CELL_TYPE(cell) == CELL_INT) {
             *value = cell.value.i;
         } else {
             *value = (int64_t)cell.value.f;  /* Convert float to int */
@@ -166,6 +145,51 @@ void stack_clear(rforth_stack_t *stack) {
     }
 }
 
+/* Float stack operations */
+
+rforth_fstack_t* fstack_create(int size) {
+    rforth_fstack_t *stack = malloc(sizeof(rforth_fstack_t));
+    if (!stack) return NULL;
+    
+    stack->data = malloc(sizeof(double) * size);
+    if (!stack->data) {
+        free(stack);
+        return NULL;
+    }
+    
+    stack->sp = -1;  /* Empty stack */
+    stack->size = size;
+    return stack;
+}
+
+void fstack_destroy(rforth_fstack_t *stack) {
+    if (stack) {
+        free(stack->data);
+        free(stack);
+    }
+}
+
+bool fstack_push(rforth_fstack_t *stack, double value) {
+    if (!stack || stack->sp >= stack->size - 1) {
+        return false;
+    }
+    
+    stack->data[++stack->sp] = value;
+    return true;
+}
+
+bool fstack_pop(rforth_fstack_t *stack, double *value) {
+    if (!stack || stack->sp < 0) {
+        return false;
+    }
+    
+    if (value) {
+        *value = stack->data[stack->sp];
+    }
+    stack->sp--;
+    return true;
+}
+
 /* Stack manipulation operations */
 
 bool stack_dup(rforth_stack_t *stack) {
@@ -234,7 +258,7 @@ void stack_print(rforth_stack_t *stack) {
     
     printf("Stack (%d): ", stack_depth(stack));
     for (int i = 0; i <= stack->sp; i++) {
-        if (stack->data[i].type == CELL_INT) {
+        if (CELL_TYPE(stack->data[i]) == CELL_INT) {
             printf("%ld ", (long)stack->data[i].value.i);
         } else {
             printf("%.6g ", stack->data[i].value.f);
@@ -0,0 +1,140 @@
+#include "symbol.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char *name;                 /* NUL-terminated copy of the text */
+    size_t length;
+    uint32_t hash;
+} symbol_entry_t;
+
+/* Entries by symbol ID; ID 0 is SYMBOL_NONE and stays empty */
+static symbol_entry_t *symbols = NULL;
+static uint32_t symbol_count = 0;
+static uint32_t symbol_capacity = 0;
+
+/* Open-addressed index of IDs by hash, power-of-two sized; 0 marks a free bucket */
+static symbol_t *buckets = NULL;
+static uint32_t bucket_capacity = 0;
+
+static const char *const well_known_names[] = {
+#define SYMBOL_NAME(id, text) text,
+    WELL_KNOWN_SYMBOLS(SYMBOL_NAME)
+#undef SYMBOL_NAME
+};
+
+uint32_t symbol_hash_text(const char *text, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Bucket holding text, or the free bucket ending its probe sequence */
+static symbol_t* symbol_slot(const char *text, size_t length, uint32_t hash) {
+    uint32_t mask = bucket_capacity - 1;
+    uint32_t i = hash & mask;
+
+    while (buckets[i]) {
+        const symbol_entry_t *entry = &symbols[buckets[i]];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->name, text, length) == 0) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return &buckets[i];
+}
+
+static bool symbol_grow(void) {
+    if (symbol_count == symbol_capacity) {
+        uint32_t capacity = symbol_capacity * 2;
+        symbol_entry_t *grown = realloc(symbols, sizeof(symbol_entry_t) * capacity);
+        if (!grown) return false;
+        symbols = grown;
+        symbol_capacity = capacity;
+    }
+
+    /* Keep the index at most half full */
+    if (symbol_count * 2 > bucket_capacity) {
+        uint32_t capacity = bucket_capacity * 2;
+        symbol_t *index = calloc(capacity, sizeof(symbol_t));
+        if (!index) return false;
+        free(buckets);
+        buckets = index;
+        bucket_capacity = capacity;
+        for (symbol_t id = 1; id < symbol_count; id++) {
+            *symbol_slot(symbols[id].name, symbols[id].length, symbols[id].hash) = id;
+        }
+    }
+    return true;
+}
+
+static symbol_t symbol_add(const char *text, size_t length, uint32_t hash) {
+    if (!symbol_grow()) return SYMBOL_NONE;
+
+    char *name = malloc(length + 1);
+    if (!name) return SYMBOL_NONE;
+    memcpy(name, text, length);
+    name[length] = '\0';
+
+    symbol_t id = symbol_count++;
+    symbols[id].name = name;
+    symbols[id].length = length;
+    symbols[id].hash = hash;
+    *symbol_slot(text, length, hash) = id;
+    return id;
+}
+
+/* First use: allocate the tables and give the well-known names their fixed IDs */
+static bool symbol_init(void) {
+    if (symbols) return true;
+
+    symbols = calloc(INITIAL_SYMBOL_CAPACITY, sizeof(symbol_entry_t));
+    buckets = calloc(INITIAL_SYMBOL_CAPACITY * 2, sizeof(symbol_t));
+    if (!symbols || !buckets) {
+        free(symbols);
+        free(buckets);
+        symbols = NULL;
+        buckets = NULL;
+        return false;
+    }
+    symbol_capacity = INITIAL_SYMBOL_CAPACITY;
+    bucket_capacity = INITIAL_SYMBOL_CAPACITY * 2;
+    symbol_count = 1;
+
+    for (int i = 0; i < SYM_WELL_KNOWN_COUNT - 1; i++) {
+        const char *text = well_known_names[i];
+        size_t length = strlen(text);
+        symbol_add(text, length, symbol_hash_text(text, length));
+    }
+    return true;
+}
+
+symbol_t symbol_intern(const char *text, size_t length) {
+    if (!text || !symbol_init()) return SYMBOL_NONE;
+
+    uint32_t hash = symbol_hash_text(text, length);
+    symbol_t id = *symbol_slot(text, length, hash);
+    return id ? id : symbol_add(text, length, hash);
+}
+
+symbol_t symbol_find(const char *text, size_t length) {
+    if (!text || !symbol_init()) return SYMBOL_NONE;
+
+    return *symbol_slot(text, length, symbol_hash_text(text, length));
+}
+
+const char* symbol_name(symbol_t symbol) {
+    return symbol && symbol < symbol_count ? symbols[symbol].name : "";
+}
+
+size_t symbol_length(symbol_t symbol) {
+    return symbol && symbol < symbol_count ? symbols[symbol].length : 0;
+}
+
+uint32_t symbol_hash(symbol_t symbol) {
+    return symbol && symbol < symbol_count ? symbols[symbol].hash : 0;
+}
@@ -1,4 +1,5 @@
 #include "timing_rpi.h"
+#include "rforth.h"
 #include <time.h>
 #include <unistd.h>
 #include <errno.h>
@@ -75,7 +76,7 @@ void delay_milliseconds(uint32_t ms) {
 void builtin_delay_ms(rforth_ctx_t *ctx) {
     /* DELAY-MS ( ms -- ) Delay for milliseconds */
     cell_t ms_cell;
-    if (!stack_pop(ctx->data_stack, &ms_cell) || ms_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &ms_cell) || CELL_TYPE(ms_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "DELAY-MS requires milliseconds on stack", 
                         "timing", __FILE__, __LINE__, 0);
@@ -95,7 +96,7 @@ void builtin_delay_ms(rforth_ctx_t *ctx) {
 void builtin_delay_us(rforth_ctx_t *ctx) {
     /* DELAY-US ( us -- ) Delay for microseconds */
     cell_t us_cell;
-    if (!stack_pop(ctx->data_stack, &us_cell) || us_cell.type != CELL_INT) {
+    if (!stack_pop(ctx->data_stack, &us_cell) || CELL_TYPE(us_cell) != CELL_INT) {
         rforth_set_error(ctx, RFORTH_ERROR_STACK_UNDERFLOW, 
                         "DELAY-US requires microseconds on stack", 
                         "timing", __FILE__, __LINE__, 0);
@@ -6,12 +6,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#ifndef _WIN32
-    #include <sys/wait.h>
-    #include <unistd.h>
-#else
-    #include <process.h>
-#endif
 
 /* Helper function to convert Forth word name to C identifier */
 static void word_name_to_c_identifier(const char *forth_name, char *c_name, size_t size) {
@@ -71,11 +65,12 @@ bool turnkey_generate_stack_code(FILE *output, rforth_stack_t *stack) {
     if (depth > 0) {
         fprintf(output, "    /* Initialize stack with current values */\n");
         for (int i = 0; i <= stack->sp; i++) {
-            if (stack->data[i].type == CELL_INT) {
-                fprintf(output, "    push_int(%ld);\n", (long)stack->data[i].value.i);
-            } else {
-                fprintf(output, "    push_float(%.6g);\n", stack->data[i].value.f);
+            /* Compiled cells are plain integers, so a float cell keeps its bits */
+            int64_t value = stack->data[i].value.i;
+            if (CELL_TYPE(stack->data[i]) != CELL_INT) {
+                memcpy(&value, &stack->data[i].value.f, sizeof(value));
             }
+            fprintf(output, "    push(%lld);\n", (long long)value);
         }
         fprintf(output, "\n");
     }
@@ -97,59 +92,9 @@ bool turnkey_create_executable(rforth_ctx_t *ctx, const char *output_file) {
         return false;
     }
     
-    /* Generate C file header */
+    /* The stacks and primitives are shared with compiled programs */
     fprintf(c_file, "/* Generated by RForth TURNKEY */\n");
-    fprintf(c_file, "#include <stdio.h>\n");
-    fprintf(c_file, "#include <stdlib.h>\n");
-    fprintf(c_file, "#include <stdint.h>\n\n");
-    
-    /* Generate configuration constants */
-    fprintf(c_file, "/* Configuration constants */\n");
-    fprintf(c_file, "#define DEFAULT_STACK_SIZE %d\n\n", DEFAULT_STACK_SIZE);
-    
-    /* Generate runtime stack */
-    fprintf(c_file, "/* Runtime stack */\n");
-    fprintf(c_file, "static int64_t stack[DEFAULT_STACK_SIZE];\n");
-    fprintf(c_file, "static int sp = -1;\n\n");
-    
-    /* Generate stack operations */
-    fprintf(c_file, "static void push(int64_t value) {\n");
-    fprintf(c_file, "    if (sp < 255) stack[++sp] = value;\n");
-    fprintf(c_file, "}\n\n");
-    
-    fprintf(c_file, "static int64_t pop(void) {\n");
-    fprintf(c_file, "    return (sp >= 0) ? stack[sp--] : 0;\n");
-    fprintf(c_file, "}\n\n");
-    
-    /* Generate I/O functions */
-    fprintf(c_file, "static void forth_dot(void) {\n");
-    fprintf(c_file, "    printf(\"%%ld \", (long)pop());\n");
-    fprintf(c_file, "}\n\n");
-    
-    fprintf(c_file, "static void forth_emit(void) {\n");
-    fprintf(c_file, "    printf(\"%%c\", (char)pop());\n");
-    fprintf(c_file, "}\n\n");
-    
-    fprintf(c_file, "static void forth_cr(void) {\n");
-    fprintf(c_file, "    printf(\"\\n\");\n");
-    fprintf(c_file, "}\n\n");
-    
-    /* Generate stack manipulation functions */
-    fprintf(c_file, "static void forth_dup(void) {\n");
-    fprintf(c_file, "    if (sp >= 0) push(stack[sp]);\n");
-    fprintf(c_file, "}\n\n");
-    
-    fprintf(c_file, "static void forth_drop(void) {\n");
-    fprintf(c_file, "    if (sp >= 0) sp--;\n");
-    fprintf(c_file, "}\n\n");
-    
-    fprintf(c_file, "static void forth_swap(void) {\n");
-    fprintf(c_file, "    if (sp >= 1) {\n");
-    fprintf(c_file, "        int64_t tmp = stack[sp];\n");
-    fprintf(c_file, "        stack[sp] = stack[sp-1];\n");
-    fprintf(c_file, "        stack[sp-1] = tmp;\n");
-    fprintf(c_file, "    }\n");
-    fprintf(c_file, "}\n\n");
+    fprintf(c_file, "#include \"rforth_runtime.h\"\n\n");
     
     /* Generate dictionary words */
     if (!turnkey_generate_dictionary_code(c_file, ctx->dict)) {
@@ -172,59 +117,15 @@ bool turnkey_create_executable(rforth_ctx_t *ctx, const char *output_file) {
     
     fclose(c_file);
     
-    /* Compile the C file */
-#ifdef _WIN32
-    /* Use cl.exe on Windows to compile the generated C file */
-    char command[1024];
-    snprintf(command, sizeof(command), "cl.exe /O2 /Fe:\"%s\" \"%s\"", output_file, c_filename);
-    int result = system(command);
-    if (result == 0) {
-        io_printf("TURNKEY executable '%s' created successfully.\n", output_file);
-        io_printf("Generated C code saved as: %s\n", c_filename);
-        return true;
-    } else {
-        io_error_string("cl.exe compilation failed\n");
+    /* Compile the C file against the runtime, as the compiler does */
+    if (!invoke_c_compiler(c_filename, output_file)) {
+        io_error_string("TURNKEY compilation failed\n");
         return false;
     }
-#else
-    pid_t pid = fork();
-    if (pid == -1) {
-        io_error_string("Error: Failed to fork for compilation\n");
-        return false;
-    }
-
-    if (pid == 0) {
-        /* Child process - compile with gcc */
-        char *args[] = {
-            "gcc",
-            "-O2",
-            "-o",
-            (char*)output_file,
-            c_filename,
-            NULL
-        };
-
-        execvp("gcc", args);
-        io_error_string("Error: Failed to execute gcc\n");
-        _exit(1);
-    } else {
-        /* Parent process - wait for compilation */
-        int status;
-        if (waitpid(pid, &status, 0) == -1) {
-            io_error_string("Error: Failed to wait for gcc\n");
-            return false;
-        }
-
-        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            io_printf("TURNKEY executable '%s' created successfully.\n", output_file);
-            io_printf("Generated C code saved as: %s\n", c_filename);
-            return true;
-        } else {
-            io_error_string("gcc compilation failed\n");
-            return false;
-        }
-    }
-#endif
+    
+    io_printf("TURNKEY executable '%s' created successfully.\n", output_file);
+    io_printf("Generated C code saved as: %s\n", c_filename);
+    return true;
 }
 
 void builtin_turnkey(rforth_ctx_t *ctx) {
@@ -0,0 +1,1987 @@
+#include "vm.h"
+#include "jit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+/* Definition compiler */
+
+vm_builder_t* vm_builder_create(void) {
+    vm_builder_t *builder = malloc(sizeof(vm_builder_t));
+    if (!builder) return NULL;
+
+    builder->capacity = 32;
+    builder->code = malloc(sizeof(instr_t) * builder->capacity);
+    if (!builder->code) {
+        free(builder);
+        return NULL;
+    }
+
+    builder->cf_capacity = INITIAL_CONTROL_DEPTH;
+    builder->cf_stack = malloc(sizeof(control_flow_entry_t) * builder->cf_capacity);
+    if (!builder->cf_stack) {
+        free(builder->code);
+        free(builder);
+        return NULL;
+    }
+
+    builder->length = 0;
+    builder->fold_floor = 0;
+    builder->cf_sp = 0;
+#ifdef RFORTH_PROFILE
+    /* Profile the unfused sequences */
+    builder->fuse = false;
+#else
+    builder->fuse = true;
+#endif
+    builder->late_bind = false;
+    return builder;
+}
+
+void vm_builder_destroy(vm_builder_t *builder) {
+    if (!builder) return;
+
+    if (builder->code) {
+        vm_code_free(builder->code, builder->length);
+    }
+    free(builder->cf_stack);
+    free(builder);
+}
+
+static instr_t* emit(rforth_ctx_t *ctx, vm_builder_t *builder, opcode_t op) {
+    if (builder->length >= builder->capacity) {
+        int new_capacity = builder->capacity * 2;
+        instr_t *new_code = realloc(builder->code, sizeof(instr_t) * new_capacity);
+        if (!new_code) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to grow compiled definition");
+            return NULL;
+        }
+        builder->code = new_code;
+        builder->capacity = new_capacity;
+    }
+
+    instr_t *instr = &builder->code[builder->length++];
+    memset(instr, 0, sizeof(*instr));
+    instr->op = op;
+    return instr;
+}
+
+static bool cf_push(rforth_ctx_t *ctx, vm_builder_t *builder, control_flow_type_t type, int address) {
+    if (builder->cf_sp >= builder->cf_capacity) {
+        int new_capacity = builder->cf_capacity * 2;
+        control_flow_entry_t *new_stack = realloc(builder->cf_stack, sizeof(control_flow_entry_t) * new_capacity);
+        if (!new_stack) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to grow control flow stack");
+            return false;
+        }
+        builder->cf_stack = new_stack;
+        builder->cf_capacity = new_capacity;
+    }
+
+    builder->cf_stack[builder->cf_sp].type = type;
+    builder->cf_stack[builder->cf_sp].address = address;
+    builder->cf_sp++;
+    /* Branches may land here; literals before this point are not known on every path */
+    builder->fold_floor = builder->length;
+    return true;
+}
+
+static bool cf_pop(rforth_ctx_t *ctx, vm_builder_t *builder, control_flow_type_t type,
+                   const char *message, int *address) {
+    if (builder->cf_sp <= 0 || builder->cf_stack[builder->cf_sp - 1].type != type) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, message);
+        return false;
+    }
+
+    builder->cf_sp--;
+    *address = (int)builder->cf_stack[builder->cf_sp].address;
+    builder->fold_floor = builder->length;
+    return true;
+}
+
+/* Copy the text up to the closing quote into a new inline string instruction */
+static bool compile_string(rforth_ctx_t *ctx, vm_builder_t *builder, opcode_t op) {
+    const char *input = ctx->parser->current;
+    if (!input) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_UNTERMINATED_STRING, "String literal requires text");
+        return false;
+    }
+
+    /* Skip the single delimiting space */
+    while (*input && isspace((unsigned char)*input)) input++;
+
+    const char *end = strchr(input, '"');
+    if (!end) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_UNTERMINATED_STRING, "Unterminated string literal");
+        return false;
+    }
+
+    int length = (int)(end - input);
+    char *text = malloc(length + 1);
+    if (!text) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to allocate string literal");
+        return false;
+    }
+    memcpy(text, input, length);
+    text[length] = '\0';
+
+    instr_t *instr = emit(ctx, builder, op);
+    if (!instr) {
+        free(text);
+        return false;
+    }
+    instr->arg.string.text = text;
+    instr->arg.string.length = length;
+
+    ctx->parser->current = end + 1;
+    return true;
+}
+
+static bool compile_control_word(rforth_ctx_t *ctx, vm_builder_t *builder, symbol_t name, bool *handled) {
+    instr_t *instr;
+    int address;
+
+    *handled = true;
+
+    if (name == SYM_IF) {
+        if (!emit(ctx, builder, OP_0BRANCH)) return false;
+        return cf_push(ctx, builder, CF_IF, builder->length - 1);
+    }
+
+    if (name == SYM_ELSE) {
+        if (!cf_pop(ctx, builder, CF_IF, "ELSE without matching IF", &address)) return false;
+        if (!emit(ctx, builder, OP_BRANCH)) return false;
+        builder->code[address].arg.target = builder->length;
+        return cf_push(ctx, builder, CF_IF, builder->length - 1);
+    }
+
+    if (name == SYM_THEN) {
+        if (!cf_pop(ctx, builder, CF_IF, "THEN without matching IF", &address)) return false;
+        builder->code[address].arg.target = builder->length;
+        return true;
+    }
+
+    if (name == SYM_BEGIN) {
+        return cf_push(ctx, builder, CF_BEGIN, builder->length);
+    }
+
+    if (name == SYM_UNTIL) {
+        if (!cf_pop(ctx, builder, CF_BEGIN, "UNTIL without matching BEGIN", &address)) return false;
+        if (!(instr = emit(ctx, builder, OP_0BRANCH))) return false;
+        instr->arg.target = address;
+        return true;
+    }
+
+    if (name == SYM_WHILE) {
+        /* ( dest -- orig dest ): keep BEGIN on top so REPEAT finds it first */
+        if (!cf_pop(ctx, builder, CF_BEGIN, "WHILE without matching BEGIN", &address)) return false;
+        if (!emit(ctx, builder, OP_0BRANCH)) return false;
+        if (!cf_push(ctx, builder, CF_WHILE, builder->length - 1)) return false;
+        return cf_push(ctx, builder, CF_BEGIN, address);
+    }
+
+    if (name == SYM_REPEAT) {
+        int orig;
+        if (!cf_pop(ctx, builder, CF_BEGIN, "REPEAT without matching BEGIN", &address)) return false;
+        if (!cf_pop(ctx, builder, CF_WHILE, "REPEAT without matching WHILE", &orig)) return false;
+        if (!(instr = emit(ctx, builder, OP_BRANCH))) return false;
+        instr->arg.target = address;
+        builder->code[orig].arg.target = builder->length;
+        return true;
+    }
+
+    if (name == SYM_DO) {
+        if (!emit(ctx, builder, OP_DO)) return false;
+        return cf_push(ctx, builder, CF_DO, builder->length);
+    }
+
+    if (name == SYM_LOOP || name == SYM_PLUS_LOOP) {
+        opcode_t op = (name == SYM_PLUS_LOOP) ? OP_PLUS_LOOP : OP_LOOP;
+        if (!cf_pop(ctx, builder, CF_DO, "LOOP without matching DO", &address)) return false;
+        if (!(instr = emit(ctx, builder, op))) return false;
+        instr->arg.target = address;
+
+        /* Resolve LEAVEs; those of nested loops were resolved by their own LOOP */
+        for (int i = address; i < builder->length; i++) {
+            if (builder->code[i].op == OP_LEAVE && builder->code[i].arg.target < 0) {
+                builder->code[i].arg.target = builder->length;
+            }
+        }
+        return true;
+    }
+
+    if (name == SYM_LEAVE) {
+        bool in_loop = false;
+        for (int i = builder->cf_sp - 1; i >= 0; i--) {
+            if (builder->cf_stack[i].type == CF_DO) {
+                in_loop = true;
+                break;
+            }
+        }
+        if (!in_loop) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "LEAVE without matching DO");
+            return false;
+        }
+        if (!(instr = emit(ctx, builder, OP_LEAVE))) return false;
+        instr->arg.target = -1;
+        return true;
+    }
+
+    if (name == SYM_EXIT) {
+        return emit(ctx, builder, OP_EXIT) != NULL;
+    }
+
+    if (name == SYM_RECURSE) {
+        return emit(ctx, builder, OP_RECURSE) != NULL;
+    }
+
+    if (name == SYM_LITERAL) {
+        /* Compile the value computed between [ and ] */
+        cell_t value;
+        if (!stack_pop(ctx->data_stack, &value)) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "LITERAL requires value on stack");
+            return false;
+        }
+        if (!(instr = emit(ctx, builder, OP_LIT))) return false;
+        instr->arg.literal = value;
+        return true;
+    }
+
+    if (name == SYM_DOT_QUOTE) {
+        return compile_string(ctx, builder, OP_TYPE);
+    }
+
+    if (name == SYM_S_QUOTE) {
+        return compile_string(ctx, builder, OP_SLIT);
+    }
+
+    *handled = false;
+    return true;
+}
+
+/* Builtins the inner interpreter executes inline */
+static const struct {
+    const char *name;
+    opcode_t op;
+} primitives[] = {
+    {"dup", OP_DUP},
+    {"drop", OP_DROP},
+    {"swap", OP_SWAP},
+    {"over", OP_OVER},
+    {"+", OP_ADD},
+    {"-", OP_SUB},
+    {"*", OP_MUL},
+    {"=", OP_EQUAL},
+    {"<", OP_LESS},
+    {">", OP_GREATER},
+    {"0=", OP_ZERO_EQUAL},
+    {"1+", OP_ONE_PLUS},
+    {"1-", OP_ONE_MINUS},
+    {"@", OP_FETCH},
+    {"!", OP_STORE},
+    {"i", OP_I},
+    {"j", OP_J},
+    {NULL, OP_CALL}
+};
+
+/*
+ * Inline primitives that may appear in a superinstruction, with their
+ * stack effect ( in -- out ). Superinstruction bounds and the stack-effect
+ * verifier are derived from it.
+ */
+#define FUSABLE_PRIMITIVES(X) \
+    X(LIT, 0, 1) \
+    X(DUP, 1, 2) \
+    X(DROP, 1, 0) \
+    X(SWAP, 2, 2) \
+    X(OVER, 2, 3) \
+    X(ADD, 2, 1) \
+    X(SUB, 2, 1) \
+    X(MUL, 2, 1) \
+    X(EQUAL, 2, 1) \
+    X(LESS, 2, 1) \
+    X(GREATER, 2, 1) \
+    X(ZERO_EQUAL, 1, 1) \
+    X(ONE_PLUS, 1, 1) \
+    X(ONE_MINUS, 1, 1) \
+    X(FETCH, 1, 1) \
+    X(STORE, 2, 0) \
+    X(I, 0, 1) \
+    X(J, 0, 1)
+
+#define STACK_EFFECT(name, in, out) IN_##name = (in), OUT_##name = (out),
+enum { FUSABLE_PRIMITIVES(STACK_EFFECT) };
+#undef STACK_EFFECT
+
+#ifdef RFORTH_PROFILE
+#define FUSABLE_NAME(name, in, out) [OP_##name] = #name,
+static const char *const fusable_names[OP_COUNT] = { FUSABLE_PRIMITIVES(FUSABLE_NAME) };
+#undef FUSABLE_NAME
+#endif
+
+/* Data stack effect of each opcode a verified body may contain */
+static const struct {
+    bool known;
+    signed char in, out;
+} stack_effects[OP_COUNT] = {
+#define EFFECT_ENTRY(name, in, out) [OP_##name] = {true, (in), (out)},
+    FUSABLE_PRIMITIVES(EFFECT_ENTRY)
+#undef EFFECT_ENTRY
+    [OP_TYPE] = {true, 0, 0},
+    [OP_FLIT] = {true, 0, 0},   /* Checks the float stack itself */
+};
+
+static const struct {
+    opcode_t op;
+    int length;
+    opcode_t parts[3];
+} superinstructions[] = {
+#define SUPER2(name, a, b) {OP_##name, 2, {OP_##a, OP_##b, OP_CALL}},
+#define SUPER3(name, a, b, c) {OP_##name, 3, {OP_##a, OP_##b, OP_##c}},
+#include "superinstructions.def"
+#undef SUPER2
+#undef SUPER3
+};
+
+#define SUPERINSTRUCTION_COUNT ((int)(sizeof(superinstructions) / sizeof(superinstructions[0])))
+
+static opcode_t primitive_opcode(const char *name) {
+    for (int i = 0; primitives[i].name; i++) {
+        if (strcmp(primitives[i].name, name) == 0) {
+            return primitives[i].op;
+        }
+    }
+    return OP_CALL;
+}
+
+/*
+ * Constant folding. A call to a pure builtin whose inputs are all
+ * literals compiled just before it runs now, on the data stack, and its
+ * results replace those literals. Running the builtin itself keeps the
+ * int/float rules identical to run time; one that fails (division by
+ * zero) is left to fail at run time instead.
+ */
+static const struct {
+    const char *name;
+    int in;                     /* Cells it takes from the stack */
+} foldable_words[] = {
+    {"+", 2}, {"-", 2}, {"*", 2}, {"/", 2}, {"mod", 2},
+    {"=", 2}, {"<>", 2}, {"<", 2}, {">", 2}, {"<=", 2}, {">=", 2},
+    {"0=", 1}, {"0<", 1}, {"0>", 1},
+    {"1+", 1}, {"1-", 1}, {"2*", 1}, {"2/", 1}, {"negate", 1}, {"abs", 1},
+    {"min", 2}, {"max", 2},
+    {"and", 2}, {"or", 2}, {"xor", 2}, {"invert", 1}, {"lshift", 2}, {"rshift", 2},
+    {"cells", 1}, {"cell+", 1}, {"chars", 1}, {"char+", 1},
+    {"dup", 1}, {"drop", 1}, {"swap", 2}, {"over", 2}, {"rot", 3},
+    {NULL, 0}
+};
+
+static bool fold_constants(rforth_ctx_t *ctx, vm_builder_t *builder, word_t *word, bool *folded) {
+    *folded = false;
+    if (!word || word->type != WORD_BUILTIN) return true;
+
+    int in = -1;
+    for (int i = 0; foldable_words[i].name; i++) {
+        if (strcmp(foldable_words[i].name, word->name) == 0) {
+            in = foldable_words[i].in;
+            break;
+        }
+    }
+    int first = builder->length - in;
+    if (in < 0 || first < builder->fold_floor) return true;
+    for (int i = first; i < builder->length; i++) {
+        if (builder->code[i].op != OP_LIT) return true;
+    }
+
+    rforth_stack_t *ds = ctx->data_stack;
+    int base = ds->sp;
+    for (int i = first; i < builder->length; i++) {
+        if (!stack_push_cell(ds, builder->code[i].arg.literal)) {
+            ds->sp = base;
+            return true;
+        }
+    }
+    word_execute(ctx, word);
+    if (ctx->last_error.code != RFORTH_OK || ds->sp < base) {
+        rforth_clear_error(ctx);
+        ds->sp = base;
+        return true;
+    }
+
+    /* The results are above base, deepest first */
+    int out = ds->sp - base;
+    builder->length = first;
+    for (int i = 1; i <= out; i++) {
+        instr_t *instr = emit(ctx, builder, OP_LIT);
+        if (!instr) {
+            ds->sp = base;
+            return false;
+        }
+        instr->arg.literal = ds->data[base + i];
+    }
+    ds->sp = base;
+    *folded = true;
+    return true;
+}
+
+/* Compile a call to a builtin, inline primitive or user word, folded when possible */
+static bool compile_call(rforth_ctx_t *ctx, vm_builder_t *builder, opcode_t op, word_t *word) {
+    bool folded;
+    if (!fold_constants(ctx, builder, word, &folded)) return false;
+    if (folded) return true;
+
+    instr_t *instr = emit(ctx, builder, op);
+    if (!instr) return false;
+    instr->arg.word = word;     /* Primitives keep their builtin as a fallback */
+    return true;
+}
+
+/*
+ * Inlining. A call to a short user word with no control flow compiles
+ * to a copy of its body instead. Callers keep the body that was current
+ * when they were compiled, which is also what ANS requires of a call
+ * when the callee is redefined later.
+ */
+#define INLINE_MAX_LENGTH 8
+
+/* Builtin an inline primitive stands for, unless it has been redefined */
+static word_t* primitive_builtin(rforth_ctx_t *ctx, opcode_t op) {
+    for (int i = 0; primitives[i].name; i++) {
+        if (primitives[i].op == op) {
+            word_t *word = dict_find(ctx->dict, primitives[i].name);
+            return word && word->type == WORD_BUILTIN ? word : NULL;
+        }
+    }
+    return NULL;
+}
+
+static int superinstruction_index(opcode_t op) {
+    for (int s = 0; s < SUPERINSTRUCTION_COUNT; s++) {
+        if (superinstructions[s].op == op) return s;
+    }
+    return -1;
+}
+
+/*
+ * Instructions a copy of the body would emit, or -1 if it cannot be
+ * inlined. Superinstructions are split back into their parts, so each
+ * part needs the builtin it stands for.
+ */
+static int inline_length(rforth_ctx_t *ctx, const word_t *word) {
+    int length = 0;
+
+    for (int i = 0; i < word->body_length; i++) {
+        opcode_t op = word->body[i].op;
+        switch (op) {
+            case OP_EXIT:
+                if (i != word->body_length - 1) return -1;
+                break;
+            case OP_CHECK_DEPTH:
+                break;              /* Recomputed for the caller */
+            case OP_RECURSE:
+            case OP_TAIL_RECURSE:
+            case OP_BRANCH:
+            case OP_0BRANCH:
+            case OP_DO:
+            case OP_LOOP:
+            case OP_PLUS_LOOP:
+            case OP_LEAVE:
+                return -1;
+            default: {
+                int s = superinstruction_index(op);
+                if (s < 0) {
+                    length++;
+                    break;
+                }
+                for (int k = 0; k < superinstructions[s].length; k++) {
+                    opcode_t part = superinstructions[s].parts[k];
+                    if (part != OP_LIT && !primitive_builtin(ctx, part)) return -1;
+                }
+                length += superinstructions[s].length;
+                break;
+            }
+        }
+    }
+    return length;
+}
+
+static char* copy_text(rforth_ctx_t *ctx, const char *text, size_t length) {
+    char *copy = malloc(length + 1);
+    if (!copy) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to copy inlined string");
+        return NULL;
+    }
+    memcpy(copy, text, length + 1);
+    return copy;
+}
+
+/*
+ * Append the body of word, undoing fusion and quickening so the caller's
+ * own folding, verifier, fusion and type feedback see plain primitives.
+ */
+static bool compile_inline(rforth_ctx_t *ctx, vm_builder_t *builder, const word_t *word) {
+    instr_t *instr;
+
+    for (int i = 0; i < word->body_length; i++) {
+        const instr_t *source = &word->body[i];
+        opcode_t op = source->op;
+        if (op == OP_EXIT || op == OP_CHECK_DEPTH) continue;
+
+        int s = superinstruction_index(op);
+        if (s >= 0) {
+            for (int k = 0; k < superinstructions[s].length; k++) {
+                opcode_t part = superinstructions[s].parts[k];
+                if (part == OP_LIT) {
+                    if (!(instr = emit(ctx, builder, OP_LIT))) return false;
+                    instr->arg.literal = source->arg.literal;
+                } else if (!compile_call(ctx, builder, part, primitive_builtin(ctx, part))) {
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        if (op >= OP_ADD_INT && op <= OP_GREATER_INT) {
+            op = (opcode_t)(op - OP_ADD_INT + OP_ADD);
+        }
+        if (op == OP_TAIL_CALL) op = OP_CALL;      /* No longer last in the caller */
+        if (op == OP_TAIL_CALL_NAME) op = OP_CALL_NAME;
+        if (op == OP_CALL || (op != OP_LIT && primitive_builtin(ctx, op))) {
+            if (!compile_call(ctx, builder, op, source->arg.word)) return false;
+            continue;
+        }
+        if (!(instr = emit(ctx, builder, op))) return false;
+        instr->arg = source->arg;
+        if (op == OP_TYPE || op == OP_SLIT) {
+            instr->arg.string.text = copy_text(ctx, source->arg.string.text, source->arg.string.length);
+            if (!instr->arg.string.text) return false;
+        }
+    }
+    return true;
+}
+
+bool vm_compile_token(rforth_ctx_t *ctx, vm_builder_t *builder, const token_t *token) {
+    if (!ctx || !builder || !token) return false;
+
+    instr_t *instr;
+
+    switch (token->type) {
+        case TOKEN_NUMBER:
+            if (!(instr = emit(ctx, builder, OP_LIT))) return false;
+            instr->arg.literal = cell_make_int(token->value.number);
+            return true;
+
+        case TOKEN_FLOAT:
+            if (!(instr = emit(ctx, builder, OP_LIT))) return false;
+            instr->arg.literal = cell_make_float(token->value.float_val);
+            return true;
+
+        case TOKEN_FLOAT_EXP:
+            if (!(instr = emit(ctx, builder, OP_FLIT))) return false;
+            instr->arg.literal = cell_make_float(token->value.float_val);
+            return true;
+
+        case TOKEN_WORD: {
+            bool handled;
+            if (!compile_control_word(ctx, builder, token->symbol, &handled)) return false;
+            if (handled) return true;
+
+            word_t *word = dict_find_symbol(ctx->dict, token->symbol);
+            if (word && word->type == WORD_IMMEDIATE) {
+                word_execute(ctx, word);
+                return ctx->last_error.code == RFORTH_OK;
+            }
+
+            /* Code that may outlive a redefinition finds its words when it runs */
+            if (word && builder->late_bind) {
+                if (!(instr = emit(ctx, builder, OP_CALL_NAME))) return false;
+                instr->arg.ref.symbol = word->symbol;
+                return true;
+            }
+
+            /* Constants compile to their value, variables to their slot address */
+            if (word && word->type == WORD_CONSTANT) {
+                if (!(instr = emit(ctx, builder, OP_LIT))) return false;
+                instr->arg.literal = *word->code.slot;
+                return true;
+            }
+            if (word && word->type == WORD_FCONSTANT) {
+                if (!(instr = emit(ctx, builder, OP_FLIT))) return false;
+                instr->arg.literal = *word->code.slot;
+                return true;
+            }
+            if (word && word->type == WORD_VARIABLE) {
+                if (!(instr = emit(ctx, builder, OP_LIT))) return false;
+                instr->arg.literal = cell_make_int((int64_t)(uintptr_t)word->code.slot);
+                return true;
+            }
+
+            if (word && word->type == WORD_USER && word->body) {
+                int length = inline_length(ctx, word);
+                if (length >= 0 && length <= INLINE_MAX_LENGTH) {
+                    return compile_inline(ctx, builder, word);
+                }
+            }
+
+            if (word) {
+                opcode_t op = OP_CALL;
+                if (word->type == WORD_BUILTIN) {
+                    op = primitive_opcode(word->name);
+                }
+                return compile_call(ctx, builder, op, word);
+            }
+
+            /* Not defined yet: look the name up when executed, so it needs a symbol now */
+            symbol_t symbol = token->symbol ? token->symbol : symbol_intern(token->start, token->length);
+            if (!symbol) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to intern forward reference");
+                return false;
+            }
+            if (!(instr = emit(ctx, builder, OP_CALL_NAME))) return false;
+            instr->arg.ref.symbol = symbol;
+            return true;
+        }
+
+        default:
+            RFORTH_SET_PARSE_ERROR(ctx, RFORTH_ERROR_SYNTAX_ERROR, "Unexpected token",
+                                   token->line, token->col);
+            return false;
+    }
+}
+
+static bool is_branch(opcode_t op) {
+    return op == OP_BRANCH || op == OP_0BRANCH || op == OP_LOOP ||
+           op == OP_PLUS_LOOP || op == OP_LEAVE;
+}
+
+/* Longest superinstruction matching at code[i], or -1 */
+static int match_superinstruction(const instr_t *code, int length, const bool *is_target, int i) {
+    int best = -1;
+
+    for (int s = 0; s < SUPERINSTRUCTION_COUNT; s++) {
+        int n = superinstructions[s].length;
+        if (i + n > length) continue;
+        if (best >= 0 && n <= superinstructions[best].length) continue;
+
+        bool match = true;
+        for (int k = 0; k < n && match; k++) {
+            /* Control may not enter the middle of a fused sequence */
+            if (code[i + k].op != superinstructions[s].parts[k] || (k > 0 && is_target[i + k])) {
+                match = false;
+            }
+        }
+        if (match) best = s;
+    }
+    return best;
+}
+
+/* Peephole pass: replace primitive sequences with superinstructions */
+static bool fuse_superinstructions(rforth_ctx_t *ctx, vm_builder_t *builder) {
+    int length = builder->length;
+    instr_t *code = builder->code;
+    bool *is_target = calloc(length + 1, sizeof(bool));
+    int *remap = malloc(sizeof(int) * (length + 1));
+    if (!is_target || !remap) {
+        free(is_target);
+        free(remap);
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to allocate superinstruction pass");
+        return false;
+    }
+
+    for (int i = 0; i < length; i++) {
+        if (is_branch(code[i].op)) {
+            is_target[code[i].arg.target] = true;
+        }
+    }
+
+    int out = 0;
+    for (int i = 0; i < length; ) {
+        int s = match_superinstruction(code, length, is_target, i);
+        int n = s >= 0 ? superinstructions[s].length : 1;
+
+        instr_t fused = code[i];
+        if (s >= 0) {
+            fused.op = superinstructions[s].op;
+            for (int k = 0; k < n; k++) {
+                if (code[i + k].op == OP_LIT) fused.arg.literal = code[i + k].arg.literal;
+            }
+        }
+
+        for (int k = 0; k < n; k++) {
+            remap[i + k] = out;
+        }
+        code[out++] = fused;
+        i += n;
+    }
+    remap[length] = out;
+
+    for (int i = 0; i < out; i++) {
+        if (is_branch(code[i].op)) {
+            code[i].arg.target = remap[code[i].arg.target];
+        }
+    }
+    builder->length = out;
+
+    free(is_target);
+    free(remap);
+    return true;
+}
+
+/*
+ * Stack-effect verifier. A body of inline primitives with no calls or
+ * branches has a fixed effect, so one OP_CHECK_DEPTH at entry can test
+ * the deepest read and highest push of the whole word, and the
+ * primitives after it skip their own bounds checks. Anything else
+ * keeps the checked path.
+ */
+static bool verify_stack_effect(rforth_ctx_t *ctx, vm_builder_t *builder) {
+    int depth = 0, need = 0, room = 0, checks = 0;
+
+    for (int i = 0; i < builder->length; i++) {
+        opcode_t op = builder->code[i].op;
+        if (op == OP_EXIT) break;       /* Nothing after it can run */
+        if (!stack_effects[op].known) return true;
+
+        int in = stack_effects[op].in, out = stack_effects[op].out;
+        if (in - depth > need) need = in - depth;
+        depth += out - in;
+        if (depth > room) room = depth;
+        if (in > 0 || out > 0) checks++;
+    }
+
+    /* Only worth a dispatch when it replaces more than one check */
+    if (checks < 2) return true;
+
+    if (!emit(ctx, builder, OP_CHECK_DEPTH)) return false;
+    instr_t *code = builder->code;
+    memmove(code + 1, code, sizeof(instr_t) * (builder->length - 1));
+    memset(&code[0], 0, sizeof(instr_t));
+    code[0].op = OP_CHECK_DEPTH;
+    code[0].arg.depth.need = need;
+    code[0].arg.depth.room = room;
+    return true;
+}
+
+/*
+ * Tail calls. A call to a user word whose next step is OP_EXIT, directly
+ * or through unconditional branches, can reuse the caller's frame.
+ * Calls inside a DO loop keep a frame: the callee may read the loop
+ * index with I, and the loop parameters go when the caller's frame does.
+ */
+static void mark_tail_calls(vm_builder_t *builder) {
+    instr_t *code = builder->code;
+    int length = builder->length;
+
+    for (int i = 0; i < length; i++) {
+        bool call = code[i].op == OP_CALL && code[i].arg.word->type == WORD_USER;
+        if (!call && code[i].op != OP_CALL_NAME && code[i].op != OP_RECURSE) continue;
+
+        int next = i + 1;
+        for (int hops = 0; next < length && code[next].op == OP_BRANCH && hops < length; hops++) {
+            next = code[next].arg.target;
+        }
+        if (next >= length || code[next].op != OP_EXIT) continue;
+
+        bool in_loop = false;
+        for (int j = 0; j < length; j++) {
+            if ((code[j].op == OP_LOOP || code[j].op == OP_PLUS_LOOP) &&
+                code[j].arg.target <= i && i < j) {
+                in_loop = true;
+                break;
+            }
+        }
+        if (in_loop) continue;
+        if (code[i].op == OP_CALL_NAME) code[i].op = OP_TAIL_CALL_NAME;
+        else code[i].op = call ? OP_TAIL_CALL : OP_TAIL_RECURSE;
+    }
+}
+
+bool vm_builder_finish(rforth_ctx_t *ctx, vm_builder_t *builder, instr_t **code, int *length) {
+    if (!ctx || !builder || !code || !length) return false;
+
+    if (builder->cf_sp > 0) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "Unterminated control structure");
+        return false;
+    }
+
+    /* The JIT has no templates for the entry check or fused opcodes */
+    if (!ctx->jit && !verify_stack_effect(ctx, builder)) return false;
+    if (builder->fuse && !ctx->jit && !fuse_superinstructions(ctx, builder)) return false;
+
+    /* Falling off the end of the body returns to the caller */
+    if (!emit(ctx, builder, OP_EXIT)) return false;
+    mark_tail_calls(builder);
+    vm_thread_code(builder->code, builder->length);
+
+    /* Hand the instruction array to the caller */
+    *code = builder->code;
+    *length = builder->length;
+    builder->code = NULL;
+    builder->length = 0;
+    builder->capacity = 0;
+    return true;
+}
+
+/*
+ * Words that read the input when they run. Inside an interpreted control
+ * structure they run only after the closing word has been read, so they
+ * are compiled as EVALUATE of their own text instead: "1 if variable v
+ * then" still names v. The rest mean nothing outside a definition.
+ */
+static int parses_input(symbol_t symbol) {
+    switch (symbol) {
+        case SYM_VARIABLE: case SYM_CONSTANT: case SYM_CREATE: case SYM_FORGET:
+        case SYM_FVARIABLE: case SYM_FCONSTANT:
+            return 1;           /* Takes a name */
+        case SYM_S_QUOTE:
+            return 2;           /* Takes text up to a quote */
+        case SYM_LEFT_BRACKET: case SYM_RIGHT_BRACKET: case SYM_LITERAL:
+        case SYM_POSTPONE: case SYM_DOES: case SYM_EXIT: case SYM_RECURSE: case SYM_QUIT:
+            return -1;
+        default:
+            return 0;
+    }
+}
+
+/* The builtin EVALUATE, also when a later definition shadows it */
+static word_t* evaluate_builtin(rforth_ctx_t *ctx) {
+    word_t *word = dict_find(ctx->dict, "evaluate");
+    while (word && word->type != WORD_BUILTIN) word = word->shadowed;
+    return word;
+}
+
+/* Compile a parsing word and what it parses as a call to EVALUATE of that text */
+static bool compile_deferred(rforth_ctx_t *ctx, vm_builder_t *builder, const token_t *token, int kind) {
+    const char *end;
+    if (kind == 1) {
+        token_t name = parser_next_token(ctx->parser);
+        if (name.type == TOKEN_EOF) {
+            RFORTH_SET_PARSE_ERROR(ctx, RFORTH_ERROR_PARSE_ERROR, "Defining word requires a name",
+                                   token->line, token->col);
+            return false;
+        }
+        end = name.start + name.length;
+    } else {
+        end = strchr(ctx->parser->current, '"');
+        if (!end) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_UNTERMINATED_STRING, "Unterminated string literal");
+            return false;
+        }
+        ctx->parser->current = ++end;
+    }
+
+    word_t *evaluate = evaluate_builtin(ctx);
+    int length = (int)(end - token->start);
+    char *text = malloc(length + 1);
+    if (!evaluate || !text) {
+        free(text);
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to allocate string literal");
+        return false;
+    }
+    memcpy(text, token->start, length);
+    text[length] = '\0';
+
+    instr_t *instr = emit(ctx, builder, OP_SLIT);
+    if (!instr) {
+        free(text);
+        return false;
+    }
+    instr->arg.string.text = text;
+    instr->arg.string.length = length;
+
+    if (!(instr = emit(ctx, builder, OP_CALL))) return false;
+    instr->arg.word = evaluate;
+    return true;
+}
+
+bool vm_interpret_control(rforth_ctx_t *ctx, symbol_t name) {
+    vm_builder_t *builder = vm_builder_create();
+    if (!builder) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to allocate control structure");
+        return false;
+    }
+
+    token_t token;
+    memset(&token, 0, sizeof(token));
+    token.type = TOKEN_WORD;
+    token.symbol = name;
+
+    /* Compile up to the word that closes the outermost structure */
+    bool ok = vm_compile_token(ctx, builder, &token);
+    while (ok && builder->cf_sp > 0) {
+        token = parser_next_token(ctx->parser);
+        if (token.type == TOKEN_EOF) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "Unterminated control structure");
+            ok = false;
+        } else if (token.type == TOKEN_COLON || token.type == TOKEN_SEMICOLON) {
+            RFORTH_SET_PARSE_ERROR(ctx, RFORTH_ERROR_SYNTAX_ERROR, "Definition inside control structure",
+                                   token.line, token.col);
+            ok = false;
+        } else if (token.type == TOKEN_WORD && parses_input(token.symbol) < 0) {
+            RFORTH_SET_PARSE_ERROR(ctx, RFORTH_ERROR_SYNTAX_ERROR, "Compile-only word inside control structure",
+                                   token.line, token.col);
+            ok = false;
+        } else if (token.type == TOKEN_WORD && parses_input(token.symbol) > 0) {
+            ok = compile_deferred(ctx, builder, &token, parses_input(token.symbol));
+        } else {
+            ok = vm_compile_token(ctx, builder, &token);
+        }
+    }
+
+    word_t code;
+    memset(&code, 0, sizeof(code));
+    strcpy(code.name, "(interpret)");
+    code.type = WORD_USER;
+    if (ok && vm_builder_finish(ctx, builder, &code.body, &code.body_length)) {
+        vm_execute(ctx, &code);
+        vm_code_free(code.body, code.body_length);
+    }
+
+    vm_builder_destroy(builder);
+    return ctx->last_error.code == RFORTH_OK;
+}
+
+void vm_code_free(instr_t *code, int length) {
+    if (!code) return;
+
+    for (int i = 0; i < length; i++) {
+        if (code[i].op == OP_TYPE || code[i].op == OP_SLIT) {
+            free(code[i].arg.string.text);
+        }
+    }
+    free(code);
+}
+
+/* Inner interpreter */
+
+#ifdef VM_DIRECT_THREADED
+/* Handler addresses exported by vm_run, indexed by opcode */
+static const void *const *vm_handlers = NULL;
+/* The same, entering primitives past their bounds checks */
+static const void *const *vm_unchecked_handlers = NULL;
+#endif
+
+static cell_t* vm_run(rforth_ctx_t *ctx, word_t *word, cell_t *sp);
+
+/* Change the opcode of an instruction inside the running body code */
+static void vm_rewrite(instr_t *instr, opcode_t op, const instr_t *code) {
+    instr->op = op;
+#ifdef VM_DIRECT_THREADED
+    instr->handler = (code[0].op == OP_CHECK_DEPTH ? vm_unchecked_handlers : vm_handlers)[op];
+#else
+    (void)code;
+#endif
+}
+
+/*
+ * Enter a user word, through its native code when the JIT is on. sp
+ * points at the top cell; threaded code passes it straight on instead
+ * of going through ctx->data_stack, which only native code needs.
+ * Once native calls nest as deep as the JIT allows, words run threaded
+ * and deeper calls take frames from ctx->call_frames instead.
+ */
+static bool vm_has_native(rforth_ctx_t *ctx, word_t *word) {
+    if (!ctx->jit || !jit_can_nest(ctx->jit)) return false;
+    return word->native_code || jit_compile(ctx->jit, word);
+}
+
+static cell_t* vm_call(rforth_ctx_t *ctx, word_t *word, cell_t *sp) {
+    if (vm_has_native(ctx, word)) {
+        rforth_stack_t *ds = ctx->data_stack;
+        ds->sp = (int)(sp - ds->data);
+        jit_execute(ctx, word);
+        return ds->data + ds->sp;
+    }
+    return vm_run(ctx, word, sp);
+}
+
+static bool cell_is_true(const cell_t *cell) {
+    return CELL_TYPE(*cell) == CELL_INT ? cell->value.i != 0 : cell->value.f != 0.0;
+}
+
+void vm_thread_code(instr_t *code, int length) {
+#ifdef VM_DIRECT_THREADED
+    if (!vm_handlers) {
+        vm_run(NULL, NULL, NULL);
+    }
+    const void *const *handlers = (length > 0 && code[0].op == OP_CHECK_DEPTH)
+        ? vm_unchecked_handlers : vm_handlers;
+    for (int i = 0; i < length; i++) {
+        code[i].handler = handlers[code[i].op];
+    }
+#else
+    (void)code;
+    (void)length;
+#endif
+}
+
+/*
+ * Inline cache of an OP_CALL_NAME site. The word found is kept with the
+ * dictionary generation it was found in; any definition or FORGET moves
+ * the generation on, and the next execution looks the name up again.
+ * A site therefore never runs a forgotten word and follows
+ * redefinitions, at the cost of one compare per call in between.
+ */
+bool vm_resolve_call(rforth_ctx_t *ctx, instr_t *instr) {
+    if (instr->site.generation == ctx->dict->generation) return true;
+
+    word_t *target = dict_find_symbol(ctx->dict, instr->arg.ref.symbol);
+    if (!target) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_WORD_NOT_FOUND, "Word not found");
+        return false;
+    }
+    instr->arg.ref.word = target;
+    instr->site.generation = ctx->dict->generation;
+    return true;
+}
+
+/* Make room for at least one more call frame */
+static bool vm_frames_grow(rforth_ctx_t *ctx) {
+    int new_capacity = ctx->call_capacity ? ctx->call_capacity * 2 : INITIAL_CALL_DEPTH;
+    if (ctx->call_capacity >= MAX_CALL_DEPTH) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_RETURN_STACK_OVERFLOW, "Return stack overflow");
+        return false;
+    }
+    vm_frame_t *frames = realloc(ctx->call_frames, sizeof(vm_frame_t) * new_capacity);
+    if (!frames) {
+        RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to grow return stack");
+        return false;
+    }
+    ctx->call_frames = frames;
+    ctx->call_capacity = new_capacity;
+    return true;
+}
+
+bool vm_loop_push(rforth_ctx_t *ctx, int64_t index, int64_t limit) {
+    if (ctx->do_loop_sp >= ctx->loop_capacity) {
+        int new_capacity = ctx->loop_capacity * 2;
+        int64_t *new_index = realloc(ctx->loop_index, sizeof(int64_t) * new_capacity);
+        if (new_index) ctx->loop_index = new_index;
+        int64_t *new_limit = realloc(ctx->loop_limit, sizeof(int64_t) * new_capacity);
+        if (new_limit) ctx->loop_limit = new_limit;
+        if (!new_index || !new_limit) {
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_MEMORY, "Failed to grow DO/LOOP stack");
+            return false;
+        }
+        ctx->loop_capacity = new_capacity;
+    }
+
+    ctx->loop_index[ctx->do_loop_sp] = index;
+    ctx->loop_limit[ctx->do_loop_sp] = limit;
+    ctx->do_loop_sp++;
+    return true;
+}
+
+const char* vm_dispatch_name(void) {
+#if defined(VM_DIRECT_THREADED)
+    return "direct-threaded (computed goto)";
+#elif defined(VM_TOKEN_THREADED)
+    return "token-threaded (computed goto)";
+#else
+    return "token-threaded (switch)";
+#endif
+}
+
+/*
+ * Dispatch macros. With GCC/Clang each handler ends in its own indirect
+ * jump (NEXT); elsewhere the handlers are cases of a switch in a loop.
+ */
+#ifdef RFORTH_PROFILE
+/* Executed counts of adjacent fusable primitives */
+static uint64_t profile_pairs[OP_COUNT][OP_COUNT];
+static uint64_t profile_triples[OP_COUNT][OP_COUNT][OP_COUNT];
+static const instr_t *profile_prev[2];
+
+/* Quickened sites count as the generic op they were rewritten from */
+static opcode_t profile_op(const instr_t *instr) {
+    opcode_t op = instr->op;
+    if (op >= OP_ADD_INT && op <= OP_GREATER_INT) {
+        op = (opcode_t)(op - OP_ADD_INT + OP_ADD);
+    }
+    return op;
+}
+
+static void profile_instr(const instr_t *instr) {
+    const instr_t *prev = profile_prev[0], *prev2 = profile_prev[1];
+    opcode_t op = profile_op(instr);
+
+    if (fusable_names[op] && prev == instr - 1 && fusable_names[profile_op(prev)]) {
+        profile_pairs[profile_op(prev)][op]++;
+        if (prev2 == prev - 1 && fusable_names[profile_op(prev2)]) {
+            profile_triples[profile_op(prev2)][profile_op(prev)][op]++;
+        }
+    }
+    profile_prev[1] = prev;
+    profile_prev[0] = instr;
+}
+#define PROFILE(instr)  profile_instr(instr)
+#else
+#define PROFILE(instr)  ((void)0)
+#endif
+
+/*
+ * VM_PRIM(name, checks) starts a primitive handler with its bounds
+ * checks. Code after OP_CHECK_DEPTH enters at U_name, past the checks;
+ * the switch version tests a flag instead.
+ */
+#if defined(VM_DIRECT_THREADED)
+#define VM_DISPATCH()   do { instr = ip++; PROFILE(instr); goto *instr->handler; } while (0)
+#define VM_OP(name)     L_##name:
+#define VM_PRIM(name, checks) L_##name: checks; U_##name:
+#define NEXT            VM_DISPATCH()
+#elif defined(VM_TOKEN_THREADED)
+#define VM_DISPATCH()   do { instr = ip++; PROFILE(instr); goto *table[instr->op]; } while (0)
+#define VM_OP(name)     L_##name:
+#define VM_PRIM(name, checks) L_##name: checks; U_##name:
+#define NEXT            VM_DISPATCH()
+#else
+#define VM_OP(name)     case name:
+#define VM_PRIM(name, checks) case name: if (checked) { checks; }
+#define NEXT            continue
+#endif
+
+/*
+ * Data stack access for the primitives. The top cell is cached in the
+ * local tos and sp points at its slot, which is stale; the cells below
+ * it are in memory. Calls to other threaded words pass sp along with
+ * the top cell stored in its slot. SPILL writes the cache back to
+ * ctx->data_stack before builtins or native code look at it, and FILL
+ * reloads it afterwards. An empty stack spills into the scratch cell
+ * at data[-1].
+ */
+#define TOS             tos
+#define NOS             (sp[-1])
+#define DEPTH_TOP       ((int)(sp - ds->data))
+#define PUSH(cell)      do { cell_t pushed_ = (cell); *sp++ = tos; tos = pushed_; } while (0)
+#define DROP_TOS()      (tos = *--sp)
+#define SPILL()         do { *sp = tos; ds->sp = DEPTH_TOP; } while (0)
+#define FILL()          do { sp = ds->data + ds->sp; tos = *sp; } while (0)
+#define NEED(n)         do { if (DEPTH_TOP < (n) - 1) goto underflow; } while (0)
+#define ROOM(n)         do { if (DEPTH_TOP + (n) >= ds->size) goto overflow; } while (0)
+
+/* Integer op when both cells are integers, float op otherwise */
+#define BINARY_ARITH(op) do { \
+        cell_t *a = &NOS; \
+        if (CELL_TYPE(*a) == CELL_INT && CELL_TYPE(TOS) == CELL_INT) { \
+            TOS.value.i = a->value.i op TOS.value.i; \
+        } else { \
+            TOS = cell_make_float(cell_to_float(a) op cell_to_float(&TOS)); \
+        } \
+        sp--; \
+    } while (0)
+
+#define BINARY_COMPARE(op) do { \
+        cell_t *a = &NOS; \
+        bool result = (CELL_TYPE(*a) == CELL_INT && CELL_TYPE(TOS) == CELL_INT) \
+            ? (a->value.i op TOS.value.i) \
+            : (cell_to_float(a) op cell_to_float(&TOS)); \
+        TOS = cell_make_int(result ? -1 : 0); \
+        sp--; \
+    } while (0)
+
+/*
+ * Type feedback for the mixed-type binary primitives. A site that has
+ * seen only integers QUICKEN_THRESHOLD times is rewritten to its _INT
+ * form, which tests both tags at once and has no float path. Untagged
+ * cells are always integers, so there is nothing to specialize.
+ */
+#define QUICKEN_THRESHOLD 8
+
+#ifdef RFORTH_UNTAGGED_CELLS
+#define FEEDBACK(name)  ((void)0)
+#else
+#define FEEDBACK(name) do { \
+        if (CELL_TYPE(NOS) != CELL_INT || CELL_TYPE(TOS) != CELL_INT) { \
+            instr->site.feedback = -1; \
+        } else if (instr->site.feedback >= 0 && ++instr->site.feedback >= QUICKEN_THRESHOLD) { \
+            vm_rewrite(instr, OP_##name##_INT, code); \
+        } \
+    } while (0)
+#endif
+
+/* CELL_INT is 0, so one test covers both operands */
+#define INT_OPERANDS()  ((CELL_TYPE(NOS) | CELL_TYPE(TOS)) == CELL_INT)
+
+/* A float reached a quickened site: restore the generic op for good; NEXT reruns it */
+#define DEOPT() do { \
+        instr->site.feedback = -1; \
+        vm_rewrite(instr, (opcode_t)(instr->op - OP_ADD_INT + OP_ADD), code); \
+        ip = instr; \
+    } while (0)
+
+#define INT_ARITH(op) do { \
+        sp--; \
+        TOS.value.i = sp->value.i op TOS.value.i; \
+    } while (0)
+
+#define INT_COMPARE(op) do { \
+        sp--; \
+        TOS.value.i = (sp->value.i op TOS.value.i) ? -1 : 0; \
+    } while (0)
+
+/*
+ * Primitive bodies, shared by the single-op handlers and the
+ * superinstructions. Stack bounds are checked by the caller.
+ */
+#define PRIM_LIT        PUSH(instr->arg.literal)
+#define PRIM_DUP        (*sp++ = TOS)
+#define PRIM_DROP       DROP_TOS()
+#define PRIM_SWAP       do { value = TOS; TOS = NOS; NOS = value; } while (0)
+#define PRIM_OVER       PUSH(NOS)
+#define PRIM_ADD        BINARY_ARITH(+)
+#define PRIM_SUB        BINARY_ARITH(-)
+#define PRIM_MUL        BINARY_ARITH(*)
+#define PRIM_EQUAL      BINARY_COMPARE(==)
+#define PRIM_LESS       BINARY_COMPARE(<)
+#define PRIM_GREATER    BINARY_COMPARE(>)
+#define PRIM_ZERO_EQUAL TOS = cell_make_int(cell_is_true(&TOS) ? 0 : -1)
+
+#define PRIM_ONE_PLUS do { \
+        if (CELL_TYPE(TOS) == CELL_INT) TOS.value.i++; \
+        else TOS.value.f += 1.0; \
+    } while (0)
+
+#define PRIM_ONE_MINUS do { \
+        if (CELL_TYPE(TOS) == CELL_INT) TOS.value.i--; \
+        else TOS.value.f -= 1.0; \
+    } while (0)
+
+#define PRIM_FETCH do { \
+        cell_t *cell_ptr_ = CELL_TYPE(TOS) == CELL_INT ? \
+            dataspace_ptr(&ctx->data_space, TOS.value.i, sizeof(cell_t)) : NULL; \
+        if (!cell_ptr_) { \
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_ADDRESS, "@ invalid address"); \
+            goto error; \
+        } \
+        TOS = *cell_ptr_; \
+    } while (0)
+
+#define PRIM_STORE do { \
+        cell_t *cell_ptr_ = CELL_TYPE(TOS) == CELL_INT ? \
+            dataspace_ptr(&ctx->data_space, TOS.value.i, sizeof(cell_t)) : NULL; \
+        if (!cell_ptr_) { \
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_INVALID_ADDRESS, "! invalid address"); \
+            goto error; \
+        } \
+        *cell_ptr_ = NOS; \
+        sp -= 2; \
+        TOS = *sp; \
+    } while (0)
+
+#define PRIM_I do { \
+        if (ctx->do_loop_sp <= 0) { \
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "I outside of DO/LOOP"); \
+            goto error; \
+        } \
+        PUSH(cell_make_int(ctx->loop_index[ctx->do_loop_sp - 1])); \
+    } while (0)
+
+#define PRIM_J do { \
+        if (ctx->do_loop_sp < 2) { \
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "J outside of nested DO/LOOP"); \
+            goto error; \
+        } \
+        PUSH(cell_make_int(ctx->loop_index[ctx->do_loop_sp - 2])); \
+    } while (0)
+
+/*
+ * Superinstruction bounds: cells the sequence needs on entry and the
+ * most it grows the stack at any point, folded to constants.
+ */
+#define VM_MAX(a, b)    ((a) > (b) ? (a) : (b))
+#define GROWTH(x)       (OUT_##x - IN_##x)
+#define NEED2(a, b)     VM_MAX(IN_##a, IN_##b - GROWTH(a))
+#define ROOM2(a, b)     VM_MAX(GROWTH(a), GROWTH(a) + GROWTH(b))
+#define NEED3(a, b, c)  VM_MAX(NEED2(a, b), IN_##c - GROWTH(a) - GROWTH(b))
+#define ROOM3(a, b, c)  VM_MAX(ROOM2(a, b), GROWTH(a) + GROWTH(b) + GROWTH(c))
+
+/* One combined check per superinstruction */
+#define CHECK_BOUNDS(need, room) do { \
+        if (DEPTH_TOP < (need) - 1) goto underflow; \
+        if ((room) > 0 && DEPTH_TOP + (room) >= ds->size) goto overflow; \
+    } while (0)
+
+/*
+ * Nested user words run in this same vm_run: a call saves the return
+ * point on ctx->call_frames and switches code to the callee, and OP_EXIT
+ * pops it again. Only native code and builtins recurse in C.
+ */
+#define PUSH_FRAME() do { \
+        if (ctx->call_sp >= ctx->call_capacity && !vm_frames_grow(ctx)) goto error; \
+        vm_frame_t *frame_ = &ctx->call_frames[ctx->call_sp++]; \
+        frame_->ip = ip; \
+        frame_->word = word; \
+        frame_->loop_base = loop_base; \
+    } while (0)
+
+#define ENTER(target) do { \
+        word = (target); \
+        code = ip = word->body; \
+        loop_base = ctx->do_loop_sp; \
+    } while (0)
+
+#define CALL_WORD(target) do { \
+        word_t *target_ = (target); \
+        if (target_->type == WORD_USER && !vm_has_native(ctx, target_)) { \
+            PUSH_FRAME(); \
+            ENTER(target_); \
+        } else { \
+            if (target_->type == WORD_USER) { \
+                *sp = TOS; \
+                sp = vm_call(ctx, target_, sp); \
+                TOS = *sp; \
+            } else { \
+                SPILL(); \
+                word_execute(ctx, target_); \
+                FILL(); \
+            } \
+            if (ctx->last_error.code != RFORTH_OK) goto error; \
+        } \
+    } while (0)
+
+/* A word returned to may have been left in a verified body's unchecked mode */
+#if defined(VM_TOKEN_THREADED)
+#define VM_CHECKED()    (table = dispatch_table)
+#elif defined(VM_SWITCH_DISPATCH)
+#define VM_CHECKED()    (checked = true)
+#else
+#define VM_CHECKED()    ((void)0)
+#endif
+
+static cell_t* vm_run(rforth_ctx_t *ctx, word_t *word, cell_t *sp) {
+#if defined(VM_DIRECT_THREADED) || defined(VM_TOKEN_THREADED)
+#define HANDLER(name) [OP_##name] = &&L_OP_##name,
+#define PRIM_HANDLER(name, in, out) [OP_##name] = &&L_OP_##name,
+#define PRIM_UNCHECKED(name, in, out) [OP_##name] = &&U_OP_##name,
+#define UNCHECKED(name) [OP_##name] = &&U_OP_##name,
+#define CONTROL_OPS(X) \
+    X(CALL) X(CALL_NAME) X(RECURSE) X(TAIL_CALL) X(TAIL_CALL_NAME) X(TAIL_RECURSE) X(BRANCH) X(0BRANCH) X(DO) X(LOOP) \
+    X(PLUS_LOOP) X(LEAVE) X(EXIT) X(TYPE) X(SLIT) X(FLIT) X(CHECK_DEPTH)
+#define QUICKENED_OPS(X) \
+    X(ADD_INT) X(SUB_INT) X(MUL_INT) X(EQUAL_INT) X(LESS_INT) X(GREATER_INT)
+
+    static const void *const dispatch_table[OP_COUNT] = {
+        CONTROL_OPS(HANDLER)
+        FUSABLE_PRIMITIVES(PRIM_HANDLER)
+        QUICKENED_OPS(HANDLER)
+#define SUPER2(name, a, b) [OP_##name] = &&L_OP_##name,
+#define SUPER3(name, a, b, c) [OP_##name] = &&L_OP_##name,
+#include "superinstructions.def"
+#undef SUPER2
+#undef SUPER3
+    };
+    static const void *const unchecked_table[OP_COUNT] = {
+        CONTROL_OPS(HANDLER)
+        FUSABLE_PRIMITIVES(PRIM_UNCHECKED)
+        QUICKENED_OPS(UNCHECKED)
+#define SUPER2(name, a, b) [OP_##name] = &&U_OP_##name,
+#define SUPER3(name, a, b, c) [OP_##name] = &&U_OP_##name,
+#include "superinstructions.def"
+#undef SUPER2
+#undef SUPER3
+    };
+#undef HANDLER
+#undef PRIM_HANDLER
+#undef PRIM_UNCHECKED
+#undef UNCHECKED
+#undef CONTROL_OPS
+#undef QUICKENED_OPS
+#endif
+
+#ifdef VM_DIRECT_THREADED
+    if (!ctx) {
+        vm_handlers = dispatch_table;
+        vm_unchecked_handlers = unchecked_table;
+        return NULL;
+    }
+#endif
+
+    rforth_stack_t *ds = ctx->data_stack;
+    instr_t *code = word->body;
+    instr_t *ip = code;
+    instr_t *instr;
+    int loop_base = ctx->do_loop_sp;    /* DO/LOOP frames of the running word start here */
+    const int loop_floor = loop_base;
+    const int frame_base = ctx->call_sp;
+    cell_t value;
+
+    cell_t tos = *sp;           /* Cached top of stack, see SPILL */
+#if defined(VM_TOKEN_THREADED)
+    const void *const *table = dispatch_table;
+#elif defined(VM_SWITCH_DISPATCH)
+    bool checked = true;
+#endif
+
+#if defined(VM_DIRECT_THREADED) || defined(VM_TOKEN_THREADED)
+    VM_DISPATCH();
+    {
+#else
+    for (;;) {
+        instr = ip++;
+        PROFILE(instr);
+        switch (instr->op) {
+#endif
+
+        VM_OP(OP_CALL) {
+            CALL_WORD(instr->arg.word);
+            NEXT;
+        }
+
+        VM_OP(OP_CALL_NAME) {
+            if (instr->site.generation != ctx->dict->generation && !vm_resolve_call(ctx, instr)) {
+                goto error;
+            }
+            CALL_WORD(instr->arg.ref.word);
+            NEXT;
+        }
+
+        VM_OP(OP_RECURSE) {
+            PUSH_FRAME();
+            ENTER(word);
+            NEXT;
+        }
+
+        VM_OP(OP_TAIL_CALL) {
+            word_t *target = instr->arg.word;
+            if (vm_has_native(ctx, target)) {
+                /* Native code returns here; the OP_EXIT after this ends the word */
+                *sp = TOS;
+                sp = vm_call(ctx, target, sp);
+                TOS = *sp;
+                if (ctx->last_error.code != RFORTH_OK) goto error;
+                NEXT;
+            }
+            ctx->do_loop_sp = loop_base;
+            ENTER(target);
+            NEXT;
+        }
+
+        VM_OP(OP_TAIL_CALL_NAME) {
+            if (instr->site.generation != ctx->dict->generation && !vm_resolve_call(ctx, instr)) {
+                goto error;
+            }
+            /* Resolved at run time, so the target may not be a user word */
+            word_t *target = instr->arg.ref.word;
+            if (target->type == WORD_USER && !vm_has_native(ctx, target)) {
+                ctx->do_loop_sp = loop_base;
+                ENTER(target);
+                NEXT;
+            }
+            CALL_WORD(target);
+            NEXT;
+        }
+
+        VM_OP(OP_TAIL_RECURSE) {
+            ctx->do_loop_sp = loop_base;
+            ip = code;
+            NEXT;
+        }
+
+        VM_PRIM(OP_LIT, ROOM(1)) {
+            PRIM_LIT;
+            NEXT;
+        }
+
+        VM_OP(OP_BRANCH) {
+            ip = code + instr->arg.target;
+            NEXT;
+        }
+
+        VM_OP(OP_0BRANCH) {
+            if (DEPTH_TOP < 0) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Conditional branch requires flag on stack");
+                goto error;
+            }
+            value = TOS;
+            DROP_TOS();
+            if (!cell_is_true(&value)) {
+                ip = code + instr->arg.target;
+            }
+            NEXT;
+        }
+
+        VM_OP(OP_DO) {
+            if (DEPTH_TOP < 1) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "DO requires limit and index on stack");
+                goto error;
+            }
+            cell_t *index = &TOS, *limit = &NOS;
+            if (!vm_loop_push(ctx, (CELL_TYPE(*index) == CELL_INT) ? index->value.i : (int64_t)index->value.f,
+                              (CELL_TYPE(*limit) == CELL_INT) ? limit->value.i : (int64_t)limit->value.f)) {
+                goto error;
+            }
+            sp -= 2;
+            TOS = *sp;
+            NEXT;
+        }
+
+        VM_OP(OP_LOOP) {
+            int top = ctx->do_loop_sp - 1;
+            if (top < loop_base) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "LOOP without loop parameters");
+                goto error;
+            }
+            if (++ctx->loop_index[top] < ctx->loop_limit[top]) {
+                ip = code + instr->arg.target;
+            } else {
+                ctx->do_loop_sp--;
+            }
+            NEXT;
+        }
+
+        VM_OP(OP_PLUS_LOOP) {
+            if (DEPTH_TOP < 0) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "+LOOP requires increment on stack");
+                goto error;
+            }
+            int top = ctx->do_loop_sp - 1;
+            if (top < loop_base) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_CONTROL_FLOW, "+LOOP without loop parameters");
+                goto error;
+            }
+            value = TOS;
+            DROP_TOS();
+            int64_t inc = (CELL_TYPE(value) == CELL_INT) ? value.value.i : (int64_t)value.value.f;
+            ctx->loop_index[top] += inc;
+
+            bool continue_loop = (inc >= 0) ? (ctx->loop_index[top] < ctx->loop_limit[top])
+                                            : (ctx->loop_index[top] >= ctx->loop_limit[top]);
+            if (continue_loop) {
+                ip = code + instr->arg.target;
+            } else {
+                ctx->do_loop_sp--;
+            }
+            NEXT;
+        }
+
+        VM_OP(OP_LEAVE) {
+            if (ctx->do_loop_sp > loop_base) ctx->do_loop_sp--;
+            ip = code + instr->arg.target;
+            NEXT;
+        }
+
+        VM_OP(OP_EXIT) {
+            ctx->do_loop_sp = loop_base;
+            if (ctx->call_sp == frame_base) {
+                *sp = TOS;
+                return sp;
+            }
+
+            /* Back to the word that called this one */
+            vm_frame_t *frame = &ctx->call_frames[--ctx->call_sp];
+            ip = frame->ip;
+            word = frame->word;
+            code = word->body;
+            loop_base = frame->loop_base;
+            VM_CHECKED();
+            NEXT;
+        }
+
+        VM_OP(OP_TYPE) {
+            printf("%.*s", instr->arg.string.length, instr->arg.string.text);
+            NEXT;
+        }
+
+        VM_OP(OP_SLIT) {
+            ROOM(2);
+            PUSH(cell_make_int((int64_t)(uintptr_t)instr->arg.string.text));
+            PUSH(cell_make_int(instr->arg.string.length));
+            NEXT;
+        }
+
+        VM_OP(OP_FLIT) {
+            if (!fstack_push(ctx->float_stack, instr->arg.literal.value.f)) {
+                RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Float stack overflow");
+                goto error;
+            }
+            NEXT;
+        }
+
+        VM_OP(OP_CHECK_DEPTH) {
+            CHECK_BOUNDS(instr->arg.depth.need, instr->arg.depth.room);
+#if defined(VM_TOKEN_THREADED)
+            table = unchecked_table;
+#elif defined(VM_SWITCH_DISPATCH)
+            checked = false;
+#endif
+            NEXT;
+        }
+
+        /* Primitives executed inline instead of through word_execute */
+
+        VM_PRIM(OP_DUP, NEED(1); ROOM(1)) {
+            PRIM_DUP;
+            NEXT;
+        }
+
+        VM_PRIM(OP_DROP, NEED(1)) {
+            PRIM_DROP;
+            NEXT;
+        }
+
+        VM_PRIM(OP_SWAP, NEED(2)) {
+            PRIM_SWAP;
+            NEXT;
+        }
+
+        VM_PRIM(OP_OVER, NEED(2); ROOM(1)) {
+            PRIM_OVER;
+            NEXT;
+        }
+
+        VM_PRIM(OP_ADD, NEED(2)) {
+            FEEDBACK(ADD);
+            PRIM_ADD;
+            NEXT;
+        }
+
+        VM_PRIM(OP_SUB, NEED(2)) {
+            FEEDBACK(SUB);
+            PRIM_SUB;
+            NEXT;
+        }
+
+        VM_PRIM(OP_MUL, NEED(2)) {
+            FEEDBACK(MUL);
+            PRIM_MUL;
+            NEXT;
+        }
+
+        VM_PRIM(OP_EQUAL, NEED(2)) {
+            FEEDBACK(EQUAL);
+            PRIM_EQUAL;
+            NEXT;
+        }
+
+        VM_PRIM(OP_LESS, NEED(2)) {
+            FEEDBACK(LESS);
+            PRIM_LESS;
+            NEXT;
+        }
+
+        VM_PRIM(OP_GREATER, NEED(2)) {
+            FEEDBACK(GREATER);
+            PRIM_GREATER;
+            NEXT;
+        }
+
+        VM_PRIM(OP_ZERO_EQUAL, NEED(1)) {
+            PRIM_ZERO_EQUAL;
+            NEXT;
+        }
+
+        VM_PRIM(OP_ONE_PLUS, NEED(1)) {
+            PRIM_ONE_PLUS;
+            NEXT;
+        }
+
+        VM_PRIM(OP_ONE_MINUS, NEED(1)) {
+            PRIM_ONE_MINUS;
+            NEXT;
+        }
+
+        VM_PRIM(OP_FETCH, NEED(1)) {
+            PRIM_FETCH;
+            NEXT;
+        }
+
+        VM_PRIM(OP_STORE, NEED(2)) {
+            PRIM_STORE;
+            NEXT;
+        }
+
+        VM_PRIM(OP_I, ROOM(1)) {
+            PRIM_I;
+            NEXT;
+        }
+
+        VM_PRIM(OP_J, ROOM(1)) {
+            PRIM_J;
+            NEXT;
+        }
+
+        /* Quickened sites, see FEEDBACK */
+
+        VM_PRIM(OP_ADD_INT, NEED(2)) {
+            if (!INT_OPERANDS()) {
+                DEOPT();
+                NEXT;
+            }
+            INT_ARITH(+);
+            NEXT;
+        }
+
+        VM_PRIM(OP_SUB_INT, NEED(2)) {
+            if (!INT_OPERANDS()) {
+                DEOPT();
+                NEXT;
+            }
+            INT_ARITH(-);
+            NEXT;
+        }
+
+        VM_PRIM(OP_MUL_INT, NEED(2)) {
+            if (!INT_OPERANDS()) {
+                DEOPT();
+                NEXT;
+            }
+            INT_ARITH(*);
+            NEXT;
+        }
+
+        VM_PRIM(OP_EQUAL_INT, NEED(2)) {
+            if (!INT_OPERANDS()) {
+                DEOPT();
+                NEXT;
+            }
+            INT_COMPARE(==);
+            NEXT;
+        }
+
+        VM_PRIM(OP_LESS_INT, NEED(2)) {
+            if (!INT_OPERANDS()) {
+                DEOPT();
+                NEXT;
+            }
+            INT_COMPARE(<);
+            NEXT;
+        }
+
+        VM_PRIM(OP_GREATER_INT, NEED(2)) {
+            if (!INT_OPERANDS()) {
+                DEOPT();
+                NEXT;
+            }
+            INT_COMPARE(>);
+            NEXT;
+        }
+
+        /* Superinstructions */
+#define SUPER2(name, a, b) \
+        VM_PRIM(OP_##name, CHECK_BOUNDS(NEED2(a, b), ROOM2(a, b))) { \
+            PRIM_##a; \
+            PRIM_##b; \
+            NEXT; \
+        }
+#define SUPER3(name, a, b, c) \
+        VM_PRIM(OP_##name, CHECK_BOUNDS(NEED3(a, b, c), ROOM3(a, b, c))) { \
+            PRIM_##a; \
+            PRIM_##b; \
+            PRIM_##c; \
+            NEXT; \
+        }
+#include "superinstructions.def"
+#undef SUPER2
+#undef SUPER3
+
+#if !defined(VM_DIRECT_THREADED) && !defined(VM_TOKEN_THREADED)
+        default:
+            RFORTH_SET_ERROR(ctx, RFORTH_ERROR_EXECUTION_ERROR, "Invalid instruction");
+            goto error;
+        }
+#endif
+    }
+
+underflow:
+    RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_UNDERFLOW, "Stack underflow");
+    goto error;
+
+overflow:
+    RFORTH_SET_ERROR(ctx, RFORTH_ERROR_STACK_OVERFLOW, "Stack overflow");
+
+error:
+    *sp = TOS;
+    /* Drop the call and loop frames this run left open */
+    ctx->call_sp = frame_base;
+    ctx->do_loop_sp = loop_floor;
+    return sp;
+}
+
+void vm_execute(rforth_ctx_t *ctx, word_t *word) {
+    if (!ctx || !word || !word->body) return;
+
+    rforth_stack_t *ds = ctx->data_stack;
+    cell_t *sp = vm_call(ctx, word, ds->data + ds->sp);
+    ds->sp = (int)(sp - ds->data);
+}
+
+/* Dispatch cost measurement */
+
+typedef struct {
+    const char *label;          /* Forth source of the measured sequence */
+    const char *words[4];       /* Words compiled into the loop body; others are numbers */
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    {"dup drop",  {"dup", "drop", NULL}},
+    {"swap",      {"swap", NULL}},
+    {"over drop", {"over", "drop", NULL}},
+    {"1+ 1-",     {"1+", "1-", NULL}},
+    {"0 +",       {"0", "+", NULL}},
+    {"i drop",    {"i", "drop", NULL}},
+    {"depth drop", {"depth", "drop", NULL}},
+    {NULL, {NULL}}
+};
+
+#define BENCH_UNROLL 16
+
+/* Compile "<n> 0 do <seq> x BENCH_UNROLL loop" and return seconds taken */
+static double bench_run(rforth_ctx_t *ctx, const char *const *words, int64_t iterations, int *ops) {
+    vm_builder_t *builder = vm_builder_create();
+    if (!builder) return -1.0;
+    /* Measure single primitives, not their fused forms */
+    builder->fuse = false;
+
+    double elapsed = -1.0;
+    token_t token;
+    memset(&token, 0, sizeof(token));
+
+    instr_t *instr;
+    if (!(instr = emit(ctx, builder, OP_LIT))) goto done;
+    instr->arg.literal = cell_make_int(iterations);
+    if (!(instr = emit(ctx, builder, OP_LIT))) goto done;
+    instr->arg.literal = cell_make_int(0);
+    token.type = TOKEN_WORD;
+    token.symbol = SYM_DO;
+    if (!vm_compile_token(ctx, builder, &token)) goto done;
+
+    *ops = 0;
+    for (int r = 0; words && r < BENCH_UNROLL; r++) {
+        for (int w = 0; words[w]; w++) {
+            if (!dict_find(ctx->dict, words[w])) {
+                if (!(instr = emit(ctx, builder, OP_LIT))) goto done;
+                instr->arg.literal = cell_make_int(atoi(words[w]));
+            } else {
+                token.type = TOKEN_WORD;
+                token.symbol = symbol_intern(words[w], strlen(words[w]));
+                if (!vm_compile_token(ctx, builder, &token)) goto done;
+            }
+            (*ops)++;
+        }
+    }
+
+    token.type = TOKEN_WORD;
+    token.symbol = SYM_LOOP;
+    if (!vm_compile_token(ctx, builder, &token)) goto done;
+
+    word_t bench;
+    memset(&bench, 0, sizeof(bench));
+    strcpy(bench.name, "(dispatch-bench)");
+    bench.type = WORD_USER;
+    if (!vm_builder_finish(ctx, builder, &bench.body, &bench.body_length)) goto done;
+
+    /* Two operands for the measured sequences to work on */
+    stack_push_int(ctx->data_stack, 1);
+    stack_push_int(ctx->data_stack, 2);
+
+    clock_t start = clock();
+    vm_execute(ctx, &bench);
+    clock_t end = clock();
+
+    stack_drop(ctx->data_stack);
+    stack_drop(ctx->data_stack);
+    vm_code_free(bench.body, bench.body_length);
+
+    if (ctx->last_error.code == RFORTH_OK) {
+        elapsed = (double)(end - start) / CLOCKS_PER_SEC;
+    }
+
+done:
+    vm_builder_destroy(builder);
+    return elapsed;
+}
+
+void vm_report_dispatch_cost(rforth_ctx_t *ctx, int64_t iterations) {
+    if (!ctx || iterations <= 0) return;
+
+    int ops = 0;
+    double baseline = bench_run(ctx, NULL, iterations, &ops);
+    if (baseline < 0) return;
+
+    printf("Dispatch: %s, %lld iterations\n",
+           ctx->jit ? "native (template JIT)" : vm_dispatch_name(), (long long)iterations);
+    printf("  %-12s %8.2f ns/iteration\n", "(empty loop)", baseline * 1e9 / (double)iterations);
+
+    for (int i = 0; bench_cases[i].label; i++) {
+        double elapsed = bench_run(ctx, bench_cases[i].words, iterations, &ops);
+        if (elapsed < 0) return;
+
+        double per_op = (elapsed - baseline) * 1e9 / ((double)iterations * ops);
+        printf("  %-12s %8.2f ns/op\n", bench_cases[i].label, per_op);
+    }
+}
+
+#ifdef RFORTH_PROFILE
+typedef struct {
+    opcode_t parts[3];
+    int length;
+    uint64_t saved;
+} sequence_t;
+
+static int compare_sequences(const void *a, const void *b) {
+    uint64_t sa = ((const sequence_t*)a)->saved, sb = ((const sequence_t*)b)->saved;
+    return sa < sb ? 1 : sa > sb ? -1 : 0;
+}
+
+/* A fused instruction has room for at most one literal */
+static bool fusable_sequence(const opcode_t *parts, int length) {
+    int lits = 0;
+    for (int k = 0; k < length; k++) {
+        if (parts[k] == OP_LIT) lits++;
+    }
+    return lits <= 1;
+}
+
+void vm_report_superinstructions(int count) {
+    int capacity = 1024, used = 0;
+    sequence_t *seqs = malloc(sizeof(sequence_t) * capacity);
+    if (!seqs) return;
+
+    for (int a = 0; a < OP_COUNT; a++) {
+        for (int b = 0; b < OP_COUNT; b++) {
+            for (int c = -1; c < OP_COUNT; c++) {
+                uint64_t n = c < 0 ? profile_pairs[a][b] : profile_triples[a][b][c];
+                if (n == 0) continue;
+
+                sequence_t seq = {{(opcode_t)a, (opcode_t)b, (opcode_t)(c < 0 ? 0 : c)}, c < 0 ? 2 : 3, 0};
+                if (!fusable_sequence(seq.parts, seq.length)) continue;
+                seq.saved = n * (uint64_t)(seq.length - 1);
+
+                if (used == capacity) {
+                    sequence_t *grown = realloc(seqs, sizeof(sequence_t) * capacity * 2);
+                    if (!grown) break;
+                    seqs = grown;
+                    capacity *= 2;
+                }
+                seqs[used++] = seq;
+            }
+        }
+    }
+
+    qsort(seqs, used, sizeof(sequence_t), compare_sequences);
+
+    printf("/* Top %d sequences by dispatches saved */\n", count < used ? count : used);
+    for (int i = 0; i < used && i < count; i++) {
+        const sequence_t *seq = &seqs[i];
+        if (seq->length == 2) {
+            printf("SUPER2(%s_%s, %s, %s) /* %llu */\n",
+                   fusable_names[seq->parts[0]], fusable_names[seq->parts[1]],
+                   fusable_names[seq->parts[0]], fusable_names[seq->parts[1]],
+                   (unsigned long long)seq->saved);
+        } else {
+            printf("SUPER3(%s_%s_%s, %s, %s, %s) /* %llu */\n",
+                   fusable_names[seq->parts[0]], fusable_names[seq->parts[1]], fusable_names[seq->parts[2]],
+                   fusable_names[seq->parts[0]], fusable_names[seq->parts[1]], fusable_names[seq->parts[2]],
+                   (unsigned long long)seq->saved);
+        }
+    }
+    free(seqs);
+}
+#else
+void vm_report_superinstructions(int count) {
+    (void)count;
+    printf("Sequence profiling is disabled; reconfigure with -DRFORTH_PROFILE=ON\n");
+}
+#endif
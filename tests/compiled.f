@@ -0,0 +1,28 @@
+( Compiled with -c, a program prints what the interpreter prints )
+
+( Counted and indefinite loops, nested )
+: triangle 0 swap 1+ 1 do i + loop ;
+: steps 0 swap begin dup 1 > while dup 2 mod if 3 * 1+ else 2 / then swap 1+ swap repeat drop ;
+: grid 3 0 do 3 0 do i j * . loop loop ;
+: countdown begin dup . 1- dup 0= until drop ;
+10 triangle .  27 steps . cr
+grid cr
+5 countdown cr
+
+( Fixed stack effects and shuffles kept in locals )
+: sq dup * ;
+: hyp2 sq swap sq + ;
+: rot3 rot rot ;
+: fib dup 2 < if exit then dup 1- fib swap 2 - fib + ;
+3 4 hyp2 .  1 2 3 rot3 . . .  20 fib . cr
+: classify dup 0< if drop -1 else 0> if 1 else 0 then then ;
+-5 classify .  0 classify .  7 classify . cr
+
+( Variables, constants, CREATE regions and floats )
+variable counter
+100 constant hundred
+create table 1 , 2 , 3 ,
+: bump counter @ 1+ counter ! ;
+bump bump bump counter @ .  hundred 1+ .  table cell+ @ .  table 2 cells + @ . cr
+fvariable acc
+2.5e0 acc f!  acc f@ 1.5e0 f+ f.  3e0 fsqrt 3e0 fsqrt f* f. cr
@@ -0,0 +1,12 @@
+( HERE, ALLOT, "," and C, stay inside data space; access outside it is an error )
+
+create buf 4 cells allot
+11 buf !  22 buf cell+ !  buf @ .  buf cell+ @ . cr
+here 7 , 8 c, dup @ .  cell+ c@ . cr
+variable v  42 v !  v @ . cr
+here 0 allot here = . cr
+: peek @ ;
+buf peek . cr
+." in bounds" cr
+here 100 + peek .
+." not reached" cr
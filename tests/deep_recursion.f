@@ -0,0 +1,18 @@
+( Recursion a million levels deep, by RECURSE and between two words )
+
+: count-down dup 0= if exit then 1- recurse ;
+: even? dup 0= if drop -1 exit then 1- odd? ;
+: odd? dup 0= if drop 0 exit then 1- even? ;
+
+1000000 count-down .
+1000000 even? .
+1000001 even? .
+cr
+
+( Not tail calls: each level returns to the one above, past the JIT's native depth )
+: deep dup 0= if exit then 1- recurse 1+ ;
+: down dup 0= if exit then 1- up 1+ ;
+: up down ;
+1000000 deep .
+100000 down .
+cr
@@ -0,0 +1,25 @@
+( Strings run by EVALUATE repeatedly give the same results as the first time )
+
+: run s" 1 2 + ." evaluate ;
+run run run cr
+: many 20 0 do s" i ." evaluate loop ;
+many cr
+
+( A later definition is seen by a string run again )
+: nw 1 ;
+: show s" nw ." evaluate ;
+show show
+: nw 2 ;
+show show cr
+
+( Strings that define words are not cached )
+: mk s" : made 5 ;" evaluate ;
+mk made .  mk made . cr
+: sq s" dup *" evaluate ;
+3 sq .  4 sq . cr
+
+( A string that redefines a word it goes on to use calls the new one )
+: nw 1 ;
+: mk s" : nw 9 ;" evaluate ;
+: use s" mk nw ." evaluate ;
+use  : nw 1 ;  use cr
@@ -0,0 +1,5 @@
+( Float literals with an exponent go to the float stack )
+
+1e3 f.  1.5e-2 f.  -2E+1 f.  25e-1 f.  1.e2 f.  0e f. cr
+: lits 2.5e1 1e-1 f+ f. ;
+lits cr
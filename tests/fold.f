@@ -0,0 +1,12 @@
+( Literal-only arithmetic is folded at compile time )
+
+: k1 2 3 + 4 * ;
+: k2 10 3 - 2 - ;
+: k3 7 1+ 1- 0= ;
+: k4 3 4 < 5 5 = + ;
+k1 .  k2 .  k3 .  k4 . cr
+
+( A redefined builtin is not folded with its old meaning )
+: + - ;
+: k5 5 3 + ;
+k5 . cr
@@ -0,0 +1,27 @@
+( FORGET removes a word and everything after it, uncovering older definitions )
+
+: w 1 ;
+: w 2 ;
+: later 3 ;
+w .  later . cr
+forget w
+w . cr
+: later w 10 + ;
+later . cr
+forget w
+: w 4 ;
+w . cr
+
+( Words defined before the forgotten one stay )
+: keep 9 ;
+variable v  5 v !
+: w v @ ;
+w .  forget v  keep .  w . cr
+
+( A running word can forget itself or words it still has to return to )
+: a 1 ;
+: a 2 ;
+: x a .  forget a  a . ;
+x a . cr
+: y s" forget y" evaluate 5 . ;
+y cr
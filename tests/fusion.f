@@ -0,0 +1,28 @@
+( Fused primitive sequences give the same results as the words they replace )
+
+variable v  5 v !
+
+: f1 dup + ;            : f2 over - ;          : f3 over + ;
+: f4 swap drop ;        : f5 swap - ;          : f6 dup * ;
+: f7 3 + ;              : f8 3 - ;             : f9 3 * ;
+: f10 3 = ;             : f11 3 < ;            : f12 3 > ;
+: f13 dup 7 ;           : f14 dup @ ;          : f15 @ + ;
+: f16 dup 3 < ;         : f17 dup 3 = ;
+
+6 f1 .  10 4 f2 . .  10 4 f3 . .  1 2 f4 .  10 4 f5 .  7 f6 . cr
+4 f7 .  4 f8 .  4 f9 .  3 f10 .  2 f11 .  2 f12 . cr
+1 f13 . . .  v f14 . drop  1 v f15 .  2 f16 . .  3 f17 . . cr
+
+( Mixed-type parts still handle floats )
+1.5 f1 .  1.5 f7 .  0.5 f6 .  2.5 f12 . cr
+
+( Loop index sequences )
+: sum-i 0 5 0 do i + loop ;
+: sum-i2 0 5 0 do i 10 + + loop ;
+: list 4 0 do i 1 . . loop ;
+sum-i .  sum-i2 .  list cr
+
+( A branch target between two parts keeps them apart )
+: split 0= if 1 else 2 then 10 + ;
+: split2 if dup then + ;
+0 split .  1 split .  2 3 0 split2 .  3 1 split2 . cr
@@ -0,0 +1,15 @@
+( Parsing and defining words inside IF, DO and BEGIN typed outside a definition )
+
+1 if variable qq then 77 . cr
+5 qq !  qq @ . cr
+0 if variable rr then 78 . cr
+1 if 9 constant nine else 8 constant nine then nine . cr
+3 0 do s" abc" type loop cr
+1 if s" hello" then type cr
+: old 1 ;  : old 2 ;
+1 if forget old then old . cr
+1 if create buf 3 cells allot then 4 buf !  buf @ . cr
+1 if 2.5e0 fconstant fc then fc f. cr
+( Words that only mean something inside a definition are an error here )
+1 if postpone dup then
+." not reached" cr
@@ -0,0 +1,15 @@
+( Arithmetic sites specialise after integer-only use and recover when a float shows up )
+
+: add + ;  : sub - ;  : mul * ;
+: less < ;  : same = ;  : more > ;
+: warm 1000 0 do i 1 add drop  i 1 sub drop  i 2 mul drop
+                 i 1 less drop  i 1 same drop  i 1 more drop loop ;
+warm
+1 2 add .  5 3 sub .  4 5 mul .  1 2 less .  2 2 same .  1 2 more . cr
+1.5 2 add .  5.5 3 sub .  0.5 5 mul .  1.5 2 less .  2.5 2.5 same .  1.5 1 more . cr
+warm
+2 2 add .  7 3 sub .  6 7 mul .  3 2 less . cr
+
+( A site inside a loop that sees a float part way through )
+: acc 0 100 0 do i 50 = if 0.5 else 1 then + loop ;
+acc .  acc . cr
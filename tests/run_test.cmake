@@ -0,0 +1,29 @@
+# Runs NAME.f and checks that it prints exactly NAME.expected.
+#   RFORTH  the rforth executable
+#   NAME    program in this directory, without .f
+#   MODE    interpret, jit, or compile (build with -c into WORK, then run)
+# Errors go to stderr and are not compared; a program that stops on an
+# error shows it by what it no longer prints.
+
+set(program ${CMAKE_CURRENT_LIST_DIR}/${NAME}.f)
+
+if(MODE STREQUAL "compile")
+    execute_process(COMMAND ${RFORTH} -c -i ${program} -o ${WORK}/${NAME}
+        RESULT_VARIABLE result OUTPUT_VARIABLE log ERROR_VARIABLE log)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "rforth -c failed:\n${log}")
+    endif()
+    execute_process(COMMAND ${WORK}/${NAME}
+        OUTPUT_VARIABLE output ERROR_VARIABLE errors)
+elseif(MODE STREQUAL "jit")
+    execute_process(COMMAND ${RFORTH} -j -i ${program}
+        OUTPUT_VARIABLE output ERROR_VARIABLE errors)
+else()
+    execute_process(COMMAND ${RFORTH} -i ${program}
+        OUTPUT_VARIABLE output ERROR_VARIABLE errors)
+endif()
+
+file(READ ${CMAKE_CURRENT_LIST_DIR}/${NAME}.expected expected)
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "${NAME} (${MODE}) printed:\n${output}${errors}\nexpected:\n${expected}")
+endif()